@@ -134,7 +134,6 @@ void ActionContext::show_menu_items()
 
     if (ImGui::MenuItem("Reload HurtBlobs"))
     {
-        fighterDef.hurtBlobs.clear();
         fighterDef.initialise_hurtblobs();
         fighter->mHurtBlobs.clear();
         fighter->initialise_hurtblobs();
@@ -152,7 +151,7 @@ void ActionContext::show_menu_items()
     if (ImGui::MenuItem("Reload Animations"))
     {
         // todo: make sure there are no dangling pointers around
-        fighterDef.animations.clear();
+        fighterDef.clear_animations();
         fighterDef.initialise_animations("assets/fighters/Animations.json");
         fighterDef.initialise_animations(fmt::format("assets/{}/Animations.json", fighterDef.directory));
         reset_timeline_length();
@@ -164,9 +163,12 @@ void ActionContext::show_menu_items()
 
 void ActionContext::show_widgets()
 {
-    show_widget_hitblobs(fighter->def.armature, actionDef->blobs);
-    show_widget_effects(fighter->def.armature, actionDef->effects);
-    show_widget_emitters(fighter->def.armature, actionDef->emitters);
+    // editor worlds never share their data, so it can be edited in place
+    ActionDefData& data = actionDef->get_unshared_data();
+
+    show_widget_hitblobs(fighter->def.armature, data.blobs);
+    show_widget_effects(fighter->def.armature, data.effects);
+    show_widget_emitters(fighter->def.armature, data.emitters);
     show_widget_scripts();
     show_widget_timeline();
     show_widget_debug();
@@ -220,8 +222,10 @@ bool ActionContext::UndoEntry::has_changes(const FighterActionDef& def) const
 
 void ActionContext::UndoEntry::revert_changes(FighterActionDef& def) const
 {
-    def.blobs = blobs;
-    def.effects = effects;
-    def.emitters = emitters;
+    ActionDefData& data = def.get_unshared_data();
+
+    data.blobs = blobs;
+    data.effects = effects;
+    data.emitters = emitters;
     def.wrenSource = wrenSource;
 }
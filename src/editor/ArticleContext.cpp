@@ -139,7 +139,7 @@ void ArticleContext::show_menu_items()
     if (ImGui::MenuItem("Reload Animations"))
     {
         // todo: make sure there are no dangling pointers around
-        articleDef->animations.clear();
+        articleDef->clear_animations();
         articleDef->initialise_animations(fmt::format("assets/{}/Animations.json", ctxKey));
         deferScrubToFrame = currentFrame;
     }
@@ -140,7 +140,7 @@ void BaseContext::show_widget_effects(const sq::Armature& armature, std::map<Tin
         {
             // todo: try some other paths once we have common effects
             def.path = fmt::format("fighters/{}/effects/{}", fighter->def.name, def.get_key());
-            def.handle = world->caches.effects.acquire_safe(def.path);
+            def.handle = world->caches->effects.acquire_safe(def.path);
         }
     };
 
@@ -149,7 +149,7 @@ void BaseContext::show_widget_effects(const sq::Armature& armature, std::map<Tin
         IMPLUS_WITH(Scope_ItemWidth) = -120.f;
 
         if (ImPlus::InputString("Path", def.path))
-            def.handle = world->caches.effects.acquire_safe(def.path);
+            def.handle = world->caches->effects.acquire_safe(def.path);
 
         if (!def.handle.good()) ImPlus::LabelText("Error", def.handle.error());
         else ImPlus::LabelText("Resolved", fmt::format("assets/{}/...", def.path));
@@ -262,7 +262,7 @@ void BaseContext::show_widget_sounds(std::map<SmallString, SoundEffect>& sounds)
         {
             // todo: try some other paths once we have common sounds
             sound.path = fmt::format("fighters/{}/sounds/{}", fighter->def.name, sound.get_key());
-            sound.handle = world->caches.sounds.acquire_safe(sound.path);
+            sound.handle = world->caches->sounds.acquire_safe(sound.path);
         }
     };
 
@@ -271,7 +271,7 @@ void BaseContext::show_widget_sounds(std::map<SmallString, SoundEffect>& sounds)
         IMPLUS_WITH(Scope_ItemWidth) = -120.f;
 
         if (ImPlus::InputString("Path", sound.path))
-            sound.handle = world->caches.sounds.acquire_safe(sound.path);
+            sound.handle = world->caches->sounds.acquire_safe(sound.path);
 
         if (!sound.handle.good()) ImPlus::LabelText("Error", sound.handle.error());
         else ImPlus::LabelText("Resolved", fmt::format("assets/{}.wav", sound.path));
@@ -284,7 +284,7 @@ void BaseContext::show_widget_sounds(std::map<SmallString, SoundEffect>& sounds)
         ImGui::SetCursorPosX(ImGui::GetStyle().WindowPadding.x * 0.5f + 1.f);
         if (!sound.handle.good()) ImGui::BeginDisabled();
         if (ImGui::Button("Play"))
-            world->audio.play_sound(sound.handle.value(), sq::SoundGroup::Sfx, sound.volume, false);
+            world->audio->play_sound(sound.handle.value(), sq::SoundGroup::Sfx, sound.volume, false);
         if (!sound.handle.good()) ImGui::EndDisabled();
         ImGui::SameLine();
     };
@@ -158,7 +158,8 @@ void FighterContext::show_widget_hurtblobs()
         ImPlus::SliderValue("Radius", def.radius, 0.05f, 1.5f, "%.2f metres");
     };
 
-    helper_edit_objects(fighterDef->hurtBlobs, funcInit, funcEdit, nullptr);
+    // editor worlds never share their data, so it can be edited in place
+    helper_edit_objects(fighterDef->get_unshared_data()->hurtBlobs, funcInit, funcEdit, nullptr);
 }
 
 //============================================================================//
@@ -176,5 +177,5 @@ bool FighterContext::UndoEntry::has_changes(const FighterDef& def) const
 void FighterContext::UndoEntry::revert_changes(FighterDef& def) const
 {
     def.sounds = sounds;
-    def.hurtBlobs = hurtBlobs;
+    def.get_unshared_data()->hurtBlobs = hurtBlobs;
 }
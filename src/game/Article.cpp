@@ -1,6 +1,7 @@
 #include "game/Article.hpp"
 
 #include "game/Physics.hpp"
+#include "game/ScriptProfiler.hpp"
 #include "game/Stage.hpp"
 #include "game/World.hpp"
 
@@ -16,6 +17,8 @@ Article::Article(const ArticleDef& def, Fighter* fighter)
     : Entity(def), def(def), fighter(fighter)
 {
     // scriptClass.new is done from wren in wren to prevent reentrance
+
+    mRunId = world.generate_script_run_id();
 }
 
 Article::~Article()
@@ -28,6 +31,22 @@ Article::~Article()
 
 void Article::call_do_updates()
 {
+    const ScriptProfiler::Scope profile = { def, "do_updates" };
+
+    // the fiber won't resume this frame, so skip straight to update, if the script has one
+    if (mCurrentFrame < mWaitUntil)
+    {
+        ++mCurrentFrame;
+
+        if (mScriptHasUpdate == false) return;
+
+        const auto error = world.vm.safe_call_void(world.handles.article_do_update, this);
+        if (error.empty() == false)
+            set_error_message("call_do_updates", error);
+
+        return;
+    }
+
     const auto error = world.vm.safe_call_void(world.handles.article_do_updates, this);
     if (error.empty() == false)
         set_error_message("call_do_updates", error);
@@ -44,6 +63,15 @@ void Article::call_do_destroy()
 
 //============================================================================//
 
+void Article::call_do_construct()
+{
+    const auto error = world.vm.safe_call_void(world.handles.article_do_construct, this);
+    if (error.empty() == false)
+        set_error_message("call_do_construct", error);
+}
+
+//============================================================================//
+
 void Article::set_error_message(StringView method, StringView errors)
 {
     String message = fmt::format (
@@ -163,5 +191,5 @@ void Article::integrate(float blend)
 
     for (const sq::DrawItem& item : def.drawItems)
         if (check_condition(item.condition) == true)
-            world.renderer.add_draw_call(item, mAnimPlayer);
+            world.renderer->add_draw_call(item, mAnimPlayer);
 }
@@ -46,6 +46,26 @@ public: //====================================================//
 
     void call_do_destroy();
 
+    /// Create the script object, for articles created by snapshots.
+    void call_do_construct();
+
+    //--------------------------------------------------------//
+
+    ScriptProgress get_progress() const;
+
+    /// Resume a new fiber up to the given progress, unless already there.
+    void restore_progress(const ScriptProgress& progress);
+
+    /// Write the fields returned by the script's save_fields().
+    void save_script_fields(StateBuffer& buffer);
+
+    /// Pass fields written by save_script_fields to the script's load_fields(_).
+    void load_script_fields(StateReader& reader);
+
+    void save_state(StateBuffer& buffer) const;
+
+    void load_state(StateReader& reader);
+
     //--------------------------------------------------------//
 
     bool check_marked_for_destroy() const { return mMarkedForDestroy; }
@@ -76,10 +96,20 @@ public: //====================================================//
 
     bool wren_cxx_next_frame();
 
+    void wren_cxx_no_update() { mScriptHasUpdate = false; }
+
+    void wren_cxx_no_fields() { mScriptHasFields = false; }
+
+    void wren_cxx_before_fast_forward();
+
+    bool wren_cxx_fast_forward(uint frame);
+
     void wren_mark_for_destroy() { mMarkedForDestroy = true; }
 
     void wren_enable_hitblobs(StringView prefix);
 
+    void wren_enable_hitblobs_id(uint16_t id);
+
     void wren_disable_hitblobs(bool resetCollisions);
 
     int32_t wren_play_effect(TinyString key);
@@ -94,6 +124,14 @@ private: //===================================================//
     uint mCurrentFrame = 0u;
     uint mWaitUntil = 0u;
 
+    /// Cleared when the default ArticleScript.update() gets called.
+    bool mScriptHasUpdate = true;
+
+    /// Cleared when the default ArticleScript.save_fields() gets called.
+    bool mScriptHasFields = true;
+
+    uint32_t mRunId = 0u;
+
     WrenHandle* mScriptHandle = nullptr;
     WrenHandle* mFiberHandle = nullptr;
 
@@ -1,11 +1,13 @@
 #include "game/ArticleDef.hpp"
 
+#include "game/DefCache.hpp"
 #include "game/Emitter.hpp"
 #include "game/HitBlob.hpp"
 #include "game/VisualEffect.hpp"
 #include "game/World.hpp"
 
-#include <sqee/misc/Files.hpp>
+#include "main/AssetArchive.hpp"
+
 #include <sqee/misc/Json.hpp>
 
 using namespace sts;
@@ -16,7 +18,10 @@ ArticleDef::ArticleDef(World& world, String directory)
     : EntityDef(world, directory)
 {
     initialise_sounds(fmt::format("assets/{}/Sounds.json", directory));
-    initialise_animations(fmt::format("assets/{}/Animations.json", directory));
+
+    // already loaded if shared with a previous world
+    if (reusedData == false)
+        initialise_animations(fmt::format("assets/{}/Animations.json", directory));
 
     // todo: change to wren expressions
     for (const sq::DrawItem& drawItem : drawItems)
@@ -24,6 +29,9 @@ ArticleDef::ArticleDef(World& world, String directory)
         if (drawItem.condition.empty()) continue;
         sq::log_warning("'assets/{}/Render.json': invalid condition '{}'", directory, drawItem.condition);
     }
+
+    initialise_key_ids();
+    share_data();
 }
 
 ArticleDef::~ArticleDef()
@@ -35,32 +43,56 @@ ArticleDef::~ArticleDef()
 
 void ArticleDef::load_json_from_file()
 {
-    blobs.clear();
-    effects.clear();
-    emitters.clear();
+    blobGroups.clear();
+
+    const auto compile = [this](JsonObject json, StateBuffer& buffer)
+    {
+        blobs.clear();
+        effects.clear();
+        emitters.clear();
 
-    const auto document = JsonDocument::parse_file(fmt::format("assets/{}/Article.json", directory));
-    const auto json = document.root().as<JsonObject>();
+        fmt::memory_buffer errors;
 
-    fmt::memory_buffer errors;
+        const auto objects_from_json = [&json, &errors](StringView mapKey, auto& map, auto&... fromJsonArgs)
+        {
+            for (const auto [key, jObject] : json[mapKey].as<JsonObject>())
+            {
+                try {
+                    map[key].from_json(jObject.as<JsonObject>(), fromJsonArgs...); }
+                catch (const std::exception& ex) {
+                    fmt::format_to(fmt::appender(errors), "\n{}", ex.what()); }
+            }
+        };
+
+        // handles are acquired below, for cached and compiled effects alike
+        EffectCache* const effectCache = nullptr;
+
+        objects_from_json("blobs", blobs, armature);
+        objects_from_json("effects", effects, armature, effectCache);
+        objects_from_json("emitters", emitters, armature);
+
+        DefCache::write_map(buffer, blobs);
+        DefCache::write_map(buffer, effects);
+        DefCache::write_map(buffer, emitters);
+
+        if (errors.size() != 0u)
+            sq::log_warning_multiline("'{}': errors in json{}", directory, StringView(errors.data(), errors.size()));
+
+        return errors.size() == 0u;
+    };
 
-    const auto objects_from_json = [&json, &errors](StringView mapKey, auto& map, auto&... fromJsonArgs)
+    const auto load = [this](StateReader& reader)
     {
-        for (const auto [key, jObject] : json[mapKey].as<JsonObject>())
-        {
-            try {
-                map[key].from_json(jObject.as<JsonObject>(), fromJsonArgs...); }
-            catch (const std::exception& ex) {
-                fmt::format_to(fmt::appender(errors), "\n{}", ex.what()); }
-        }
+        DefCache::read_map(reader, blobs);
+        DefCache::read_map(reader, effects);
+        DefCache::read_map(reader, emitters);
     };
 
-    objects_from_json("blobs", blobs, armature);
-    objects_from_json("effects", effects, armature, world.caches.effects);
-    objects_from_json("emitters", emitters, armature);
+    DefCache::load(fmt::format("assets/{}/Article.json", directory), armatureHash, compile, load);
 
-    if (errors.size() != 0u)
-        sq::log_warning_multiline("'{}': errors in json{}", directory, StringView(errors.data(), errors.size()));
+    if (world.caches != nullptr)
+        for (auto& [key, effect] : effects)
+            effect.handle = world.caches->effects.acquire(effect.path);
 }
 
 //============================================================================//
@@ -68,13 +100,13 @@ void ArticleDef::load_json_from_file()
 void ArticleDef::load_wren_from_file()
 {
     // set mWrenSource to either the file contents or a fallback script
-    auto source = sq::try_read_text_from_file(fmt::format("assets/{}/Article.wren", directory));
+    auto source = try_read_asset(fmt::format("assets/{}/Article.wren", directory));
     if (source.has_value() == false)
     {
         sq::log_warning("'{}': missing script", directory);
 
         // articles all use the same fallback script
-        source = sq::read_text_from_file("wren/fallback/Article.wren");
+        source = read_asset("wren/fallback/Article.wren");
     }
     wrenSource = std::move(*source);
 
@@ -122,7 +154,7 @@ void ArticleDef::interpret_module()
         wrenUnloadModule(vm, module.c_str());
 
         // articles all use the same fallback script
-        const String source = sq::read_text_from_file("wren/fallback/Article.wren");
+        const String source = read_asset("wren/fallback/Article.wren");
 
         // fallback script is assumed not to have errors
         vm.interpret(module.c_str(), source.c_str());
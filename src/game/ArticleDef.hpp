@@ -22,6 +22,11 @@ struct ArticleDef final : EntityDef
     std::map<TinyString, VisualEffectDef> effects;
     std::map<TinyString, Emitter> emitters;
 
+    /// Blobs matching each prefix given to enable_hitblobs, by key id, filled when first used.
+    ///
+    /// Mutable for the same reason as FighterActionDef::blobGroups, cleared when blobs reload.
+    mutable std::vector<std::vector<const HitBlobDef*>> blobGroups;
+
     // todo: find a way to move this to the editor
     String wrenSource;
 
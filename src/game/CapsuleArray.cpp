@@ -0,0 +1,125 @@
+#include "game/CapsuleArray.hpp"
+
+#include <sqee/maths/Culling.hpp>
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+// distances this close to touching, relative to the squared sum of the radii,
+// are tested again with intersect_capsule_capsule, so that both always agree
+constexpr const float BORDERLINE_TOLERANCE = 0.01f;
+
+// results of the batched test other than a miss, before borderline lanes are resolved
+constexpr const uint8_t LANE_BORDERLINE = 1u;
+constexpr const uint8_t LANE_HIT = 2u;
+
+/// Clamp to the unit range, NaN becomes zero.
+inline float clamp_unit(float value)
+{
+    value = value > 0.f ? value : 0.f;
+    return value < 1.f ? value : 1.f;
+}
+
+inline float min_value(float a, float b)
+{
+    return a < b ? a : b;
+}
+
+inline float length_squared(float x, float y, float z)
+{
+    return x * x + y * y + z * z;
+}
+
+} // anonymous namespace
+
+//============================================================================//
+
+void CapsuleArray::clear()
+{
+    mAX.clear(); mAY.clear(); mAZ.clear();
+    mBX.clear(); mBY.clear(); mBZ.clear();
+    mRadius.clear();
+}
+
+void CapsuleArray::push_back(const maths::Capsule& capsule)
+{
+    mAX.push_back(capsule.originA.x); mAY.push_back(capsule.originA.y); mAZ.push_back(capsule.originA.z);
+    mBX.push_back(capsule.originB.x); mBY.push_back(capsule.originB.y); mBZ.push_back(capsule.originB.z);
+    mRadius.push_back(capsule.radius);
+}
+
+maths::Capsule CapsuleArray::get(size_t index) const
+{
+    maths::Capsule result;
+    result.originA = Vec3F(mAX[index], mAY[index], mAZ[index]);
+    result.originB = Vec3F(mBX[index], mBY[index], mBZ[index]);
+    result.radius = mRadius[index];
+    return result;
+}
+
+//============================================================================//
+
+void CapsuleArray::intersect(const maths::Capsule& capsule, size_t offset, size_t count, uint8_t* results, bool arrayFirst) const
+{
+    SQASSERT(offset + count <= size(), "range out of bounds");
+
+    const float pAX = capsule.originA.x, pAY = capsule.originA.y, pAZ = capsule.originA.z;
+    const float pDX = capsule.originB.x - pAX, pDY = capsule.originB.y - pAY, pDZ = capsule.originB.z - pAZ;
+    const float pR = capsule.radius;
+
+    const float a = pDX * pDX + pDY * pDY + pDZ * pDZ;
+
+    const float* const ax = mAX.data() + offset; const float* const ay = mAY.data() + offset; const float* const az = mAZ.data() + offset;
+    const float* const bx = mBX.data() + offset; const float* const by = mBY.data() + offset; const float* const bz = mBZ.data() + offset;
+    const float* const radius = mRadius.data() + offset;
+
+    // No branches or conditional divides, so that the compiler can vectorise
+    // this loop. A zero length segment makes the divides below give NaN or
+    // infinity, which clamp_unit turns into a valid parameter.
+
+    for (size_t i = 0u; i < count; ++i)
+    {
+        const float qDX = bx[i] - ax[i], qDY = by[i] - ay[i], qDZ = bz[i] - az[i];
+        const float rX = pAX - ax[i], rY = pAY - ay[i], rZ = pAZ - az[i];
+
+        const float b = pDX * qDX + pDY * qDY + pDZ * qDZ;
+        const float c = pDX * rX + pDY * rY + pDZ * rZ;
+        const float e = qDX * qDX + qDY * qDY + qDZ * qDZ;
+        const float f = qDX * rX + qDY * rY + qDZ * rZ;
+
+        // closest points of the two lines, clamped to q and then back to p
+        const float sLine = clamp_unit((b * f - c * e) / (a * e - b * b));
+        const float t = clamp_unit((b * sLine + f) / e);
+        const float s = clamp_unit((b * t - c) / a);
+
+        float distSquared = length_squared(rX + pDX * s - qDX * t, rY + pDY * s - qDY * t, rZ + pDZ * s - qDZ * t);
+
+        // the lines are badly conditioned when nearly parallel, but then an end is always closest
+        const float tA = clamp_unit(f / e), tB = clamp_unit((f + b) / e);
+        const float sA = clamp_unit(-c / a), sB = clamp_unit((b - c) / a);
+
+        distSquared = min_value(distSquared, length_squared(rX - qDX * tA, rY - qDY * tA, rZ - qDZ * tA));
+        distSquared = min_value(distSquared, length_squared(rX + pDX - qDX * tB, rY + pDY - qDY * tB, rZ + pDZ - qDZ * tB));
+        distSquared = min_value(distSquared, length_squared(rX + pDX * sA, rY + pDY * sA, rZ + pDZ * sA));
+        distSquared = min_value(distSquared, length_squared(rX + pDX * sB - qDX, rY + pDY * sB - qDY, rZ + pDZ * sB - qDZ));
+
+        const float radiiSquared = (pR + radius[i]) * (pR + radius[i]);
+
+        results[i] = uint8_t(distSquared <= radiiSquared * (1.f - BORDERLINE_TOLERANCE)) +
+                     uint8_t(distSquared <= radiiSquared * (1.f + BORDERLINE_TOLERANCE));
+    }
+
+    // rare, so no need to be fast
+    for (size_t i = 0u; i < count; ++i)
+    {
+        if (results[i] == LANE_BORDERLINE)
+        {
+            const maths::Capsule other = get(offset + i);
+            results[i] = arrayFirst ? maths::intersect_capsule_capsule(other, capsule) : maths::intersect_capsule_capsule(capsule, other);
+        }
+        else results[i] = results[i] == LANE_HIT;
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include <sqee/maths/Volumes.hpp>
+
+namespace sts {
+
+//============================================================================//
+
+/// Structure of arrays copy of transformed capsules, for batched tests.
+///
+/// Each component has its own contiguous array, so that intersect() can test
+/// a capsule against a range at once. The kernel has no branches, so that the
+/// compiler can vectorise it. This needs -fno-trapping-math with GCC, which
+/// is set for this file only, see CMakeLists.txt.
+class CapsuleArray final
+{
+public: //====================================================//
+
+    void clear();
+
+    void push_back(const maths::Capsule& capsule);
+
+    size_t size() const { return mRadius.size(); }
+
+    /// Get a copy of one of the capsules.
+    maths::Capsule get(size_t index) const;
+
+    //--------------------------------------------------------//
+
+    /// Test a capsule against count capsules starting at offset.
+    ///
+    /// Writes one result per capsule tested, always the same as calling
+    /// maths::intersect_capsule_capsule. Contacts close to touching are passed
+    /// to that function, with the array capsule first if arrayFirst is set.
+    void intersect(const maths::Capsule& capsule, size_t offset, size_t count, uint8_t* results, bool arrayFirst) const;
+
+private: //===================================================//
+
+    std::vector<float> mAX, mAY, mAZ;
+    std::vector<float> mBX, mBY, mBZ;
+    std::vector<float> mRadius;
+};
+
+//============================================================================//
+
+} // namespace sts
@@ -0,0 +1,226 @@
+#include "game/World.hpp" // IWYU pragma: associated
+
+#include "game/Article.hpp"
+#include "game/Fighter.hpp"
+#include "game/HitBlob.hpp"
+#include "game/HurtBlob.hpp"
+
+#include <bit> // bit_cast
+#include <locale>
+#include <sstream>
+
+using namespace sts;
+
+// Checksums only cover gameplay values, not anything used just for rendering.
+// Values are visited one field at a time, never as raw structs, so that padding
+// bytes can't cause false desyncs.
+
+//============================================================================//
+
+namespace {
+
+constexpr const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr const uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t fnv1a_bytes(uint64_t hash, const void* data, size_t count)
+{
+    for (size_t i = 0u; i < count; ++i)
+        hash = (hash ^ uint64_t(static_cast<const uint8_t*>(data)[i])) * FNV_PRIME;
+    return hash;
+}
+
+//----------------------------------------------------------------------------//
+
+/// Visitor that combines every field into a hash.
+class ChecksumBuilder final
+{
+public: //====================================================//
+
+    ChecksumBuilder(uint64_t previous) : mHash(fnv1a_bytes(FNV_OFFSET_BASIS, &previous, sizeof(previous))) {}
+
+    void scope(const char* /*kind*/, int64_t /*index*/) {}
+
+    void sub_scope(const char* /*kind*/, size_t /*index*/) {}
+
+    template <class Type>
+    void field(const char* /*name*/, Type value)
+    {
+        if constexpr (std::is_same_v<Type, Vec2F>) field(nullptr, value.x), field(nullptr, value.y);
+        else if constexpr (std::is_same_v<Type, Vec3F>) field(nullptr, value.x), field(nullptr, value.y), field(nullptr, value.z);
+        else if constexpr (std::is_same_v<Type, float>) impl_add(std::bit_cast<uint32_t>(value));
+        else if constexpr (std::is_enum_v<Type>) impl_add(std::underlying_type_t<Type>(value));
+        else impl_add(value);
+    }
+
+    uint64_t get() const { return mHash; }
+
+private: //===================================================//
+
+    template <class Type>
+    void impl_add(Type value)
+    {
+        static_assert(std::is_integral_v<Type>);
+        const uint64_t widened = uint64_t(value);
+        mHash = fnv1a_bytes(mHash, &widened, sizeof(widened));
+    }
+
+    uint64_t mHash;
+};
+
+//----------------------------------------------------------------------------//
+
+/// Visitor that formats every field as a line of text.
+class FieldDumper final
+{
+public: //====================================================//
+
+    void scope(const char* kind, int64_t index) { mScope = fmt::format("{}[{}]", kind, index); mSubScope.clear(); }
+
+    void sub_scope(const char* kind, size_t index) { mSubScope = fmt::format(".{}[{}]", kind, index); }
+
+    template <class Type>
+    void field(const char* name, Type value)
+    {
+        // floats are printed with enough digits to round trip exactly
+        if constexpr (std::is_same_v<Type, Vec2F>) impl_line(name, fmt::format("({}, {})", value.x, value.y));
+        else if constexpr (std::is_same_v<Type, Vec3F>) impl_line(name, fmt::format("({}, {}, {})", value.x, value.y, value.z));
+        else if constexpr (std::is_same_v<Type, float>) impl_line(name, fmt::format("{}", value));
+        else if constexpr (std::is_same_v<Type, bool>) impl_line(name, value ? "true" : "false");
+        else if constexpr (std::is_enum_v<Type>) impl_line(name, fmt::format("{}", int64_t(value)));
+        else if constexpr (std::is_same_v<Type, uint64_t>) impl_line(name, fmt::format("{:016x}", value));
+        else impl_line(name, fmt::format("{}", int64_t(value)));
+    }
+
+    String result;
+
+private: //===================================================//
+
+    void impl_line(const char* name, StringView value)
+    {
+        fmt::format_to(std::back_inserter(result), "{}{}.{} = {}\n", mScope, mSubScope, name, value);
+    }
+
+    String mScope, mSubScope;
+};
+
+} // anonymous namespace
+
+//============================================================================//
+
+template <class Visitor>
+void World::impl_visit_checksum_fields(Visitor& visitor) const
+{
+    visitor.scope("world", 0);
+    visitor.field("entityId", mEntityId);
+    visitor.field("rng", impl_hash_rng_state());
+
+    const auto visit_entity = [&](const Entity& entity, const Entity::EntityVars& vars)
+    {
+        visitor.field("position", vars.position);
+        visitor.field("velocity", vars.velocity);
+        visitor.field("facing", vars.facing);
+        visitor.field("freezeTime", vars.freezeTime);
+        visitor.field("hitSomething", vars.hitSomething);
+        visitor.field("animTime", vars.animTime);
+        visitor.field("attachPoint", vars.attachPoint);
+        visitor.field("bully", vars.bully ? vars.bully->eid : -1);
+        visitor.field("victim", vars.victim ? vars.victim->eid : -1);
+
+        for (size_t index = 0u; index < entity.get_hit_blobs().size(); ++index)
+        {
+            const maths::Capsule& capsule = entity.get_hit_blobs()[index].capsule;
+            visitor.sub_scope("hitBlob", index);
+            visitor.field("originA", capsule.originA);
+            visitor.field("originB", capsule.originB);
+            visitor.field("radius", capsule.radius);
+        }
+    };
+
+    for (const auto& fighter : mFighters)
+    {
+        const Fighter::Variables& vars = fighter->variables;
+
+        visitor.scope("fighter", fighter->index);
+        visitor.field("extraJumps", vars.extraJumps);
+        visitor.field("lightLandTime", vars.lightLandTime);
+        visitor.field("noCatchTime", vars.noCatchTime);
+        visitor.field("stunTime", vars.stunTime);
+        visitor.field("reboundTime", vars.reboundTime);
+        visitor.field("edgeStop", vars.edgeStop);
+        visitor.field("intangible", vars.intangible);
+        visitor.field("invincible", vars.invincible);
+        visitor.field("fastFall", vars.fastFall);
+        visitor.field("applyGravity", vars.applyGravity);
+        visitor.field("applyFriction", vars.applyFriction);
+        visitor.field("flinch", vars.flinch);
+        visitor.field("grabable", vars.grabable);
+        visitor.field("onGround", vars.onGround);
+        visitor.field("onPlatform", vars.onPlatform);
+        visitor.field("edge", vars.edge);
+        visitor.field("moveMobility", vars.moveMobility);
+        visitor.field("moveSpeed", vars.moveSpeed);
+        visitor.field("damage", vars.damage);
+        visitor.field("shield", vars.shield);
+        visitor.field("launchSpeed", vars.launchSpeed);
+        visitor.field("launchEntity", vars.launchEntity);
+        visitor.field("hasLedge", vars.ledge != nullptr);
+
+        // blobs last, since they change the scope
+        visit_entity(*fighter, vars);
+
+        for (size_t index = 0u; index < fighter->get_hurt_blobs().size(); ++index)
+        {
+            const maths::Capsule& capsule = fighter->get_hurt_blobs()[index].capsule;
+            visitor.sub_scope("hurtBlob", index);
+            visitor.field("originA", capsule.originA);
+            visitor.field("originB", capsule.originB);
+            visitor.field("radius", capsule.radius);
+        }
+    }
+
+    for (const auto& article : mArticles)
+    {
+        visitor.scope("article", article->eid);
+        visitor.field("fragile", article->variables.fragile);
+        visitor.field("bounced", article->variables.bounced);
+
+        visit_entity(*article, article->variables);
+    }
+}
+
+//============================================================================//
+
+void World::impl_update_checksum()
+{
+    ChecksumBuilder builder { mChecksum };
+    impl_visit_checksum_fields(builder);
+    mChecksum = builder.get();
+}
+
+uint64_t World::impl_hash_rng_state() const
+{
+    // the rng is only used now and then, so most ticks can skip formatting it
+    if (mRandNumGenHash.has_value() == false || mHashedRandNumGen != mRandNumGen)
+    {
+        // the layout of the engine differs between standard libraries, but its text form is specified
+        std::ostringstream stream;
+        stream.imbue(std::locale::classic());
+        stream << mRandNumGen;
+
+        const String text = stream.str();
+
+        mHashedRandNumGen = mRandNumGen;
+        mRandNumGenHash = fnv1a_bytes(FNV_OFFSET_BASIS, text.data(), text.size());
+    }
+
+    return *mRandNumGenHash;
+}
+
+String World::dump_checksum_fields() const
+{
+    FieldDumper dumper;
+    dumper.scope("world", 0);
+    dumper.field("checksum", mChecksum);
+    impl_visit_checksum_fields(dumper);
+    return std::move(dumper.result);
+}
@@ -0,0 +1,678 @@
+#include "game/CollisionSystem.hpp"
+
+#include "game/Article.hpp"
+#include "game/Fighter.hpp"
+#include "game/HitBlob.hpp"
+#include "game/HurtBlob.hpp"
+#include "game/World.hpp"
+
+#include "main/Tracing.hpp"
+
+#include <sqee/maths/Culling.hpp>
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+// bounds are grown slightly so that rounding in the capsule test can never
+// report an intersection that the bounds have already rejected
+constexpr const float BOUNDS_MARGIN = 0.001f;
+
+MinMax<Vec3F> compute_capsule_bounds(const maths::Capsule& capsule)
+{
+    const float extent = capsule.radius + BOUNDS_MARGIN;
+    return { maths::min(capsule.originA, capsule.originB) - Vec3F(extent), maths::max(capsule.originA, capsule.originB) + Vec3F(extent) };
+}
+
+void expand_bounds(MinMax<Vec3F>& bounds, const MinMax<Vec3F>& other)
+{
+    bounds.min = maths::min(bounds.min, other.min);
+    bounds.max = maths::max(bounds.max, other.max);
+}
+
+bool bounds_overlap(const MinMax<Vec3F>& a, const MinMax<Vec3F>& b)
+{
+    return a.min.x <= b.max.x && b.min.x <= a.max.x &&
+           a.min.y <= b.max.y && b.min.y <= a.max.y &&
+           a.min.z <= b.max.z && b.min.z <= a.max.z;
+}
+
+} // anonymous namespace
+
+//============================================================================//
+
+CollisionSystem::CollisionSystem(World& world) : world(world) {}
+
+CollisionSystem::~CollisionSystem() = default;
+
+//============================================================================//
+
+void CollisionSystem::tick()
+{
+    STS_TRACE_ZONE("CollisionSystem::tick");
+
+    mReboundDamages.fill(0.f);
+
+    impl_update_capsules();
+
+    impl_update_bounds();
+
+    impl_find_hit_hit_collisions();
+
+    impl_find_candidate_pairs();
+
+    impl_find_hurt_hit_collisions();
+
+    if (mCheckReference == true)
+        impl_check_reference_collisions();
+
+    impl_apply_hits_and_grabs();
+}
+
+//============================================================================//
+
+void CollisionSystem::impl_update_capsules()
+{
+    for (auto& fighter : world.get_fighters())
+    {
+        for (HurtBlob& blob : fighter->get_hurt_blobs())
+        {
+            const Mat4F matrix = fighter->get_model_matrix(blob.def.bone);
+
+            blob.capsule.originA = Vec3F(matrix * Vec4F(blob.def.originA, 1.f));
+            blob.capsule.originB = Vec3F(matrix * Vec4F(blob.def.originB, 1.f));
+            blob.capsule.radius = blob.def.radius;
+        }
+    }
+
+    const auto update_hit_blob_transforms = [](Entity& entity)
+    {
+        for (HitBlob& blob : entity.get_hit_blobs())
+        {
+            const Mat4F matrix = entity.get_model_matrix(blob.def.bone);
+
+            if (blob.justCreated == true)
+            {
+                blob.capsule.originA = Vec3F(matrix * Vec4F(blob.def.origin, 1.f));
+                blob.capsule.originB = blob.capsule.originA;
+                blob.capsule.radius = blob.def.radius;
+                blob.justCreated = false;
+            }
+            else
+            {
+                blob.capsule.originB = blob.capsule.originA;
+                blob.capsule.originA = Vec3F(matrix * Vec4F(blob.def.origin, 1.f));
+            }
+        }
+    };
+
+    for (auto& fighter : world.get_fighters())
+        update_hit_blob_transforms(*fighter);
+
+    for (auto& article : world.get_articles())
+        update_hit_blob_transforms(*article);
+}
+
+//============================================================================//
+
+void CollisionSystem::impl_find_hit_hit_collisions()
+{
+    const auto& fighters = world.get_fighters();
+
+    for (size_t firstIndex = 0; firstIndex + 1 < fighters.size(); ++firstIndex)
+    {
+        auto& firstFighter = fighters[firstIndex];
+        for (HitBlob& firstBlob : firstFighter->get_hit_blobs())
+        {
+            for (size_t secondIndex = firstIndex + 1; secondIndex < fighters.size(); ++secondIndex)
+            {
+                auto& secondFighter = fighters[secondIndex];
+                auto& secondBlobs = secondFighter->get_hit_blobs();
+
+                mIntersectResults.resize(secondBlobs.size());
+                mHitCapsules.intersect(firstBlob.capsule, mHitBlobOffsets[secondIndex], secondBlobs.size(), mIntersectResults.data(), false);
+
+                for (size_t blobIndex = 0u; blobIndex < secondBlobs.size(); ++blobIndex)
+                {
+                    HitBlob& secondBlob = secondBlobs[blobIndex];
+
+                    // blobs do not intersect
+                    if (mIntersectResults[blobIndex] == false) continue;
+
+                    if (firstBlob.def.type == BlobType::Damage)
+                    {
+                        if (secondBlob.def.type != BlobType::Damage) continue;
+
+                        // first or second blob is transcendent
+                        if (firstBlob.def.clangMode == BlobClangMode::Ignore || secondBlob.def.clangMode == BlobClangMode::Ignore) continue;
+
+                        // todo: air attacks can clang with projectiles
+                        if (firstBlob.def.clangMode == BlobClangMode::Air || secondBlob.def.clangMode == BlobClangMode::Air) continue;
+
+                        const float damageDiff = firstBlob.def.damage - secondBlob.def.damage;
+
+                        if (damageDiff < +9.f) firstBlob.cancelled = true;
+                        if (damageDiff > -9.f) secondBlob.cancelled = true;
+
+                        if (damageDiff > -9.f && damageDiff < +9.f)
+                        {
+                            if (firstBlob.def.clangMode == BlobClangMode::Ground)
+                                mReboundDamages[firstFighter->index] =
+                                    std::max(mReboundDamages[firstFighter->index], firstBlob.def.damage);
+
+                            if (secondBlob.def.clangMode == BlobClangMode::Ground)
+                                mReboundDamages[secondFighter->index] =
+                                    std::max(mReboundDamages[secondFighter->index], secondBlob.def.damage);
+                        }
+                    }
+
+                    else if (firstBlob.def.type == BlobType::Grab)
+                    {
+                        if (secondBlob.def.type != BlobType::Grab) continue;
+
+                        // grabs can only rebound if both fighters are facing each other
+                        const auto &firstVars = firstFighter->variables, &secondVars = secondFighter->variables;
+                        if (firstVars.position.x < secondVars.position.x && (firstVars.facing == -1 || secondVars.facing == +1)) continue;
+                        if (firstVars.position.x > secondVars.position.x && (firstVars.facing == +1 || secondVars.facing == -1)) continue;
+
+                        // grabs always rebound with the same damage
+                        mReboundDamages[firstFighter->index] = std::max(mReboundDamages[firstFighter->index], 5.f);
+                        mReboundDamages[secondFighter->index] = std::max(mReboundDamages[secondFighter->index], 5.f);
+                        firstBlob.cancelled = true;
+                        secondBlob.cancelled = true;
+                    }
+
+                    else SQEE_UNREACHABLE();
+                }
+            }
+        }
+    }
+}
+
+//============================================================================//
+
+void CollisionSystem::impl_update_bounds()
+{
+    const auto& fighters = world.get_fighters();
+    const auto& articles = world.get_articles();
+
+    mHurtCapsules.clear();
+    mHitCapsules.clear();
+    mHurtBlobBounds.clear();
+    mHitBlobOffsets.clear();
+    mHitBounds.clear();
+
+    for (auto& fighter : fighters)
+    {
+        MinMax<Vec3F>& fighterBounds = mHurtBounds[fighter->index] = {};
+        mHurtBlobOffsets[fighter->index] = uint32_t(mHurtBlobBounds.size());
+
+        for (const HurtBlob& blob : fighter->get_hurt_blobs())
+        {
+            mHurtCapsules.push_back(blob.capsule);
+            const MinMax<Vec3F>& blobBounds = mHurtBlobBounds.emplace_back(compute_capsule_bounds(blob.capsule));
+
+            // intangible blobs can't be hit, so they don't need to be in the fighter's bounds
+            if (blob.intangible == false) expand_bounds(fighterBounds, blobBounds);
+        }
+    }
+
+    mHurtBlobOffsets[fighters.size()] = uint32_t(mHurtBlobBounds.size());
+
+    const auto update_hit_bounds = [&](const Entity& entity)
+    {
+        MinMax<Vec3F>& entityBounds = mHitBounds.emplace_back();
+        mHitBlobOffsets.push_back(uint32_t(mHitCapsules.size()));
+
+        for (const HitBlob& blob : entity.get_hit_blobs())
+        {
+            mHitCapsules.push_back(blob.capsule);
+            expand_bounds(entityBounds, compute_capsule_bounds(blob.capsule));
+        }
+    };
+
+    for (auto& fighter : fighters)
+        update_hit_bounds(*fighter);
+
+    for (auto& article : articles)
+        update_hit_bounds(*article);
+
+    mHitBlobOffsets.push_back(uint32_t(mHitCapsules.size()));
+}
+
+//============================================================================//
+
+void CollisionSystem::impl_find_candidate_pairs()
+{
+    const auto& fighters = world.get_fighters();
+    const auto& articles = world.get_articles();
+
+    //-- collect entities that have any blobs ----------------//
+
+    mSweepEntries.clear();
+
+    for (auto& fighter : fighters)
+    {
+        const MinMax<Vec3F>& bounds = mHurtBounds[fighter->index];
+
+        // bounds are empty if the fighter has no tangible hurt blobs
+        if (fighter->variables.intangible == false && bounds.min.x <= bounds.max.x)
+            mSweepEntries.push_back({bounds.min.x, bounds.max.x, uint32_t(fighter->index), true});
+    }
+
+    for (size_t index = 0u; index < mHitBounds.size(); ++index)
+    {
+        const MinMax<Vec3F>& bounds = mHitBounds[index];
+
+        if (bounds.min.x <= bounds.max.x)
+            mSweepEntries.push_back({bounds.min.x, bounds.max.x, uint32_t(index), false});
+    }
+
+    //-- sweep along x, testing the other axes on overlap ----//
+
+    ranges::sort(mSweepEntries, {}, &SweepEntry::min);
+
+    mSweepActive.clear();
+    mCandidatePairs.clear();
+
+    for (const SweepEntry& entry : mSweepEntries)
+    {
+        // entries that end before this one starts can't overlap anything else
+        sq::erase_if(mSweepActive, [&](const SweepEntry& active) { return active.max < entry.min; });
+
+        for (const SweepEntry& active : mSweepActive)
+        {
+            if (active.hurt == entry.hurt) continue;
+
+            const SweepEntry& hurt = entry.hurt ? entry : active;
+            const SweepEntry& hit = entry.hurt ? active : entry;
+
+            // entities can't hit themselves or their own fighter
+            if (hit.index < fighters.size() ? hit.index == hurt.index : articles[hit.index - fighters.size()]->fighter == fighters[hurt.index].get()) continue;
+
+            if (bounds_overlap(mHurtBounds[hurt.index], mHitBounds[hit.index]) == false) continue;
+
+            mCandidatePairs.emplace_back(hurt.index, hit.index);
+        }
+
+        mSweepActive.push_back(entry);
+    }
+
+    //-- sort so that pairs are visited in entity order ------//
+
+    // this is the same order as testing every pair, so the same collisions get chosen
+    ranges::sort(mCandidatePairs);
+
+    for (auto& fighter : fighters)
+    {
+        const auto lower = ranges::lower_bound(mCandidatePairs, std::pair(uint32_t(fighter->index), 0u));
+        const auto upper = ranges::lower_bound(mCandidatePairs, std::pair(uint32_t(fighter->index) + 1u, 0u));
+        mCandidateRanges[fighter->index] = { uint32_t(lower - mCandidatePairs.begin()), uint32_t(upper - mCandidatePairs.begin()) };
+    }
+}
+
+//============================================================================//
+
+void CollisionSystem::impl_find_hurt_hit_collisions()
+{
+    const auto& fighters = world.get_fighters();
+    const auto& articles = world.get_articles();
+
+    // capacity is kept, so these only allocate when the number of entities grows
+    mHurtCollisions.clear();
+    mEntityCollisions.resize(fighters.size() + articles.size());
+
+    for (auto& hurtFighter : fighters)
+    {
+        const Fighter::Variables& hurtVars = hurtFighter->variables;
+
+        auto& [rangeBegin, rangeEnd] = mHurtRanges[hurtFighter->index];
+        rangeBegin = rangeEnd = uint32_t(mHurtCollisions.size());
+
+        if (hurtVars.intangible) continue;
+
+        // nothing is close enough to hit this fighter
+        const auto [candidatesBegin, candidatesEnd] = mCandidateRanges[hurtFighter->index];
+        if (candidatesBegin == candidatesEnd) continue;
+
+        // fighters use their index, articles come after them
+        ranges::fill(mEntityCollisions, -1);
+
+        auto& hurtBlobs = hurtFighter->get_hurt_blobs();
+
+        for (size_t hurtIndex = 0u; hurtIndex < hurtBlobs.size(); ++hurtIndex)
+        {
+            HurtBlob& hurtBlob = hurtBlobs[hurtIndex];
+            if (hurtBlob.intangible) continue;
+
+            const MinMax<Vec3F>& hurtBounds = mHurtBlobBounds[mHurtBlobOffsets[hurtFighter->index] + hurtIndex];
+
+            const auto find_hit_blob_collisions = [&](Entity& hitEntity, Fighter* hitFighter, size_t entityIndex)
+            {
+                // whole entity is too far away from this blob
+                if (bounds_overlap(mHitBounds[entityIndex], hurtBounds) == false) return;
+
+                // hitEntity has already hit hurtFighter since the last reset
+                if (auto& vec = hitEntity.get_ignore_collisions(); ranges::find(vec, hurtFighter->eid) != vec.end()) return;
+
+                auto& hitBlobs = hitEntity.get_hit_blobs();
+
+                // whether hurtBlob has already collided with any of hitEntity's blobs
+                bool blobHasCollision = false;
+
+                // test all of the entity's blobs at once, most are usually needed anyway
+                mIntersectResults.resize(hitBlobs.size());
+                mHitCapsules.intersect(hurtBlob.capsule, mHitBlobOffsets[entityIndex], hitBlobs.size(), mIntersectResults.data(), true);
+
+                for (size_t hitIndex = 0u; hitIndex < hitBlobs.size(); ++hitIndex)
+                {
+                    HitBlob& hitBlob = hitBlobs[hitIndex];
+
+                    if (hitBlob.def.type == BlobType::Grab)
+                    {
+                        SQASSERT(hitFighter != nullptr, "non-fighter hitblob can't be a grab");
+                        const Fighter::Variables& hitVars = hitFighter->variables;
+
+                        // fighter is not grabable
+                        if (!hurtVars.grabable) continue;
+
+                        // can only grab fighters in front of you
+                        if (hitVars.facing == -1 && hitVars.position.x < hurtVars.position.x) continue;
+                        if (hitVars.facing == +1 && hitVars.position.x > hurtVars.position.x) continue;
+                    }
+
+                    // hitBlob got cancelled by another hitBlob
+                    if (hitBlob.cancelled) continue;
+
+                    // hitBlob can not hit grounded or airborne fighter
+                    if (!hitBlob.def.canHitGround && hurtVars.onGround) continue;
+                    if (!hitBlob.def.canHitAir && !hurtVars.onGround) continue;
+
+                    // blobs do not intersect
+                    if (mIntersectResults[hitIndex] == false) continue;
+
+                    int32_t& collisionIndex = mEntityCollisions[entityIndex];
+
+                    // already have a collision with this hurtBlob, check if the new one is better
+                    if (blobHasCollision == true)
+                    {
+                        HurtCollision& best = mHurtCollisions[collisionIndex];
+
+                        // todo: should invincible hurtBlobs have special rules?
+
+                        // same hitBlob, choose hurtBlob with highest priority
+                        if (&hitBlob == best.hit)
+                        {
+                            // lower enum value means higher priority (middle, lower, upper)
+                            if (hurtBlob.def.region >= best.hurt->def.region) continue;
+                        }
+
+                        // choose hitBlob with highest priority
+                        else if (hitBlob.def.index >= best.hit->def.index) continue;
+
+                        best.hurt = &hurtBlob;
+                        best.hit = &hitBlob;
+                    }
+
+                    // first collision for this hurtBlob replaces any from earlier hurtBlobs
+                    else if (collisionIndex != -1)
+                    {
+                        HurtCollision& best = mHurtCollisions[collisionIndex];
+
+                        best.hurt = &hurtBlob;
+                        best.hit = &hitBlob;
+                    }
+
+                    // first time this frame that hurtFighter was hit by hitEntity
+                    else
+                    {
+                        collisionIndex = int32_t(mHurtCollisions.size());
+                        mHurtCollisions.push_back({&hitEntity, hitFighter, &hurtBlob, &hitBlob});
+                    }
+
+                    blobHasCollision = true;
+                }
+            };
+
+            for (uint32_t index = candidatesBegin; index < candidatesEnd; ++index)
+            {
+                const size_t entityIndex = mCandidatePairs[index].second;
+
+                if (entityIndex < fighters.size())
+                    find_hit_blob_collisions(*fighters[entityIndex], fighters[entityIndex].get(), entityIndex);
+                else
+                    find_hit_blob_collisions(*articles[entityIndex - fighters.size()], nullptr, entityIndex);
+            }
+        }
+
+        rangeEnd = uint32_t(mHurtCollisions.size());
+    }
+}
+
+//============================================================================//
+
+void CollisionSystem::impl_check_reference_collisions()
+{
+    const auto& fighters = world.get_fighters();
+    const auto& articles = world.get_articles();
+
+    bool mismatch = false;
+
+    for (auto& hurtFighter : fighters)
+    {
+        const Fighter::Variables& hurtVars = hurtFighter->variables;
+
+        // this is the search from World::impl_update_collisions before CollisionSystem existed
+        std::map<Entity*, std::pair<HurtBlob*, HitBlob*>> reference;
+
+        for (HurtBlob& hurtBlob : hurtFighter->get_hurt_blobs())
+        {
+            if (hurtVars.intangible || hurtBlob.intangible) continue;
+
+            const auto find_hit_blob_collisions = [&](Entity& hitEntity, Fighter* hitFighter)
+            {
+                if (auto& vec = hitEntity.get_ignore_collisions(); ranges::find(vec, hurtFighter->eid) != vec.end()) return;
+
+                std::pair<HurtBlob*, HitBlob*>* best = nullptr;
+
+                for (HitBlob& hitBlob : hitEntity.get_hit_blobs())
+                {
+                    if (hitBlob.def.type == BlobType::Grab)
+                    {
+                        if (!hurtVars.grabable) continue;
+                        if (hitFighter->variables.facing == -1 && hitFighter->variables.position.x < hurtVars.position.x) continue;
+                        if (hitFighter->variables.facing == +1 && hitFighter->variables.position.x > hurtVars.position.x) continue;
+                    }
+
+                    if (hitBlob.cancelled) continue;
+
+                    if (!hitBlob.def.canHitGround && hurtVars.onGround) continue;
+                    if (!hitBlob.def.canHitAir && !hurtVars.onGround) continue;
+
+                    if (!maths::intersect_capsule_capsule(hitBlob.capsule, hurtBlob.capsule)) continue;
+
+                    if (best != nullptr)
+                    {
+                        if (&hitBlob == best->second)
+                        {
+                            if (hurtBlob.def.region >= best->first->def.region) continue;
+                        }
+                        else if (hitBlob.def.index >= best->second->def.index) continue;
+                    }
+                    else best = &reference[&hitEntity];
+
+                    *best = { &hurtBlob, &hitBlob };
+                }
+            };
+
+            for (auto& hitFighter : fighters)
+                if (hitFighter != hurtFighter)
+                    find_hit_blob_collisions(*hitFighter, hitFighter.get());
+
+            for (auto& hitArticle : articles)
+                if (hitArticle->fighter != hurtFighter.get())
+                    find_hit_blob_collisions(*hitArticle, nullptr);
+        }
+
+        //-- compare, ignoring the order of entities -------------//
+
+        const auto [rangeBegin, rangeEnd] = mHurtRanges[hurtFighter->index];
+
+        if (rangeEnd - rangeBegin != reference.size())
+        {
+            sq::log_warning("fighter {} has {} collisions, but the reference has {}", hurtFighter->index, rangeEnd - rangeBegin, reference.size());
+            mismatch = true;
+        }
+
+        for (uint32_t index = rangeBegin; index < rangeEnd; ++index)
+        {
+            const HurtCollision& collision = mHurtCollisions[index];
+
+            const auto iter = reference.find(collision.hitEntity);
+
+            if (iter == reference.end() || iter->second != std::pair(collision.hurt, collision.hit))
+            {
+                sq::log_warning("fighter {} was hit by {} with a different pair of blobs to the reference", hurtFighter->index, collision.hitEntity->eid);
+                mismatch = true;
+            }
+        }
+    }
+
+    if (mismatch == true)
+        ++mReferenceMismatches;
+}
+
+//============================================================================//
+
+void CollisionSystem::impl_apply_hits_and_grabs()
+{
+    const auto& fighters = world.get_fighters();
+
+    //-- apply hits and build lists of possible grabs --------//
+
+    // whether each fighter got hit by any attacks
+    std::array<bool, MAX_FIGHTERS> hitByAttack {};
+
+    // list of potential grab victims for each fighter
+    std::array<StackVector<Fighter*, MAX_FIGHTERS-1>, MAX_FIGHTERS> possibleGrabs;
+
+    for (auto& hurtFighter : fighters)
+    {
+        const auto [rangeBegin, rangeEnd] = mHurtRanges[hurtFighter->index];
+
+        if (rangeBegin != rangeEnd)
+        {
+            for (uint32_t index = rangeBegin; index < rangeEnd; ++index)
+            {
+                const HurtCollision& collision = mHurtCollisions[index];
+
+                if (collision.hit->def.type == BlobType::Damage)
+                {
+                    // note that the order that hits accumulate does not matter
+                    if (hurtFighter->accumulate_hit(*collision.hit, *collision.hurt))
+                        hitByAttack[hurtFighter->index] = true;
+
+                    collision.hitEntity->get_ignore_collisions().push_back(hurtFighter->eid);
+                }
+                else if (collision.hit->def.type == BlobType::Grab)
+                {
+                    // todo: check the stage for a wall between the fighters
+                    possibleGrabs[collision.hitFighter->index].push_back(hurtFighter.get());
+                }
+                else SQEE_UNREACHABLE();
+            }
+
+            if (hitByAttack[hurtFighter->index] == true)
+            {
+                // change action and state after one or more hits are accumlated
+                hurtFighter->apply_hits();
+
+                // getting hit by an attack prevents grabbing and rebounding
+                possibleGrabs[hurtFighter->index].clear();
+                mReboundDamages[hurtFighter->index] = 0.f;
+            }
+        }
+    }
+
+    //-- find the closest possible grab for each fighter -----//
+
+    std::array<Fighter*, MAX_FIGHTERS> closestGrabs {};
+
+    for (auto& fighter : fighters)
+    {
+        // can only grab fighters that weren't hit by an attack
+        sq::erase_if(possibleGrabs[fighter->index], [&](Fighter* victim) { return hitByAttack[victim->index]; });
+
+        if (possibleGrabs[fighter->index].empty() == false)
+        {
+            // technically port priority if two fighters are somehow EXACTLY the same distance away
+            closestGrabs[fighter->index] = *ranges::min_element (
+                possibleGrabs[fighter->index], {},
+                [&](Fighter* victim) { return maths::distance_squared(fighter->variables.position, victim->variables.position); }
+            );
+        }
+    }
+
+    //-- confirm all non-circular grabs and apply them -------//
+
+    if (ranges::any_of(closestGrabs, std::identity())) // at least one non-nullptr
+    {
+        // will randomise winners of any contested grabs
+        StackVector<Fighter*, MAX_FIGHTERS> shuffled;
+        for (auto& fighter : fighters) shuffled.push_back(fighter.get());
+        ranges::shuffle(shuffled, world.get_rng());
+
+        std::array<bool, MAX_FIGHTERS> confirmedGrabs {};
+
+        while (true)
+        {
+            bool confirmedSome = false;
+
+            for (auto& fighter : shuffled)
+            {
+                if (auto& victim = closestGrabs[fighter->index])
+                {
+                    // nobody else is trying to grab us
+                    if (ranges::find(closestGrabs, fighter) == closestGrabs.end())
+                    {
+                        // prevent anyone else from grabbing our victim
+                        for (auto& otherVictim : closestGrabs)
+                            if (&otherVictim != &victim && otherVictim == victim)
+                                otherVictim = nullptr;
+
+                        // prevent our victim from grabbing anyone else
+                        closestGrabs[victim->index] = nullptr;
+
+                        confirmedSome = confirmedGrabs[fighter->index] = true;
+                    }
+                }
+            }
+
+            // all possible grabs have been confirmed
+            if (ranges::equal(closestGrabs, confirmedGrabs, [](Fighter* lhs, bool rhs) { return bool(lhs) == rhs; })) break;
+
+            // failed to confirm any grabs, the rest are circular
+            if (confirmedSome == false) break;
+        }
+
+        for (auto& fighter : fighters)
+        {
+            if (auto& victim = closestGrabs[fighter->index])
+            {
+                if (confirmedGrabs[fighter->index] == true)
+                    fighter->apply_grab(*victim);
+
+                // our grab was prevented due to circular grabs
+                else mReboundDamages[fighter->index] = 5.f;
+            }
+        }
+    }
+
+    //-- apply rebounds --------------------------------------//
+
+    for (auto& fighter : fighters)
+        if (mReboundDamages[fighter->index] != 0.f)
+            fighter->apply_rebound(mReboundDamages[fighter->index]);
+}
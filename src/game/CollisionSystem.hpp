@@ -0,0 +1,143 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include "game/CapsuleArray.hpp"
+
+namespace sts {
+
+//============================================================================//
+
+/// Finds and resolves collisions between hit blobs and hurt blobs.
+///
+/// All working storage is owned by the system and reused every tick, so once
+/// it has grown to fit the largest tick so far, ticking doesn't allocate.
+///
+/// Before any capsules are tested, a sweep-and-prune over entity bounding boxes
+/// finds which hurt fighters and hit entities could touch, then each blob pair
+/// is checked against blob bounding boxes. Capsules are then tested in batches,
+/// using copies of them kept in structure of arrays form.
+class CollisionSystem final
+{
+public: //====================================================//
+
+    CollisionSystem(World& world);
+
+    SQEE_COPY_DELETE(CollisionSystem)
+    SQEE_MOVE_DELETE(CollisionSystem)
+
+    ~CollisionSystem();
+
+    //--------------------------------------------------------//
+
+    /// Update blob capsules, then apply hits, grabs, and rebounds.
+    void tick();
+
+    //--------------------------------------------------------//
+
+    /// Hurt blob capsules from the last tick, grouped by fighter.
+    const CapsuleArray& get_hurt_capsules() const { return mHurtCapsules; }
+
+    /// Hit blob capsules from the last tick, grouped by fighter, then by article.
+    const CapsuleArray& get_hit_capsules() const { return mHitCapsules; }
+
+    //--------------------------------------------------------//
+
+    /// Also find hurt collisions the way the old collision pass did, and compare.
+    ///
+    /// The reference tests every pair of blobs with intersect_capsule_capsule,
+    /// and allocates, so this should only be enabled by tests.
+    void set_check_reference(bool enable) { mCheckReference = enable; }
+
+    /// Number of ticks where the chosen collisions differed from the reference.
+    uint get_reference_mismatches() const { return mReferenceMismatches; }
+
+private: //===================================================//
+
+    struct SweepEntry
+    {
+        float min, max;   ///< Extent along the sweep axis.
+        uint32_t index;   ///< Fighter index if hurt, otherwise entity index.
+        bool hurt;
+    };
+
+    struct HurtCollision
+    {
+        Entity* hitEntity;
+        Fighter* hitFighter; ///< Null if hitEntity is an article.
+        HurtBlob* hurt;
+        HitBlob* hit;
+    };
+
+    //--------------------------------------------------------//
+
+    void impl_update_capsules();
+
+    void impl_find_hit_hit_collisions();
+
+    void impl_update_bounds();
+
+    void impl_find_candidate_pairs();
+
+    void impl_find_hurt_hit_collisions();
+
+    void impl_check_reference_collisions();
+
+    void impl_apply_hits_and_grabs();
+
+    //--------------------------------------------------------//
+
+    World& world;
+
+    CapsuleArray mHurtCapsules, mHitCapsules;
+
+    /// Bounds of every hurt blob, in the same order as mHurtCapsules.
+    std::vector<MinMax<Vec3F>> mHurtBlobBounds;
+
+    /// Offset into mHurtCapsules for each fighter, plus one for the end.
+    std::array<uint32_t, MAX_FIGHTERS + 1u> mHurtBlobOffsets {};
+
+    /// Offset into mHitCapsules for each entity, plus one for the end.
+    std::vector<uint32_t> mHitBlobOffsets;
+
+    /// Results of the most recent batched capsule test.
+    std::vector<uint8_t> mIntersectResults;
+
+    /// Bounds of all tangible hurt blobs for each fighter.
+    std::array<MinMax<Vec3F>, MAX_FIGHTERS> mHurtBounds {};
+
+    /// Bounds of all hit blobs for each entity.
+    std::vector<MinMax<Vec3F>> mHitBounds;
+
+    /// Sweep entries, sorted by min, and entries that still overlap the sweep.
+    std::vector<SweepEntry> mSweepEntries, mSweepActive;
+
+    /// Pairs of hurt fighter index and hit entity index that could collide, sorted.
+    std::vector<std::pair<uint32_t, uint32_t>> mCandidatePairs;
+
+    /// Range of mCandidatePairs for each hurt fighter.
+    std::array<std::pair<uint32_t, uint32_t>, MAX_FIGHTERS> mCandidateRanges {};
+
+    /// Chosen collision for each fighter and hit entity, grouped by hurt fighter.
+    ///
+    /// As before this system existed, the last hurt blob to touch an entity wins,
+    /// and hit blob priority only decides between blobs touching the same hurt blob.
+    std::vector<HurtCollision> mHurtCollisions;
+
+    /// Range of mHurtCollisions for each hurt fighter.
+    std::array<std::pair<uint32_t, uint32_t>, MAX_FIGHTERS> mHurtRanges {};
+
+    /// Index into mHurtCollisions for each hit entity, reset for each hurt fighter.
+    std::vector<int32_t> mEntityCollisions;
+
+    /// Max damage of hitblobs causing rebound.
+    std::array<float, MAX_FIGHTERS> mReboundDamages {};
+
+    bool mCheckReference = false;
+
+    uint mReferenceMismatches = 0u;
+};
+
+//============================================================================//
+
+} // namespace sts
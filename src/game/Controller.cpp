@@ -6,8 +6,33 @@ using namespace sts;
 
 //============================================================================//
 
+DISABLE_WARNING_FLOAT_EQUALITY()
+
+bool InputFrame::operator==(const InputFrame& other) const
+{
+    return pressAttack == other.pressAttack &&
+           pressSpecial == other.pressSpecial &&
+           pressJump == other.pressJump &&
+           pressShield == other.pressShield &&
+           pressGrab == other.pressGrab &&
+           holdAttack == other.holdAttack &&
+           holdSpecial == other.holdSpecial &&
+           holdJump == other.holdJump &&
+           holdShield == other.holdShield &&
+           holdGrab == other.holdGrab &&
+           intX == other.intX && intY == other.intY &&
+           mashX == other.mashX && mashY == other.mashY &&
+           modX == other.modX && modY == other.modY &&
+           relIntX == other.relIntX && relMashX == other.relMashX && relModX == other.relModX &&
+           floatX == other.floatX && floatY == other.floatY;
+}
+
+ENABLE_WARNING_FLOAT_EQUALITY()
+
+//============================================================================//
+
 Controller::Controller(const sq::InputDevices& devices, const String& configPath)
-    : devices(devices)
+    : devices(&devices)
 {
     const auto document = JsonDocument::parse_file(configPath);
     const auto json = document.root().as<JsonObject>();
@@ -47,6 +72,16 @@ Controller::Controller(const sq::InputDevices& devices, const String& configPath
     history.frames.emplace_back();
 }
 
+Controller::Controller()
+    : devices(nullptr)
+{
+    // virtual input is stored in the same place as keyboard input
+    mKeyboardMode = true;
+
+    // make sure we have a "previous" value
+    history.frames.emplace_back();
+}
+
 //============================================================================//
 
 void Controller::refresh()
@@ -57,14 +92,18 @@ void Controller::refresh()
 
     mPolledSinceLastTick = true;
 
+    // input only comes from feed_input
+    if (devices == nullptr)
+        return;
+
     //--------------------------------------------------------//
 
     // ask the operating system for updated gamepad state
     if (mGamepadEnabled == true)
     {
-        if (devices.check_gamepad_connected(config.gamepad_port))
+        if (devices->check_gamepad_connected(config.gamepad_port))
         {
-            mGamepad.integrate(devices.poll_gamepad_state(config.gamepad_port));
+            mGamepad.integrate(devices->poll_gamepad_state(config.gamepad_port));
             mKeyboardMode = false;
         }
         else // gamepad is configured but not connected
@@ -81,7 +120,7 @@ void Controller::refresh()
     {
         const auto update_button = [this](sq::Keyboard_Key key, uint8_t index)
         {
-            const bool latest = devices.is_pressed(key);
+            const bool latest = devices->is_pressed(key);
 
             mKeyboard.pressed[index] |= !mKeyboard.buttons[index] && latest;
             mKeyboard.released[index] |= mKeyboard.buttons[index] && !latest;
@@ -92,8 +131,8 @@ void Controller::refresh()
         {
             float latest = 0.f;
 
-            if (devices.is_pressed(negKey)) latest -= 1.f;
-            if (devices.is_pressed(posKey)) latest += 1.f;
+            if (devices->is_pressed(negKey)) latest -= 1.f;
+            if (devices->is_pressed(posKey)) latest += 1.f;
 
             if (std::abs(latest) >= std::abs(mKeyboard.axes[index]))
                 mKeyboard.axes[index] = latest;
@@ -111,6 +150,48 @@ void Controller::refresh()
 
 //============================================================================//
 
+void Controller::feed_input(const std::array<bool, 5>& buttons, Vec2F axes)
+{
+    SQASSERT(devices == nullptr, "controller has real devices");
+
+    mPolledSinceLastTick = true;
+
+    for (uint8_t index = 0u; index < 5u; ++index)
+    {
+        mKeyboard.pressed[index] |= !mKeyboard.buttons[index] && buttons[index];
+        mKeyboard.released[index] |= mKeyboard.buttons[index] && !buttons[index];
+        mKeyboard.buttons[index] = buttons[index];
+    }
+
+    if (std::abs(axes.x) >= std::abs(mKeyboard.axes[0])) mKeyboard.axes[0] = axes.x;
+    if (std::abs(axes.y) >= std::abs(mKeyboard.axes[1])) mKeyboard.axes[1] = axes.y;
+}
+
+//============================================================================//
+
+void Controller::push_frame(const InputFrame& frame)
+{
+    if (history.frames.full() == true)
+        history.frames.pop_back();
+
+    insert_frame(frame);
+
+    if (mPlaybackIndex == -1)
+        mRecordedInput.push_back(frame);
+}
+
+void Controller::insert_frame(const InputFrame& frame)
+{
+    if (history.cleared == true)
+    {
+        history.frames = { frame };
+        history.cleared = false;
+    }
+    else history.frames.insert(history.frames.begin(), frame);
+}
+
+//============================================================================//
+
 void Controller::tick()
 {
     // make sure we have polled at least once
@@ -129,15 +210,7 @@ void Controller::tick()
     {
         if (mPlaybackIndex < int(mRecordedInput.size()))
         {
-            const InputFrame& record = mRecordedInput[mPlaybackIndex++];
-
-            if (history.cleared == true)
-            {
-                history.frames = { record };
-                history.cleared = false;
-            }
-            else history.frames.insert(history.frames.begin(), record);
-
+            insert_frame(mRecordedInput[mPlaybackIndex++]);
             return; // don't bother getting a new frame
         }
 
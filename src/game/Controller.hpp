@@ -47,6 +47,8 @@ struct InputFrame final
         relMashX = mashX * facing;
         relModX = modX * facing;
     }
+
+    bool operator==(const InputFrame& other) const;
 };
 
 //============================================================================//
@@ -120,12 +122,17 @@ public: //====================================================//
 
     //--------------------------------------------------------//
 
+    /// Create a controller that polls a gamepad and/or the keyboard.
     Controller(const sq::InputDevices& devices, const String& configPath);
 
+    /// Create a controller without devices, driven by feed_input.
+    Controller();
+
     SQEE_COPY_DELETE(Controller)
     SQEE_MOVE_DELETE(Controller)
 
-    const sq::InputDevices& devices;
+    // null for controllers without devices
+    const sq::InputDevices* const devices;
 
     Config config;
 
@@ -139,6 +146,18 @@ public: //====================================================//
     /// Build a new frame of input.
     void tick();
 
+    /// Merge virtual button and axis state into the next frame.
+    void feed_input(const std::array<bool, 5>& buttons, Vec2F axes);
+
+    /// Use a complete frame from elsewhere instead of calling tick.
+    void push_frame(const InputFrame& frame);
+
+    /// Write history and axis timers, called by World::save_state.
+    void save_state(StateBuffer& buffer) const;
+
+    /// Read history and axis timers, called by World::load_state.
+    void load_state(StateReader& reader);
+
     //-- wren methods ----------------------------------------//
 
     InputFrame* wren_get_input() { return &history.frames.front(); }
@@ -147,6 +166,10 @@ public: //====================================================//
 
 private: //===================================================//
 
+    void insert_frame(const InputFrame& frame);
+
+    //--------------------------------------------------------//
+
     sq::Gamepad mGamepad;
     Keyboard mKeyboard;
 
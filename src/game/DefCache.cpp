@@ -0,0 +1,154 @@
+#include "game/DefCache.hpp"
+
+#include "main/AssetArchive.hpp"
+
+#include <sqee/misc/Json.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+constexpr const std::array<char, 4u> CACHE_MAGIC = { 'S', 'T', 'S', 'D' };
+
+constexpr const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr const uint64_t FNV_PRIME = 1099511628211ull;
+
+struct CacheHeader
+{
+    std::array<char, 4u> magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint64_t key;
+    uint64_t payloadSize;
+    uint64_t payloadHash; ///< Catches truncated or corrupted files.
+};
+
+String get_cache_path(const String& jsonPath)
+{
+    return fmt::format("cache/defs/{}.bin", jsonPath);
+}
+
+/// Read the payload of a cache file if its key matches, otherwise leave buffer empty.
+void try_read_cache_file(const String& path, uint64_t key, StateBuffer& buffer)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (stream.good() == false) return;
+
+    CacheHeader header;
+    stream.read(reinterpret_cast<char*>(&header), sizeof(CacheHeader));
+
+    if (stream.good() == false || header.magic != CACHE_MAGIC || header.version != DefCache::VERSION || header.key != key)
+        return;
+
+    const String payload { std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+
+    if (payload.size() != header.payloadSize || DefCache::hash_bytes(FNV_OFFSET_BASIS, payload.data(), payload.size()) != header.payloadHash)
+    {
+        sq::log_warning("'{}': corrupted, recompiling", path);
+        return;
+    }
+
+    buffer.write_bytes(payload.data(), payload.size());
+}
+
+/// Replace a cache file, failures are only logged since the cache is optional.
+void write_cache_file(const String& path, uint64_t key, const StateBuffer& buffer)
+{
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+    CacheHeader header = {};
+    header.magic = CACHE_MAGIC;
+    header.version = DefCache::VERSION;
+    header.key = key;
+    header.payloadSize = buffer.size();
+    header.payloadHash = DefCache::hash_bytes(FNV_OFFSET_BASIS, buffer.data(), buffer.size());
+
+    // write then rename, so that other processes never see a partial file
+    const String tempPath = path + ".tmp";
+    {
+        std::ofstream stream(tempPath, std::ios::binary);
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+        stream.write(reinterpret_cast<const char*>(buffer.data()), std::streamsize(buffer.size()));
+
+        if (stream.good() == false)
+        {
+            sq::log_warning("'{}': could not write", path);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, error);
+    if (error) sq::log_warning("'{}': could not write, {}", path, error.message());
+}
+
+} // anonymous namespace
+
+//============================================================================//
+
+uint64_t DefCache::hash_bytes(uint64_t hash, const void* data, size_t count)
+{
+    for (size_t i = 0u; i < count; ++i)
+        hash = (hash ^ uint64_t(static_cast<const uint8_t*>(data)[i])) * FNV_PRIME;
+    return hash;
+}
+
+uint64_t DefCache::hash_file(const String& path)
+{
+    const auto contents = try_read_asset(path);
+    if (contents.has_value() == false) return 0u;
+
+    return hash_bytes(FNV_OFFSET_BASIS, contents->data(), contents->size());
+}
+
+//============================================================================//
+
+void DefCache::load (
+    const String& jsonPath, uint64_t extraKey,
+    const std::function<bool(JsonObject json, StateBuffer& buffer)>& compile,
+    const std::function<void(StateReader& reader)>& load
+)
+{
+    String text = read_asset(jsonPath);
+
+    uint64_t key = hash_bytes(FNV_OFFSET_BASIS, text.data(), text.size());
+    key = hash_bytes(key, &extraKey, sizeof(extraKey));
+
+    const String cachePath = get_cache_path(jsonPath);
+
+    StateBuffer buffer;
+    try_read_cache_file(cachePath, key, buffer);
+
+    if (buffer.size() != 0u)
+    {
+        // the key matched, but the file could still be from a build with different binary formats
+        try {
+            StateReader reader { buffer };
+            load(reader);
+
+            if (reader.at_end() == true) return;
+            sq::log_warning("'{}': not fully read, recompiling", cachePath);
+        }
+        catch (const std::exception& ex) {
+            sq::log_warning("'{}': {}, recompiling", cachePath, ex.what());
+        }
+
+        buffer.clear();
+    }
+
+    const auto document = JsonDocument::parse_string(std::move(text), jsonPath);
+
+    // json with errors isn't cached, so that the errors are shown again next time
+    if (compile(document.root().as<JsonObject>(), buffer) == true)
+        write_cache_file(cachePath, key, buffer);
+
+    StateReader reader { buffer };
+    load(reader);
+
+    SQASSERT(reader.at_end() == true, "definitions not fully read");
+}
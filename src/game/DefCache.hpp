@@ -0,0 +1,94 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include "game/StateBuffer.hpp"
+
+#include <functional>
+
+namespace sts {
+
+//============================================================================//
+
+/// Binary cache of definitions compiled from json files.
+///
+/// Files are stored under "cache/defs", keyed by a hash of the json text and
+/// of anything else the result depends on, such as the armature used to look
+/// up bones. When the key doesn't match, the json is compiled again and the
+/// cache file replaced, so editing json never needs any extra steps.
+///
+/// Fresh results are written to a buffer and read back just like cached ones,
+/// so both paths always give exactly the same definitions.
+namespace DefCache {
+
+// increment whenever any to_binary function changes
+constexpr const uint16_t VERSION = 1u;
+
+/// FNV-1a hash, for building cache keys.
+uint64_t hash_bytes(uint64_t hash, const void* data, size_t count);
+
+/// Hash of a file, loose or packed, or zero if it doesn't exist.
+uint64_t hash_file(const String& path);
+
+/// Load definitions from a json file, using the cache if the key matches.
+///
+/// Compile should read the document and write definitions to the buffer,
+/// returning false if there were errors so that the result won't be cached.
+/// Load should read them back, it may be called without compile. If reading a
+/// cache file fails, the json is compiled and load is called again.
+void load (
+    const String& jsonPath, uint64_t extraKey,
+    const std::function<bool(JsonObject json, StateBuffer& buffer)>& compile,
+    const std::function<void(StateReader& reader)>& load
+);
+
+//--------------------------------------------------------//
+
+template <class StringType>
+inline void write_string(StateBuffer& buffer, const StringType& str)
+{
+    const StringView view = str;
+    buffer.write(uint32_t(view.size()));
+    buffer.write_bytes(view.data(), view.size());
+}
+
+template <class StringType>
+inline void read_string(StateReader& reader, StringType& str)
+{
+    const uint32_t size = reader.read<uint32_t>();
+    reader.check_remaining(size);
+    String chars(size, '\0');
+    reader.read_bytes(chars.data(), chars.size());
+    str = StringType(StringView(chars));
+}
+
+/// Write a map of definitions that have a to_binary method.
+template <class Map>
+inline void write_map(StateBuffer& buffer, const Map& map)
+{
+    buffer.write(uint32_t(map.size()));
+    for (const auto& [key, value] : map)
+    {
+        write_string(buffer, key);
+        value.to_binary(buffer);
+    }
+}
+
+/// Read a map of definitions that have a from_binary method, replacing its contents.
+template <class Map>
+inline void read_map(StateReader& reader, Map& map)
+{
+    map.clear();
+    for (uint32_t count = reader.read<uint32_t>(); count != 0u; --count)
+    {
+        typename Map::key_type key;
+        read_string(reader, key);
+        map[key].from_binary(reader);
+    }
+}
+
+} // namespace DefCache
+
+//============================================================================//
+
+} // namespace sts
@@ -2,6 +2,7 @@
 
 #include "game/Entity.hpp"
 #include "game/VisualEffect.hpp"
+#include "game/World.hpp"
 
 #include "render/Renderer.hpp"
 
@@ -9,7 +10,7 @@ using namespace sts;
 
 //============================================================================//
 
-EffectSystem::EffectSystem(Renderer& renderer) : renderer(renderer) {}
+EffectSystem::EffectSystem(World& world) : world(world) {}
 
 EffectSystem::~EffectSystem() = default;
 
@@ -98,7 +99,7 @@ void EffectSystem::integrate(float blend)
             effect.bbScaleX = float(effect.entity->get_vars().facing);
         }
 
-        effect.animPlayer.integrate(renderer, effect.modelMatrix, effect.bbScaleX, blend);
+        effect.animPlayer.integrate(*world.renderer, effect.modelMatrix, effect.bbScaleX, blend);
 
         const auto check_condition = [&](const TinyString& condition)
         {
@@ -108,6 +109,6 @@ void EffectSystem::integrate(float blend)
 
         for (const sq::DrawItem& item : asset.drawItems)
             if (check_condition(item.condition) == true)
-                renderer.add_draw_call(item, effect.animPlayer);
+                world.renderer->add_draw_call(item, effect.animPlayer);
     }
 }
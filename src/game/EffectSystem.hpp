@@ -10,7 +10,7 @@ class EffectSystem final
 {
 public: //====================================================//
 
-    EffectSystem(Renderer& renderer);
+    EffectSystem(World& world);
 
     SQEE_COPY_DELETE(EffectSystem)
     SQEE_MOVE_DELETE(EffectSystem)
@@ -31,9 +31,13 @@ public: //====================================================//
 
     void clear();
 
+    void save_state(StateBuffer& buffer) const;
+
+    void load_state(StateReader& reader);
+
 private: //===================================================//
 
-    Renderer& renderer;
+    World& world;
 
     std::vector<std::unique_ptr<VisualEffect>> mEffects;
 
@@ -1,5 +1,7 @@
 #include "game/Emitter.hpp"
 
+#include "game/DefCache.hpp"
+
 #include <sqee/misc/Json.hpp>
 
 using namespace sts;
@@ -67,6 +69,66 @@ void Emitter::to_json(JsonMutObject json, const sq::Armature& armature) const
 
 //============================================================================//
 
+void Emitter::to_binary(StateBuffer& buffer) const
+{
+    buffer.write(bone);
+    buffer.write(count);
+
+    buffer.write(origin);
+    buffer.write(velocity);
+
+    buffer.write(baseOpacity);
+    buffer.write(endOpacity);
+    buffer.write(endScale);
+
+    buffer.write(lifetime);
+    buffer.write(baseRadius);
+
+    buffer.write(ballOffset);
+    buffer.write(ballSpeed);
+
+    buffer.write(discIncline);
+    buffer.write(discOffset);
+    buffer.write(discSpeed);
+
+    buffer.write(uint8_t(colour.size()));
+    for (const Vec3F& choice : colour)
+        buffer.write(choice);
+
+    DefCache::write_string(buffer, sprite);
+}
+
+void Emitter::from_binary(StateReader& reader)
+{
+    reader.read(bone);
+    reader.read(count);
+
+    reader.read(origin);
+    reader.read(velocity);
+
+    reader.read(baseOpacity);
+    reader.read(endOpacity);
+    reader.read(endScale);
+
+    reader.read(lifetime);
+    reader.read(baseRadius);
+
+    reader.read(ballOffset);
+    reader.read(ballSpeed);
+
+    reader.read(discIncline);
+    reader.read(discOffset);
+    reader.read(discSpeed);
+
+    colour.clear();
+    for (uint8_t choices = reader.read<uint8_t>(); choices != 0u; --choices)
+        colour.push_back(reader.read<Vec3F>());
+
+    DefCache::read_string(reader, sprite);
+}
+
+//============================================================================//
+
 DISABLE_WARNING_FLOAT_EQUALITY()
 
 bool Emitter::operator==(const Emitter& other) const
@@ -47,6 +47,11 @@ struct Emitter final
 
     void to_json(JsonMutObject json, const sq::Armature& armature) const;
 
+    /// Write to a DefCache buffer, bones are stored as indices.
+    void to_binary(StateBuffer& buffer) const;
+
+    void from_binary(StateReader& reader);
+
     bool operator==(const Emitter& other) const;
 };
 
@@ -32,14 +32,14 @@ Mat4F Entity::get_model_matrix(int8_t index) const
     // rukai data seems to ignore them for ALL bones in the chain, but that seems really wrong to me
     // see https://github.com/rukai/brawllib_rs/blob/main/src/high_level_fighter.rs#L537
 
-    return mAnimPlayer.armature.compute_model_matrix(mAnimPlayer.currentSample, mModelMatrix, uint8_t(index));
+    return mModelMatrix * mAnimPlayer.get_bone_matrix(uint8_t(index));
 }
 
 Mat4F Entity::get_blended_model_matrix(int8_t index) const
 {
     SQASSERT(index >= -1 && index < int8_t(mAnimPlayer.armature.get_bone_count()), "invalid index");
 
-    const auto matrices = reinterpret_cast<const Mat34F*>(world.renderer.ubos.matrices.map_only());
+    const auto matrices = reinterpret_cast<const Mat34F*>(world.renderer->ubos.matrices.map_only());
 
     return maths::transpose(Mat4F(matrices[mAnimPlayer.modelMatsIndex + index + 1]));
 }
@@ -96,6 +96,27 @@ void Entity::set_next_animation(const Animation& animation, uint fade)
 
 //============================================================================//
 
+void Entity::impl_compute_current_sample()
+{
+    const EntityDef& def = get_def();
+
+    // if animations were baked, whole frames are just a copy
+    if (mAnimPlayer.animation->sample_baked(mAnimPlayer.animTime, mAnimPlayer.currentSample))
+        return;
+
+    if (mAnimPlayer.animation->compressed.empty() == false)
+        return mAnimPlayer.animation->compressed.decompress(def.armature, mAnimPlayer.animTime, mAnimPlayer.currentSample);
+
+    // bones that gameplay doesn't read can be skipped for ticks that don't get rendered
+    if (world.is_unrendered_tick() == true && def.simulationBones.empty() == false)
+        if (compute_partial_sample(def.armature, mAnimPlayer.animation->anim, mAnimPlayer.animTime, def.simulationBones, mAnimPlayer.currentSample))
+            return;
+
+    def.armature.compute_sample(mAnimPlayer.animation->anim, mAnimPlayer.animTime, mAnimPlayer.currentSample);
+}
+
+//============================================================================//
+
 void Entity::update_animation()
 {
     // todo: this is 2 for mario, but should be 1 for STS chars
@@ -103,6 +124,9 @@ void Entity::update_animation()
     // todo: this should probably be set from json
     constexpr uint8_t victimBone = 4;
 
+    // the sample gets replaced below, nothing reads our own bone matrices until it's done
+    mAnimPlayer.invalidate_bone_matrices();
+
     const EntityDef& def = get_def();
     EntityVars& vars = get_vars();
 
@@ -155,7 +179,7 @@ void Entity::update_animation()
     {
         mAnimPlayer.animTime = vars.animTime;
 
-        def.armature.compute_sample(mAnimPlayer.animation->anim, mAnimPlayer.animTime, mAnimPlayer.currentSample);
+        impl_compute_current_sample();
         debugCurrentPoseInfo = fmt::format("{} ({:.3f})", mAnimPlayer.animation->get_key(), mAnimPlayer.animTime);
 
         // todo: locomotion hack, need an option in the export script to just not export root transforms
@@ -163,7 +187,7 @@ void Entity::update_animation()
     }
     else
     {
-        def.armature.compute_sample(mAnimPlayer.animation->anim, mAnimPlayer.animTime, mAnimPlayer.currentSample);
+        impl_compute_current_sample();
         debugCurrentPoseInfo = fmt::format (
             "{} ({} / {})", mAnimPlayer.animation->get_key(), mAnimPlayer.animTime, mAnimPlayer.animation->anim.frameCount
         );
@@ -212,7 +236,7 @@ void Entity::update_animation()
         {
             const AnimPlayer& bullyPlayer = vars.bully->mAnimPlayer;
 
-            const Mat4F matrix = vars.bully->mModelMatrix * bullyPlayer.armature.compute_bone_matrix(bullyPlayer.currentSample, victimBone);
+            const Mat4F matrix = vars.bully->mModelMatrix * bullyPlayer.get_bone_matrix(victimBone);
 
             vars.position.x = matrix[3].x;
             vars.position.y = vars.bully->current.translation.y;
@@ -294,5 +318,5 @@ void Entity::integrate_base(float blend)
 
     const Mat4F modelMatrix = maths::transform(translation, rotation);
 
-    mAnimPlayer.integrate(world.renderer, modelMatrix, vars.facing, blend);
+    mAnimPlayer.integrate(*world.renderer, modelMatrix, vars.facing, blend);
 }
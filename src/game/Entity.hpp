@@ -83,6 +83,8 @@ public: //====================================================//
     /// Access this entity's active hit blobs.
     std::vector<HitBlob>& get_hit_blobs() { return mHitBlobs; }
 
+    const std::vector<HitBlob>& get_hit_blobs() const { return mHitBlobs; }
+
     /// List of entities that we've hit since the last reset.
     StackVector<int32_t, 15u>& get_ignore_collisions() { return mIgnoreCollisions; }
 
@@ -124,12 +126,30 @@ public: //====================================================//
 
     int32_t wren_play_sound(SmallString key, bool stopWithAction);
 
+    void wren_play_animation_id(uint16_t id, uint fade, bool fromStart);
+
+    void wren_set_next_animation_id(uint16_t id, uint fade);
+
+    int32_t wren_play_sound_id(uint16_t id, bool stopWithAction);
+
+    void impl_wren_play_animation(const Animation* animation, StringView key, uint fade, bool fromStart);
+
+    void impl_wren_set_next_animation(const Animation* animation, StringView key, uint fade);
+
+    int32_t impl_wren_play_sound(const SoundEffect* sound, StringView key, bool stopWithAction);
+
     void impl_wren_enable_hitblobs(const std::map<TinyString, HitBlobDef>& blobs, StringView prefix);
 
+    void impl_wren_enable_hitblobs_id(const std::map<TinyString, HitBlobDef>& blobs, std::vector<std::vector<const HitBlobDef*>>& groups, uint16_t id);
+
     int32_t impl_wren_play_effect(const std::map<TinyString, VisualEffectDef>& effects, TinyString key);
 
     void impl_wren_emit_particles(const std::map<TinyString, Emitter>& emitters, TinyString key);
 
+private: //===================================================//
+
+    void impl_compute_current_sample();
+
 protected: //=================================================//
 
     //-- methods used internally or by the editor ------------//
@@ -144,6 +164,10 @@ protected: //=================================================//
 
     void integrate_base(float blend);
 
+    void save_entity_state(StateBuffer& buffer) const;
+
+    void load_entity_state(StateReader& reader);
+
     //--------------------------------------------------------//
 
     AnimPlayer mAnimPlayer;
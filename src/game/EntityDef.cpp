@@ -1,8 +1,18 @@
 #include "game/EntityDef.hpp"
 
+#include "game/DefCache.hpp"
+#include "game/Emitter.hpp"
+#include "game/HitBlob.hpp"
+#include "game/HurtBlob.hpp"
 #include "game/SoundEffect.hpp"
+#include "game/VisualEffect.hpp"
 #include "game/World.hpp"
 
+#include "main/AssetArchive.hpp"
+#include "main/Options.hpp"
+#include "main/Tracing.hpp"
+#include "main/WorkerPool.hpp"
+
 #include "render/AnimPlayer.hpp"
 
 #include <sqee/misc/Json.hpp>
@@ -11,51 +21,192 @@ using namespace sts;
 
 //============================================================================//
 
+EntityDefData::EntityDefData(String directory, bool bakeAnimations)
+    : directory(std::move(directory))
+    , armature(fmt::format("assets/{}/Armature.json", this->directory))
+    , armatureHash(DefCache::hash_file(fmt::format("assets/{}/Armature.json", this->directory)))
+    , bakeAnimations(bakeAnimations)
+{
+    add_source(fmt::format("assets/{}/Armature.json", directory));
+}
+
+EntityDefData::~EntityDefData() = default;
+
+void EntityDefData::add_source(String path)
+{
+    const auto timestamp = get_asset_timestamp(path);
+    sources.emplace_back(std::move(path), timestamp);
+}
+
+bool EntityDefData::is_outdated() const
+{
+    for (const auto& [path, timestamp] : sources)
+        if (get_asset_timestamp(path) != timestamp)
+            return true;
+
+    return false;
+}
+
+//============================================================================//
+
+std::shared_ptr<EntityDefData> EntityDataCache::find(const String& directory, bool bakeAnimations) const
+{
+    const auto iter = mEntries.find(directory);
+
+    if (iter == mEntries.end() || iter->second->bakeAnimations != bakeAnimations)
+        return nullptr;
+
+    if (iter->second->is_outdated() == true)
+    {
+        sq::log_info("'{}': files have changed, reloading", directory);
+        return nullptr;
+    }
+
+    return iter->second;
+}
+
+void EntityDataCache::insert(const String& directory, std::shared_ptr<EntityDefData> data)
+{
+    data->shared = true;
+    mEntries.insert_or_assign(directory, std::move(data));
+}
+
+//============================================================================//
+
+namespace {
+
+std::shared_ptr<EntityDefData> acquire_data(World& world, const String& directory)
+{
+    // editor worlds modify their data, so they always load their own
+    if (world.caches != nullptr && world.editor == nullptr)
+        if (auto data = world.caches->entityData->find(directory, world.options.bake_animations))
+            return data;
+
+    return std::make_shared<EntityDefData>(directory, world.options.bake_animations);
+}
+
+} // anonymous namespace
+
 EntityDef::EntityDef(World& world, String directory)
+    : EntityDef(world, directory, acquire_data(world, directory)) {}
+
+EntityDef::EntityDef(World& world, String directory, std::shared_ptr<EntityDefData> acquired)
     : world(world), directory(directory)
     , name(StringView(directory).substr(directory.rfind('/') + 1))
-    , armature(fmt::format("assets/{}/Armature.json", directory))
+    , data(acquired), reusedData(acquired->shared)
+    , armature(data->armature), armatureHash(data->armatureHash)
+    , animations(data->animations), drawItems(data->drawItems)
 {
-    drawItems = sq::DrawItem::load_from_json (
-        fmt::format("assets/{}/Render.json", directory), armature,
-        world.caches.meshes, world.caches.pipelines, world.caches.textures
-    );
+    if (reusedData == false)
+        mUnsharedData = std::move(acquired);
+
+    // headless worlds have nothing to draw with
+    if (reusedData == false && world.caches != nullptr)
+        mUnsharedData->load_draw_items(*world.caches);
 }
 
 EntityDef::~EntityDef() = default;
 
+void EntityDef::share_data()
+{
+    if (reusedData == true || world.caches == nullptr || world.editor != nullptr) return;
+
+    world.caches->entityData->insert(directory, std::move(mUnsharedData));
+}
+
 //============================================================================//
 
 void EntityDef::initialise_sounds(const String& jsonPath)
 {
-    const auto document = JsonDocument::parse_file(jsonPath);
+    const auto document = parse_asset_json(jsonPath);
 
     for (const auto [key, jSound] : document.root().as<JsonObject>() | views::json_as<JsonObject>)
-        sounds[key].from_json(jSound, world.caches.sounds);
+        sounds[key].from_json(jSound, world.caches ? &world.caches->sounds : nullptr);
 }
 
 //============================================================================//
 
 void EntityDef::initialise_animations(const String& jsonPath)
 {
-    const auto document = JsonDocument::parse_file(jsonPath);
+    SQASSERT(mUnsharedData != nullptr, "can't modify shared data");
+
+    mUnsharedData->load_animations(jsonPath);
+}
+
+void EntityDef::clear_animations()
+{
+    SQASSERT(mUnsharedData != nullptr, "can't modify shared data");
+
+    mUnsharedData->animations.clear();
+}
+
+//============================================================================//
+
+void EntityDef::initialise_key_ids()
+{
+    soundIds.assign(world.keys, sounds);
+    animationIds.assign(world.keys, animations);
+}
+
+//============================================================================//
+
+const SoundEffect* EntityDef::find_sound(uint16_t id) const
+{
+    // the editor adds, removes, and reloads sounds, so the ids may be out of date
+    if (world.editor != nullptr)
+    {
+        const StringView key = world.keys.get_key(id);
+        if (key.length() > SmallString::capacity()) return nullptr;
+
+        const auto iter = sounds.find(SmallString(key));
+        return iter != sounds.end() ? &iter->second : nullptr;
+    }
+
+    return soundIds.find(id);
+}
+
+const Animation* EntityDef::find_animation(uint16_t id) const
+{
+    // the editor reloads animations, so the ids may be out of date
+    if (world.editor != nullptr)
+    {
+        const StringView key = world.keys.get_key(id);
+        if (key.length() > SmallString::capacity()) return nullptr;
+
+        const auto iter = animations.find(SmallString(key));
+        return iter != animations.end() ? &iter->second : nullptr;
+    }
+
+    return animationIds.find(id);
+}
+
+//============================================================================//
+
+void EntityDefData::load_draw_items(ResourceCaches& caches)
+{
+    SQASSERT(shared == false, "can't modify shared data");
+
+    const auto path = fmt::format("assets/{}/Render.json", directory);
+
+    drawItems = sq::DrawItem::load_from_json(path, armature, caches.meshes, caches.pipelines, caches.textures);
+    add_source(path);
+}
+
+void EntityDefData::load_animations(const String& jsonPath, const std::atomic<bool>* cancel)
+{
+    STS_TRACE_ZONE("EntityDefData::load_animations");
+
+    SQASSERT(shared == false, "can't modify shared data");
+
+    const auto document = parse_asset_json(jsonPath);
+    add_source(jsonPath);
+
+    std::vector<Animation*> created;
 
     for (const auto [key, jFlags] : document.root().as<JsonObject>() | views::json_as<JsonArray>)
     {
         if (auto [iter, ok] = animations.try_emplace(key); ok)
         {
-            try
-            {
-                const auto animPath = fmt::format("assets/{}/anims/{}", directory, key);
-                iter->second.anim = armature.load_animation_from_file(animPath);
-            }
-            catch (const std::exception& ex)
-            {
-                sq::log_warning("animation '{}/{}': {}", directory, key, ex.what());
-                iter->second.anim = armature.make_null_animation(1u);
-                iter->second.fallback = true;
-            }
-
             for (const auto [_, flag] : jFlags | views::json_as<StringView>)
             {
                 if      (flag == "Manual") iter->second.manual = true;
@@ -66,10 +217,150 @@ void EntityDef::initialise_animations(const String& jsonPath)
                 else sq::log_warning("animation '{}/{}': invalid flag '{}'", directory, key, flag);
             }
 
-            // animation doesn't have any motion
-            if (iter->second.anim.tracks[0].size() == sizeof(Vec3F))
-                iter->second.motion = false;
+            created.push_back(&iter->second);
         }
         else sq::log_warning("animation '{}/{}': already loaded", directory, key);
     };
+
+    // loading and baking only read the armature, so every animation can be done on a worker
+    std::vector<String> errors(created.size());
+
+    WorkerPool::get().parallel_for(created.size(), [&](size_t index)
+    {
+        // the result is going to be thrown away, so skip the rest
+        if (cancel != nullptr && cancel->load(std::memory_order_relaxed) == true) return;
+
+        Animation& animation = *created[index];
+
+        try
+        {
+            const auto animPath = fmt::format("assets/{}/anims/{}", directory, animation.get_key());
+
+            // use a compressed version made by sts-compress-anims if there is one
+            if (asset_exists(animPath + ".stsa") == true)
+            {
+                auto compressed = CompressedAnimation::load_from_file(animPath + ".stsa");
+                if (compressed.get_sample_size() != armature.get_rest_sample().size())
+                    throw std::runtime_error("compressed animation doesn't match armature");
+
+                animation.anim.frameCount = compressed.get_frame_count();
+                animation.compressed = std::move(compressed);
+            }
+            else animation.anim = armature.load_animation_from_file(animPath);
+        }
+        catch (const std::exception& ex)
+        {
+            errors[index] = ex.what();
+            animation.anim = armature.make_null_animation(1u);
+            animation.compressed = {};
+            animation.fallback = true;
+        }
+
+        // animation doesn't have any motion
+        if (animation.compressed.empty() == false ? animation.compressed.is_constant_at(0u)
+                                                  : animation.anim.tracks[0].size() == sizeof(Vec3F))
+            animation.motion = false;
+
+        // compressed animations are already cheap to sample whole frames from, and much smaller
+        if (bakeAnimations == true && animation.compressed.empty() == true)
+            animation.bake(armature);
+    });
+
+    if (cancel != nullptr && cancel->load() == true) return;
+
+    for (size_t index = 0u; index < created.size(); ++index)
+    {
+        if (errors[index].empty() == false)
+            sq::log_warning("animation '{}/{}': {}", directory, created[index]->get_key(), errors[index]);
+
+        // any of these appearing, disappearing, or changing would change the result
+        const auto animPath = fmt::format("assets/{}/anims/{}", directory, created[index]->get_key());
+        add_source(animPath + ".stsa");
+        add_source(animPath + ".sqa");
+        add_source(animPath + ".json");
+    }
+}
+
+//============================================================================//
+
+void EntityDefData::load_hurt_blobs()
+{
+    SQASSERT(shared == false, "can't modify shared data");
+
+    const auto compile = [this](JsonObject json, StateBuffer& buffer)
+    {
+        hurtBlobs.clear();
+
+        for (const auto [key, jBlob] : json)
+            hurtBlobs[key].from_json(jBlob.as<JsonObject>(), armature);
+
+        DefCache::write_map(buffer, hurtBlobs);
+        return true;
+    };
+
+    const auto load = [this](StateReader& reader)
+    {
+        DefCache::read_map(reader, hurtBlobs);
+    };
+
+    const auto path = fmt::format("assets/{}/HurtBlobs.json", directory);
+    DefCache::load(path, armatureHash, compile, load);
+    add_source(path);
+}
+
+void EntityDefData::load_actions(const std::atomic<bool>* cancel)
+{
+    STS_TRACE_ZONE("EntityDefData::load_actions");
+
+    SQASSERT(shared == false, "can't modify shared data");
+
+    std::vector<std::pair<const SmallString*, ActionDefData*>> created;
+
+    const auto listPaths = std::array { String("assets/fighters/Actions.json"), fmt::format("assets/{}/Actions.json", directory) };
+
+    // standard actions, then fighter specific actions
+    for (const String& listPath : listPaths)
+    {
+        const auto document = parse_asset_json(listPath);
+        add_source(listPath);
+
+        for (const auto [_, jKey] : document.root().as<JsonArray>() | views::json_as<StringView>)
+        {
+            if (auto [iter, ok] = actions.try_emplace(jKey); ok)
+                created.emplace_back(&iter->first, &iter->second);
+            else sq::log_warning("'{}/actions/{}': already loaded", directory, jKey);
+        }
+    }
+
+    // compiling only reads the armature, so every action can be done on a worker
+    std::vector<String> errors(created.size());
+
+    WorkerPool::get().parallel_for(created.size(), [&](size_t index)
+    {
+        if (cancel != nullptr && cancel->load(std::memory_order_relaxed) == true) return;
+
+        const auto path = fmt::format("assets/{}/actions/{}.json", directory, *created[index].first);
+
+        try { created[index].second->load_json(path, armature, armatureHash); }
+        catch (const std::exception& ex) { errors[index] = ex.what(); }
+    });
+
+    if (cancel != nullptr && cancel->load() == true) return;
+
+    for (size_t index = 0u; index < created.size(); ++index)
+    {
+        if (errors[index].empty() == false)
+            sq::log_warning("'{}/actions/{}': {}", directory, *created[index].first, errors[index]);
+
+        add_source(fmt::format("assets/{}/actions/{}.json", directory, *created[index].first));
+    }
+}
+
+void EntityDefData::acquire_effect_assets(ResourceCaches& caches)
+{
+    SQASSERT(shared == false, "can't modify shared data");
+
+    for (auto& [_, action] : actions)
+        for (auto& [key, effect] : action.effects)
+            effect.handle = caches.effects.acquire(effect.path);
 }
@@ -2,13 +2,136 @@
 
 #include "setup.hpp"
 
+#include "game/KeyTable.hpp"
+
 #include <sqee/objects/Armature.hpp>
 #include <sqee/objects/DrawItem.hpp>
 
+#include <atomic>
+#include <filesystem>
+
 namespace sts {
 
 //============================================================================//
 
+/// Hit blobs, effects, and emitters from the json file of a fighter action.
+struct ActionDefData
+{
+    std::map<TinyString, HitBlobDef> blobs;
+    std::map<TinyString, VisualEffectDef> effects;
+    std::map<TinyString, Emitter> emitters;
+
+    /// False if the json failed to load, in which case the action's script isn't used.
+    bool loaded = false;
+
+    /// Compile or load the json file, safe to call from workers.
+    ///
+    /// Effects are loaded without handles, see EntityDefData::acquire_effect_assets.
+    void load_json(const String& path, const sq::Armature& armature, uint64_t armatureHash);
+};
+
+//============================================================================//
+
+/// Parts of an EntityDef that don't depend on the world or its vm.
+///
+/// These are the slowest parts to load, so they are kept by EntityDataCache
+/// and shared by every world that uses the same files.
+struct EntityDefData
+{
+    EntityDefData(String directory, bool bakeAnimations);
+
+    SQEE_COPY_DELETE(EntityDefData)
+    SQEE_MOVE_DELETE(EntityDefData)
+
+    ~EntityDefData();
+
+    /// Load meshes, textures, and pipelines from Render.json.
+    void load_draw_items(ResourceCaches& caches);
+
+    /// Load and bake animations listed in a json file, using the WorkerPool.
+    ///
+    /// Doesn't need the caches, so can be called from any thread. If cancel
+    /// gets set, returns early leaving animations incomplete.
+    void load_animations(const String& jsonPath, const std::atomic<bool>* cancel = nullptr);
+
+    /// Load hurt blobs from HurtBlobs.json, safe to call from any thread.
+    void load_hurt_blobs();
+
+    /// Load json files for every action listed in Actions.json, using the WorkerPool.
+    ///
+    /// Like load_animations, this can be called from any thread and can be cancelled.
+    void load_actions(const std::atomic<bool>* cancel = nullptr);
+
+    /// Acquire handles for effects loaded by load_actions, main thread only.
+    void acquire_effect_assets(ResourceCaches& caches);
+
+    //--------------------------------------------------------//
+
+    /// Directory containing the entity.
+    const String directory;
+
+    sq::Armature armature;
+
+    /// Hash of Armature.json, since compiled definitions store bone indices.
+    uint64_t armatureHash = 0u;
+
+    std::map<SmallString, Animation> animations;
+
+    std::vector<sq::DrawItem> drawItems;
+
+    /// Only for fighters, loaded from HurtBlobs.json.
+    std::map<TinyString, HurtBlobDef> hurtBlobs;
+
+    /// Only for fighters, an entry for every action, even if its json failed to load.
+    std::map<SmallString, ActionDefData> actions;
+
+    /// Value of Options::bake_animations when loaded.
+    const bool bakeAnimations;
+
+    /// Every file that was read, with its timestamp at the time.
+    std::vector<std::pair<String, std::filesystem::file_time_type>> sources;
+
+    /// Set once stored in a cache, after which nothing may be modified.
+    bool shared = false;
+
+    /// Remember the current timestamp of a file, so that changing it will cause a reload.
+    void add_source(String path);
+
+    /// Check if any source files have changed since loading.
+    bool is_outdated() const;
+};
+
+//============================================================================//
+
+/// Keeps EntityDefData loaded between worlds, by directory.
+///
+/// Data is reused as long as none of the files it was loaded from have been
+/// modified, so that rematches don't need to load everything again.
+class EntityDataCache final
+{
+public: //====================================================//
+
+    EntityDataCache() = default;
+
+    SQEE_COPY_DELETE(EntityDataCache)
+    SQEE_MOVE_DELETE(EntityDataCache)
+
+    /// Find data that is still current, or null if it needs to be loaded.
+    std::shared_ptr<EntityDefData> find(const String& directory, bool bakeAnimations) const;
+
+    /// Store data after loading it, replacing any outdated entry.
+    void insert(const String& directory, std::shared_ptr<EntityDefData> data);
+
+    /// Release everything that isn't in use by a world.
+    void clear() { mEntries.clear(); }
+
+private: //===================================================//
+
+    std::map<String, std::shared_ptr<EntityDefData>> mEntries;
+};
+
+//============================================================================//
+
 struct EntityDef
 {
     EntityDef(World& world, String directory);
@@ -18,6 +141,20 @@ struct EntityDef
     void initialise_sounds(const String& jsonPath);
     void initialise_animations(const String& jsonPath);
 
+    /// Discard animations before loading them again, only for editor worlds.
+    void clear_animations();
+
+    /// Intern the keys of sounds and animations, call once they have loaded.
+    void initialise_key_ids();
+
+    /// Store data for future worlds to reuse, call once everything has loaded.
+    void share_data();
+
+    /// Data that can still be modified, null once shared or if reused.
+    ///
+    /// Editor worlds never share their data, so they can always modify it.
+    EntityDefData* get_unshared_data() const { return mUnsharedData.get(); }
+
     //--------------------------------------------------------//
 
     World& world;
@@ -30,12 +167,43 @@ struct EntityDef
 
     //--------------------------------------------------------//
 
-    sq::Armature armature;
+    /// Possibly shared with other worlds, see EntityDataCache.
+    const std::shared_ptr<const EntityDefData> data;
+
+    /// True if data was reused, so everything in it is already loaded.
+    const bool reusedData;
+
+    const sq::Armature& armature;
+
+    const uint64_t& armatureHash;
 
     std::map<SmallString, SoundEffect> sounds;
-    std::map<SmallString, Animation> animations;
+    const std::map<SmallString, Animation>& animations;
 
-    std::vector<sq::DrawItem> drawItems;
+    const std::vector<sq::DrawItem>& drawItems;
+
+    /// Sounds and animations by key id, see find_sound and find_animation.
+    KeyIdArray<const SoundEffect> soundIds;
+    KeyIdArray<const Animation> animationIds;
+
+    /// Find a sound by key id, or null if there isn't one.
+    const SoundEffect* find_sound(uint16_t id) const;
+
+    /// Find an animation by key id, or null if there isn't one.
+    const Animation* find_animation(uint16_t id) const;
+
+    /// Bones that gameplay reads, plus their ancestors, sorted.
+    ///
+    /// Only these bones get sampled for ticks that won't be rendered, see
+    /// World::is_unrendered_tick. Empty means sample everything.
+    std::vector<uint8_t> simulationBones;
+
+private: //===================================================//
+
+    EntityDef(World& world, String directory, std::shared_ptr<EntityDefData> acquired);
+
+    /// Same as data while it can still be modified, null once it has been shared.
+    std::shared_ptr<EntityDefData> mUnsharedData;
 };
 
 //============================================================================//
@@ -13,7 +13,7 @@ using namespace sts;
 //============================================================================//
 
 Fighter::Fighter(const FighterDef& def, uint8_t index)
-    : Entity(def), def(def), index(index)
+    : Entity(def), def(def), index(index), mKeyIds(world.keys)
 {
     initialise_attributes();
     initialise_armature();
@@ -31,9 +31,9 @@ Fighter::Fighter(const FighterDef& def, uint8_t index)
     }
 
     // todo: proper action for entry upon game start
-    activeState = &mStates.at("Neutral");
+    activeState = &get_state(mKeyIds.stateNeutral);
     activeState->call_do_enter();
-    play_animation(def.animations.at("NeutralLoop"), 0u, true);
+    play_animation(get_animation(mKeyIds.animNeutralLoop), 0u, true);
 }
 
 Fighter::~Fighter()
@@ -43,6 +43,30 @@ Fighter::~Fighter()
 
 //============================================================================//
 
+Fighter::KeyIds::KeyIds(KeyTable& keys)
+    : stateNeutral(keys.intern("Neutral"))
+    , stateShield(keys.intern("Shield"))
+    , stateShieldStun(keys.intern("ShieldStun"))
+    , stateFallStun(keys.intern("FallStun"))
+    , stateNeutralStun(keys.intern("NeutralStun"))
+    , stateTumbleStun(keys.intern("TumbleStun"))
+    , actionGrabStart(keys.intern("GrabStart"))
+    , actionGrabbedStart(keys.intern("GrabbedStart"))
+    , actionRebound(keys.intern("Rebound"))
+    , animNeutralLoop(keys.intern("NeutralLoop"))
+    , animFallLoop(keys.intern("FallLoop"))
+    , animTumbleLoop(keys.intern("TumbleLoop"))
+    , animGrabbedHurtLow(keys.intern("GrabbedHurtLow"))
+    , animGrabbedLoopLow(keys.intern("GrabbedLoopLow"))
+    , animHurtAirHeavy(keys.intern("HurtAirHeavy"))
+    , animHurtAirLight(keys.intern("HurtAirLight"))
+    , animHurtHeavy { keys.intern("HurtMiddleHeavy"), keys.intern("HurtLowerHeavy"), keys.intern("HurtUpperHeavy") }
+    , animHurtLight { keys.intern("HurtMiddleLight"), keys.intern("HurtLowerLight"), keys.intern("HurtUpperLight") }
+    , animHurtTumble { keys.intern("HurtMiddleTumble"), keys.intern("HurtLowerTumble"), keys.intern("HurtUpperTumble") }
+{}
+
+//============================================================================//
+
 void Fighter::initialise_armature()
 {
     mFadeStartSample.resize(def.armature.get_rest_sample().size());
@@ -71,6 +95,8 @@ void Fighter::initialise_actions()
 {
     for (const auto& [key, def] : def.actions)
         mActions.try_emplace(mActions.end(), key, def, *this);
+
+    mActionIds.assign(world.keys, mActions);
 }
 
 //============================================================================//
@@ -79,6 +105,8 @@ void Fighter::initialise_states()
 {
     for (const auto& [key, def] : def.states)
         mStates.try_emplace(mStates.end(), key, def, *this);
+
+    mStateIds.assign(world.keys, mStates);
 }
 
 //============================================================================//
@@ -97,7 +125,7 @@ bool Fighter::accumulate_hit(const HitBlob& hit, const HurtBlob& hurt)
     if (!hit.def.sound.empty())
         hit.entity->wren_play_sound(hit.def.sound, false);
 
-    const bool shielding = activeState->def.name == "Shield" || activeState->def.name == "ShieldStun";
+    const bool shielding = activeState == mStateIds.find(mKeyIds.stateShield) || activeState == mStateIds.find(mKeyIds.stateShieldStun);
 
     //--------------------------------------------------------//
 
@@ -269,7 +297,7 @@ void Fighter::apply_hits()
 {
     Variables& vars = variables;
 
-    if (activeState->def.name == "Shield" || activeState->def.name == "ShieldStun")
+    if (activeState == mStateIds.find(mKeyIds.stateShield) || activeState == mStateIds.find(mKeyIds.stateShieldStun))
     {
         if (vars.shield <= 0.f)
         {
@@ -279,7 +307,7 @@ void Fighter::apply_hits()
         else
         {
             // todo: play shield hit sound
-            change_state(mStates.at("ShieldStun"));
+            change_state(get_state(mKeyIds.stateShieldStun));
         }
 
         return;
@@ -288,8 +316,8 @@ void Fighter::apply_hits()
     // no hits did enough damage to break the grab
     if (vars.bully != nullptr && mHurtRegion.has_value() == false)
     {
-        play_animation(def.animations.at("GrabbedHurtLow"), 0u, true);
-        set_next_animation(def.animations.at("GrabbedLoopLow"), 0u);
+        play_animation(get_animation(mKeyIds.animGrabbedHurtLow), 0u, true);
+        set_next_animation(get_animation(mKeyIds.animGrabbedLoopLow), 0u);
 
         update_animation();
         mModelMatrix = maths::transform(current.translation, current.rotation);
@@ -314,34 +342,31 @@ void Fighter::apply_hits()
 
     const bool heavy = vars.stunTime >= MIN_HITSTUN_HEAVY;
 
-    TinyString state;
-    SmallString animNow, animAfter;
+    uint16_t state, animNow, animAfter;
 
     const auto set_state_and_anims_fall = [&]()
     {
-        state = "FallStun";
-        animNow = heavy ? "HurtAirHeavy" : "HurtAirLight";
-        animAfter = "FallLoop";
+        state = mKeyIds.stateFallStun;
+        animNow = heavy ? mKeyIds.animHurtAirHeavy : mKeyIds.animHurtAirLight;
+        animAfter = mKeyIds.animFallLoop;
     };
 
     const auto set_state_and_anims_neutral = [&]()
     {
-        state = "NeutralStun";
-        if (*mHurtRegion == BlobRegion::Middle) animNow = heavy ? "HurtMiddleHeavy" : "HurtMiddleLight";
-        else if (*mHurtRegion == BlobRegion::Lower) animNow = heavy ? "HurtLowerHeavy" : "HurtLowerLight";
-        else if (*mHurtRegion == BlobRegion::Upper) animNow = heavy ? "HurtUpperHeavy" : "HurtUpperLight";
-        else SQEE_UNREACHABLE();
-        animAfter = "NeutralLoop";
+        const size_t region = size_t(*mHurtRegion);
+        SQASSERT(region < mKeyIds.animHurtHeavy.size(), "invalid hurt region");
+        state = mKeyIds.stateNeutralStun;
+        animNow = heavy ? mKeyIds.animHurtHeavy[region] : mKeyIds.animHurtLight[region];
+        animAfter = mKeyIds.animNeutralLoop;
     };
 
     const auto set_state_and_anims_tumble = [&]()
     {
-        state = "TumbleStun";
-        if (*mHurtRegion == BlobRegion::Middle) animNow = "HurtMiddleTumble";
-        else if (*mHurtRegion == BlobRegion::Lower) animNow = "HurtLowerTumble";
-        else if (*mHurtRegion == BlobRegion::Upper) animNow = "HurtUpperTumble";
-        else SQEE_UNREACHABLE();
-        animAfter = "TumbleLoop";
+        const size_t region = size_t(*mHurtRegion);
+        SQASSERT(region < mKeyIds.animHurtTumble.size(), "invalid hurt region");
+        state = mKeyIds.stateTumbleStun;
+        animNow = mKeyIds.animHurtTumble[region];
+        animAfter = mKeyIds.animTumbleLoop;
     };
 
     // todo: need a new state and animation
@@ -369,9 +394,9 @@ void Fighter::apply_hits()
     // on the ground and launched horizontally
     else set_state_and_anims_neutral();
 
-    change_state(mStates.at(state));
-    play_animation(def.animations.at(animNow), 0u, true);
-    set_next_animation(def.animations.at(animAfter), 0u);
+    change_state(get_state(state));
+    play_animation(get_animation(animNow), 0u, true);
+    set_next_animation(get_animation(animAfter), 0u);
 
     update_animation();
     mModelMatrix = maths::transform(current.translation, current.rotation);
@@ -392,8 +417,8 @@ void Fighter::apply_grab(Fighter& victim)
     variables.victim = &victim;
     victim.variables.bully = this;
 
-    start_action(mActions.at("GrabStart"));
-    victim.start_action(victim.mActions.at("GrabbedStart"));
+    start_action(get_action(mKeyIds.actionGrabStart));
+    victim.start_action(victim.get_action(victim.mKeyIds.actionGrabbedStart));
 
     update_animation();
     mModelMatrix = maths::transform(current.translation, current.rotation);
@@ -412,7 +437,7 @@ void Fighter::apply_rebound(float damage)
     cancel_action();
     // todo: allow slowing down animation for really high damage attacks
     vars.reboundTime = uint8_t(std::min(damage + 7.f, 31.f));
-    start_action(mActions.at("Rebound"));
+    start_action(get_action(mKeyIds.actionRebound));
 }
 
 //============================================================================//
@@ -421,8 +446,8 @@ void Fighter::pass_boundary()
 {
     // todo: this should be its own action
     reset_everything();
-    change_state(mStates.at("Neutral"));
-    play_animation(def.animations.at("NeutralLoop"), 0u, true);
+    change_state(get_state(mKeyIds.stateNeutral));
+    play_animation(get_animation(mKeyIds.animNeutralLoop), 0u, true);
 }
 
 //============================================================================//
@@ -441,7 +466,7 @@ void Fighter::set_position_after_throw()
     sq::Armature::Bone* currentSampleBones =
         reinterpret_cast<sq::Armature::Bone*>(mAnimPlayer.currentSample.data());
 
-    const Mat4F matrix = mModelMatrix * def.armature.compute_bone_matrix(mAnimPlayer.currentSample, 1u);
+    const Mat4F matrix = mModelMatrix * mAnimPlayer.get_bone_matrix(1u);
 
     variables.position.y = matrix[3].y - restSampleBones[1].offset.z;
     variables.position.y = std::max(variables.position.y, variables.bully->get_vars().position.y);
@@ -454,6 +479,7 @@ void Fighter::set_position_after_throw()
     const Mat4F transBoneMat = Mat4F(QuatF(0.f, 0.70710677f, 0.70710677f, 0.f));
 
     currentSampleBones[1].offset = Vec3F(maths::inverse(modelMat * transBoneMat) * matrix[3]);
+    mAnimPlayer.invalidate_bone_matrices();
 }
 
 //============================================================================//
@@ -478,6 +504,7 @@ void Fighter::set_spawn_transform(Vec2F position, int8_t facing)
 
     // might have problems later, but for now looks better than t-posing
     std::memset(mAnimPlayer.currentSample.data(), 0, mAnimPlayer.currentSample.size());
+    mAnimPlayer.invalidate_bone_matrices();
 }
 
 //============================================================================//
@@ -494,8 +521,7 @@ Diamond Fighter::compute_diamond() const
 
     for (uint8_t bone : attrs.diamondBones)
     {
-        // todo: this is doing a lot of duplicate work, bone matrices need a cache
-        const Mat4F matrix = mModelMatrix * def.armature.compute_bone_matrix(mAnimPlayer.currentSample, bone);
+        const Mat4F matrix = mModelMatrix * mAnimPlayer.get_bone_matrix(bone);
         realMin = maths::min(realMin, Vec2F(matrix[3]));
         realMax = maths::max(realMax, Vec2F(matrix[3]));
     }
@@ -550,6 +576,35 @@ void Fighter::change_state(FighterState& state)
 
 //============================================================================//
 
+FighterAction& Fighter::get_action(uint16_t id)
+{
+    FighterAction* action = mActionIds.find(id);
+    if (action == nullptr)
+        throw std::runtime_error(fmt::format("fighter has no action '{}'", world.keys.get_key(id)));
+
+    return *action;
+}
+
+FighterState& Fighter::get_state(uint16_t id)
+{
+    FighterState* state = mStateIds.find(id);
+    if (state == nullptr)
+        throw std::runtime_error(fmt::format("fighter has no state '{}'", world.keys.get_key(id)));
+
+    return *state;
+}
+
+const Animation& Fighter::get_animation(uint16_t id) const
+{
+    const Animation* animation = def.find_animation(id);
+    if (animation == nullptr)
+        throw std::runtime_error(fmt::format("fighter has no animation '{}'", world.keys.get_key(id)));
+
+    return *animation;
+}
+
+//============================================================================//
+
 void Fighter::clear_action()
 {
     for (int32_t id : mTransientEffects)
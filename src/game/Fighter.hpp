@@ -122,8 +122,30 @@ public: //====================================================//
 
     //--------------------------------------------------------//
 
+    /// Write the active action and state, and fiber progress.
+    void save_script_state(StateBuffer& buffer) const;
+
+    /// Restore the active action and state, rebuilding the fiber if needed.
+    void load_script_state(StateReader& reader);
+
+    /// Write wren fields of the active action and state scripts.
+    void save_script_fields(StateBuffer& buffer);
+
+    /// Restore wren fields, after every fiber has been rebuilt.
+    void load_script_fields(StateReader& reader);
+
+    /// Write everything else that affects the next tick.
+    void save_state(StateBuffer& buffer) const;
+
+    /// Read everything else that affects the next tick.
+    void load_state(StateReader& reader);
+
+    //--------------------------------------------------------//
+
     std::vector<HurtBlob>& get_hurt_blobs() { return mHurtBlobs; }
 
+    const std::vector<HurtBlob>& get_hurt_blobs() const { return mHurtBlobs; }
+
     const EntityDef& get_def() const override { return def; }
 
     EntityVars& get_vars() override { return variables; }
@@ -142,6 +164,10 @@ public: //====================================================//
 
     void wren_cxx_assign_state(TinyString key);
 
+    void wren_cxx_assign_action_id(uint16_t id);
+
+    void wren_cxx_assign_state_id(uint16_t id);
+
     Article* wren_cxx_spawn_article(TinyString key);
 
     bool wren_attempt_ledge_catch();
@@ -174,6 +200,13 @@ private: //===================================================//
 
     void change_state(FighterState& state);
 
+    /// Find an action or a state by key id, throwing if there isn't one.
+    FighterAction& get_action(uint16_t id);
+    FighterState& get_state(uint16_t id);
+
+    /// Find an animation by key id, throwing if there isn't one.
+    const Animation& get_animation(uint16_t id) const;
+
     void clear_action();
 
     void reset_everything();
@@ -198,6 +231,30 @@ private: //===================================================//
     std::map<SmallString, FighterAction> mActions;
     std::map<TinyString, FighterState> mStates;
 
+    // same as above, by key id
+    KeyIdArray<FighterAction> mActionIds;
+    KeyIdArray<FighterState> mStateIds;
+
+    /// Ids of the keys that hits, grabs, and rebounds use, interned once by the constructor.
+    struct KeyIds
+    {
+        KeyIds(KeyTable& keys);
+
+        uint16_t stateNeutral, stateShield, stateShieldStun;
+        uint16_t stateFallStun, stateNeutralStun, stateTumbleStun;
+
+        uint16_t actionGrabStart, actionGrabbedStart, actionRebound;
+
+        uint16_t animNeutralLoop, animFallLoop, animTumbleLoop;
+        uint16_t animGrabbedHurtLow, animGrabbedLoopLow;
+        uint16_t animHurtAirHeavy, animHurtAirLight;
+
+        // indexed by BlobRegion
+        std::array<uint16_t, 3u> animHurtHeavy, animHurtLight, animHurtTumble;
+    };
+
+    const KeyIds mKeyIds;
+
     WrenHandle* mLibraryHandle = nullptr;
 
     //--------------------------------------------------------//
@@ -1,79 +1,128 @@
 #include "game/FighterAction.hpp"
 
+#include "game/DefCache.hpp"
 #include "game/Emitter.hpp"
 #include "game/Fighter.hpp"
 #include "game/HitBlob.hpp"
+#include "game/NativeAction.hpp"
+#include "game/ScriptProfiler.hpp"
 #include "game/VisualEffect.hpp"
 #include "game/World.hpp"
 
-#include <sqee/misc/Files.hpp>
+#include "main/AssetArchive.hpp"
+#include "main/Tracing.hpp"
+
 #include <sqee/misc/Json.hpp>
 
 using namespace sts;
 
 //============================================================================//
 
-FighterActionDef::FighterActionDef(const FighterDef& fighter, SmallString name)
-    : fighter(fighter), name(name) {}
-
-FighterActionDef::~FighterActionDef()
+void ActionDefData::load_json(const String& path, const sq::Armature& armature, uint64_t armatureHash)
 {
-    if (scriptClass) wrenReleaseHandle(fighter.world.vm, scriptClass);
+    const auto compile = [&](JsonObject json, StateBuffer& buffer)
+    {
+        blobs.clear();
+        effects.clear();
+        emitters.clear();
+
+        fmt::memory_buffer errors;
+
+        const auto objects_from_json = [&json, &errors](StringView mapKey, auto& map, auto&... fromJsonArgs)
+        {
+            for (const auto [key, jObject] : json[mapKey].as<JsonObject>())
+            {
+                try {
+                    map[key].from_json(jObject.as<JsonObject>(), fromJsonArgs...);
+                }
+                catch (const std::exception& ex) {
+                    fmt::format_to(fmt::appender(errors), "\n{}", ex.what());
+                }
+            }
+        };
+
+        // caches aren't thread safe, so handles are acquired later
+        EffectCache* const effectCache = nullptr;
+
+        objects_from_json("blobs", blobs, armature);
+        objects_from_json("effects", effects, armature, effectCache);
+        objects_from_json("emitters", emitters, armature);
+
+        DefCache::write_map(buffer, blobs);
+        DefCache::write_map(buffer, effects);
+        DefCache::write_map(buffer, emitters);
+
+        if (errors.size() != 0u)
+            sq::log_warning_multiline("'{}': errors in json{}", path, StringView(errors.data(), errors.size()));
+
+        return errors.size() == 0u;
+    };
+
+    const auto load = [this](StateReader& reader)
+    {
+        DefCache::read_map(reader, blobs);
+        DefCache::read_map(reader, effects);
+        DefCache::read_map(reader, emitters);
+    };
+
+    DefCache::load(path, armatureHash, compile, load);
+    loaded = true;
 }
 
 //============================================================================//
 
-void FighterActionDef::load_json_from_file()
+namespace {
+
+const ActionDefData& find_action_data(const FighterDef& fighter, const SmallString& name)
 {
-    blobs.clear();
-    effects.clear();
-    emitters.clear();
+    const auto iter = fighter.data->actions.find(name);
+    SQASSERT(iter != fighter.data->actions.end(), "actions are created from the data");
+    return iter->second;
+}
 
-    const auto document = JsonDocument::parse_file(fmt::format("assets/{}/actions/{}.json", fighter.directory, name));
-    const auto json = document.root().as<JsonObject>();
+} // anonymous namespace
 
-    fmt::memory_buffer errors;
+FighterActionDef::FighterActionDef(const FighterDef& fighter, SmallString name)
+    : fighter(fighter), name(name), data(find_action_data(fighter, name))
+    , blobs(data.blobs), effects(data.effects), emitters(data.emitters) {}
 
-    const auto objects_from_json = [&json, &errors](StringView mapKey, auto& map, auto&... fromJsonArgs)
-    {
-        for (const auto [key, jObject] : json[mapKey].as<JsonObject>())
-        {
-            try {
-                map[key].from_json(jObject.as<JsonObject>(), fromJsonArgs...);
-            }
-            catch (const std::exception& ex) {
-                fmt::format_to(fmt::appender(errors), "\n{}", ex.what());
-            }
-        }
-    };
+FighterActionDef::~FighterActionDef()
+{
+    if (scriptClass) wrenReleaseHandle(fighter.world.vm, scriptClass);
+}
 
-    objects_from_json("blobs", blobs, fighter.armature);
-    objects_from_json("effects", effects, fighter.armature, fighter.world.caches.effects);
-    objects_from_json("emitters", emitters, fighter.armature);
+ActionDefData& FighterActionDef::get_unshared_data() const
+{
+    EntityDefData* const fighterData = fighter.get_unshared_data();
+    SQASSERT(fighterData != nullptr, "can't modify shared data");
 
-    if (errors.size() != 0u)
-        sq::log_warning_multiline("'{}/actions/{}': errors in json{}", fighter.directory, name, StringView(errors.data(), errors.size()));
+    return fighterData->actions.find(name)->second;
 }
 
 //============================================================================//
 
 void FighterActionDef::load_wren_from_file()
+{
+    read_wren_from_file();
+
+    // parse wrenSource and store the class handle
+    interpret_module();
+}
+
+void FighterActionDef::read_wren_from_file()
 {
     // set wrenSource to either the file contents or a fallback script
-    auto source = sq::try_read_text_from_file(fmt::format("assets/{}/actions/{}.wren", fighter.directory, name));
+    auto source = try_read_asset(fmt::format("assets/{}/actions/{}.wren", fighter.directory, name));
     if (source.has_value() == false)
     {
         sq::log_warning("'{}/actions/{}': missing script", fighter.directory, name);
 
         // use default version of this action if one exists
-        source = sq::try_read_text_from_file(fmt::format("wren/actions/{}.wren", name));
+        source = try_read_asset(fmt::format("wren/actions/{}.wren", name));
         if (source.has_value() == false)
-            source = sq::read_text_from_file("wren/fallback/FighterAction.wren");
+            source = read_asset("wren/fallback/FighterAction.wren");
     }
     wrenSource = std::move(*source);
-
-    // parse wrenSource and store the class handle
-    interpret_module();
 }
 
 //============================================================================//
@@ -116,9 +165,9 @@ void FighterActionDef::interpret_module()
         wrenUnloadModule(vm, module.c_str());
 
         // use default version of this action if one exists
-        auto source = sq::try_read_text_from_file(fmt::format("wren/actions/{}.wren", name));
+        auto source = try_read_asset(fmt::format("wren/actions/{}.wren", name));
         if (source.has_value() == false)
-            source = sq::read_text_from_file("wren/fallback/FighterAction.wren");
+            source = read_asset("wren/fallback/FighterAction.wren");
 
         // default and fallback scripts are assumed not to have errors
         vm.interpret(module.c_str(), source->c_str());
@@ -156,6 +205,10 @@ void FighterAction::initialise_script()
     if (mFiberHandle) wrenReleaseHandle(world.vm, mFiberHandle);
     mScriptHandle = mFiberHandle = nullptr;
 
+    // the script class may have changed
+    mScriptHasUpdate = true;
+    mScriptHasFields = true;
+
     // create a new instance of the Script object
     const auto safe = world.vm.safe_call<WrenHandle*>(world.handles.new_1, def.scriptClass, this);
     if (safe.ok == false)
@@ -177,6 +230,8 @@ void FighterAction::call_do_start()
 {
     SQASSERT(fighter.activeAction == this, "action not active");
 
+    const ScriptProfiler::Scope profile = { def, "do_start" };
+
     const auto error = fighter.world.vm.safe_call_void(fighter.world.handles.action_do_start, this);
     if (error.empty() == false)
         set_error_message("call_do_start", error);
@@ -184,8 +239,38 @@ void FighterAction::call_do_start()
 
 void FighterAction::call_do_updates()
 {
+    STS_TRACE_ZONE("FighterAction::call_do_updates");
+
     SQASSERT(fighter.activeAction == this, "action not active");
 
+    const ScriptProfiler::Scope profile = { def, "do_updates" };
+
+    // native actions only need wren to start the next action
+    if (def.native != nullptr)
+    {
+        if (impl_native_frame() == false) return;
+
+        const auto error = fighter.world.vm.safe_call_void(fighter.world.handles.action_do_native_finish, this);
+        if (error.empty() == false)
+            set_error_message("call_do_updates", error);
+
+        return;
+    }
+
+    // the fiber won't resume this frame, so skip straight to update, if the script has one
+    if (mCurrentFrame < mWaitUntil)
+    {
+        ++mCurrentFrame;
+
+        if (mScriptHasUpdate == false) return;
+
+        const auto error = fighter.world.vm.safe_call_void(fighter.world.handles.action_do_update, this);
+        if (error.empty() == false)
+            set_error_message("call_do_updates", error);
+
+        return;
+    }
+
     const auto error = fighter.world.vm.safe_call_void(fighter.world.handles.action_do_updates, this);
     if (error.empty() == false)
         set_error_message("call_do_updates", error);
@@ -202,6 +287,22 @@ void FighterAction::call_do_cancel()
 
 //============================================================================//
 
+bool FighterAction::impl_native_frame()
+{
+    try {
+        mNativeResult = def.native->update(*this, mCurrentFrame++);
+        return mNativeResult.has_value() == true;
+    }
+    catch (const std::exception& ex) {
+        // a script would keep failing every frame, better to just end the action
+        set_error_message("native update", fmt::format("{}\n", ex.what()));
+        mNativeResult = SmallString();
+        return true;
+    }
+}
+
+//============================================================================//
+
 void FighterAction::set_error_message(StringView method, StringView errors)
 {
     String message = fmt::format (
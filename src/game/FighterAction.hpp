@@ -18,22 +18,39 @@ struct FighterActionDef final
 
     const SmallString name;
 
-    std::map<TinyString, HitBlobDef> blobs;
-    std::map<TinyString, VisualEffectDef> effects;
-    std::map<TinyString, Emitter> emitters;
+    /// Possibly shared with other worlds, see EntityDataCache.
+    const ActionDefData& data;
+
+    const std::map<TinyString, HitBlobDef>& blobs;
+    const std::map<TinyString, VisualEffectDef>& effects;
+    const std::map<TinyString, Emitter>& emitters;
+
+    /// Blobs matching each prefix given to enable_hitblobs, by key id, filled when first used.
+    ///
+    /// Mutable because it's only a cache, derived from the shared blobs and the world's keys.
+    /// This def belongs to one world, so the cache is never shared between worlds or threads,
+    /// and it can't be filled up front because prefixes are only known once scripts use them.
+    mutable std::vector<std::vector<const HitBlobDef*>> blobGroups;
 
     WrenHandle* scriptClass = nullptr;
 
+    /// If set, used instead of the script, which is still loaded for the editor.
+    const NativeAction* native = nullptr;
+
     // todo: find a way to move this to the editor
     String wrenSource;
 
     //--------------------------------------------------------//
 
-    void load_json_from_file();
-
     void load_wren_from_file();
 
     void interpret_module();
+
+    /// Set wrenSource without interpreting it, safe to call from workers.
+    void read_wren_from_file();
+
+    /// Data that can be modified, only for editor worlds.
+    ActionDefData& get_unshared_data() const;
 };
 
 //============================================================================//
@@ -67,6 +84,19 @@ public: //====================================================//
 
     void call_do_cancel();
 
+    //--------------------------------------------------------//
+
+    ScriptProgress get_progress() const;
+
+    /// Resume a new fiber up to the given progress, unless already there.
+    void restore_progress(const ScriptProgress& progress);
+
+    /// Write the fields returned by the script's save_fields().
+    void save_script_fields(StateBuffer& buffer);
+
+    /// Pass fields written by save_script_fields to the script's load_fields(_).
+    void load_script_fields(StateReader& reader);
+
     //-- wren methods ----------------------------------------//
 
     const SmallString& wren_get_name() { return def.name; }
@@ -91,10 +121,28 @@ public: //====================================================//
 
     bool wren_cxx_next_frame();
 
+    void wren_cxx_no_update() { mScriptHasUpdate = false; }
+
+    void wren_cxx_no_fields() { mScriptHasFields = false; }
+
+    bool wren_cxx_fast_forward(uint frame);
+
     void wren_cxx_before_cancel();
 
+    bool wren_cxx_is_native() { return def.native != nullptr; }
+
+    TinyString wren_cxx_native_state();
+
+    bool wren_cxx_native_frame() { return impl_native_frame(); }
+
+    std::optional<SmallString> wren_cxx_native_result();
+
+    void wren_cxx_native_cancel();
+
     void wren_enable_hitblobs(StringView prefix);
 
+    void wren_enable_hitblobs_id(uint16_t id);
+
     void wren_disable_hitblobs(bool resetCollisions);
 
     int32_t wren_play_effect(TinyString key);
@@ -110,11 +158,25 @@ private: //===================================================//
     uint mCurrentFrame = 0u;
     uint mWaitUntil = 0u;
 
+    /// Cleared when the default FighterActionScript.update() gets called.
+    bool mScriptHasUpdate = true;
+
+    /// Cleared when the default FighterActionScript.save_fields() gets called.
+    bool mScriptHasFields = true;
+
+    uint32_t mRunId = 0u;
+
     WrenHandle* mScriptHandle = nullptr;
     WrenHandle* mFiberHandle = nullptr;
 
+    /// Result of the last native update, see NativeAction::update.
+    std::optional<SmallString> mNativeResult;
+
     //--------------------------------------------------------//
 
+    /// Run the native action for the current frame, returning true once finished.
+    bool impl_native_frame();
+
     void set_error_message(StringView method, StringView error);
 
     friend DebugGui;
@@ -1,10 +1,22 @@
 ﻿#include "game/FighterDef.hpp"
 
+#include "game/DefCache.hpp"
+#include "game/Emitter.hpp"
 #include "game/FighterAction.hpp"
 #include "game/FighterState.hpp"
+#include "game/HitBlob.hpp"
 #include "game/HurtBlob.hpp"
+#include "game/NativeAction.hpp"
+#include "game/VisualEffect.hpp"
 #include "game/World.hpp"
 
+#include "main/AssetArchive.hpp"
+#include "main/Options.hpp"
+#include "main/Tracing.hpp"
+#include "main/WorkerPool.hpp"
+
+#include "render/AnimPlayer.hpp"
+
 #include <sqee/misc/Json.hpp>
 
 using namespace sts;
@@ -12,18 +24,38 @@ using namespace sts;
 //============================================================================//
 
 FighterDef::FighterDef(World& world, TinyString name)
-    : EntityDef(world, fmt::format("fighters/{}", name))
+    : EntityDef(world, fmt::format("fighters/{}", name)), hurtBlobs(data->hurtBlobs)
 {
+    STS_TRACE_ZONE("FighterDef::FighterDef");
+
     initialise_sounds(fmt::format("assets/{}/Sounds.json", directory));
 
-    initialise_animations("assets/fighters/Animations.json");
-    initialise_animations(fmt::format("assets/{}/Animations.json", directory));
+    // already loaded if shared with a previous world
+    if (reusedData == false)
+    {
+        initialise_animations("assets/fighters/Animations.json");
+        initialise_animations(fmt::format("assets/{}/Animations.json", directory));
+    }
 
     initialise_attributes();
-    initialise_hurtblobs();
+
+    // blobs, effects, and emitters are also already loaded if shared
+    if (reusedData == false)
+    {
+        EntityDefData& edit = *get_unshared_data();
+
+        edit.load_hurt_blobs();
+        edit.load_actions();
+
+        if (world.caches != nullptr)
+            edit.acquire_effect_assets(*world.caches);
+    }
+
     initialise_actions();
+    initialise_native_actions();
     initialise_states();
     initialise_articles();
+    initialise_simulation_bones();
 
     // todo: change to wren expressions
     for (const sq::DrawItem& drawItem : drawItems)
@@ -33,6 +65,9 @@ FighterDef::FighterDef(World& world, TinyString name)
         if (drawItem.condition == "!flinch") continue;
         sq::log_warning("'assets/fighters/{}/Render.json': invalid condition '{}'", name, drawItem.condition);
     }
+
+    initialise_key_ids();
+    share_data();
 }
 
 FighterDef::~FighterDef()
@@ -44,78 +79,187 @@ FighterDef::~FighterDef()
 
 void FighterDef::initialise_attributes()
 {
-    const auto document = JsonDocument::parse_file(fmt::format("assets/{}/Attributes.json", directory));
-    const auto json = document.root().as<JsonObject>();
+    const auto compile = [this](JsonObject json, StateBuffer& buffer)
+    {
+        attributes.from_json(json, armature);
+        attributes.to_binary(buffer);
+        return true;
+    };
+
+    const auto load = [this](StateReader& reader)
+    {
+        attributes.from_binary(reader);
+    };
+
+    DefCache::load(fmt::format("assets/{}/Attributes.json", directory), armatureHash, compile, load);
+}
 
-    attributes.walkSpeed   = json["walkSpeed"].as_auto();
-    attributes.dashSpeed   = json["dashSpeed"].as_auto();
-    attributes.airSpeed    = json["airSpeed"].as_auto();
-    attributes.traction    = json["traction"].as_auto();
-    attributes.airMobility = json["airMobility"].as_auto();
-    attributes.airFriction = json["airFriction"].as_auto();
+void FighterDef::Attributes::from_json(JsonObject json, const sq::Armature& armature)
+{
+    walkSpeed   = json["walkSpeed"].as_auto();
+    dashSpeed   = json["dashSpeed"].as_auto();
+    airSpeed    = json["airSpeed"].as_auto();
+    traction    = json["traction"].as_auto();
+    airMobility = json["airMobility"].as_auto();
+    airFriction = json["airFriction"].as_auto();
 
-    attributes.hopHeight     = json["hopHeight"].as_auto();
-    attributes.jumpHeight    = json["jumpHeight"].as_auto();
-    attributes.airHopHeight  = json["airHopHeight"].as_auto();
-    attributes.gravity       = json["gravity"].as_auto();
-    attributes.fallSpeed     = json["fallSpeed"].as_auto();
-    attributes.fastFallSpeed = json["fastFallSpeed"].as_auto();
-    attributes.weight        = json["weight"].as_auto();
+    hopHeight     = json["hopHeight"].as_auto();
+    jumpHeight    = json["jumpHeight"].as_auto();
+    airHopHeight  = json["airHopHeight"].as_auto();
+    gravity       = json["gravity"].as_auto();
+    fallSpeed     = json["fallSpeed"].as_auto();
+    fastFallSpeed = json["fastFallSpeed"].as_auto();
+    weight        = json["weight"].as_auto();
 
-    attributes.walkAnimSpeed = json["walkAnimSpeed"].as_auto();
-    attributes.dashAnimSpeed = json["dashAnimSpeed"].as_auto();
+    walkAnimSpeed = json["walkAnimSpeed"].as_auto();
+    dashAnimSpeed = json["dashAnimSpeed"].as_auto();
 
-    attributes.extraJumps    = json["extraJumps"].as_auto();
-    attributes.lightLandTime = json["lightLandTime"].as_auto();
+    extraJumps    = json["extraJumps"].as_auto();
+    lightLandTime = json["lightLandTime"].as_auto();
 
+    diamondBones.clear();
     for (const auto [_, jBone] : json["diamondBones"].as<JsonArray>())
-        attributes.diamondBones.emplace_back(armature.json_as_bone_index(jBone));
+        diamondBones.emplace_back(armature.json_as_bone_index(jBone));
 
-    attributes.diamondMinWidth  = json["diamondMinWidth"].as_auto();
-    attributes.diamondMinHeight = json["diamondMinHeight"].as_auto();
+    diamondMinWidth  = json["diamondMinWidth"].as_auto();
+    diamondMinHeight = json["diamondMinHeight"].as_auto();
+}
+
+void FighterDef::Attributes::to_binary(StateBuffer& buffer) const
+{
+    buffer.write(walkSpeed);
+    buffer.write(dashSpeed);
+    buffer.write(airSpeed);
+    buffer.write(traction);
+    buffer.write(airMobility);
+    buffer.write(airFriction);
+
+    buffer.write(hopHeight);
+    buffer.write(jumpHeight);
+    buffer.write(airHopHeight);
+    buffer.write(gravity);
+    buffer.write(fallSpeed);
+    buffer.write(fastFallSpeed);
+    buffer.write(weight);
+
+    buffer.write(walkAnimSpeed);
+    buffer.write(dashAnimSpeed);
+
+    buffer.write(extraJumps);
+    buffer.write(lightLandTime);
+
+    buffer.write(uint8_t(diamondBones.size()));
+    for (const uint8_t bone : diamondBones)
+        buffer.write(bone);
+
+    buffer.write(diamondMinWidth);
+    buffer.write(diamondMinHeight);
+}
+
+void FighterDef::Attributes::from_binary(StateReader& reader)
+{
+    reader.read(walkSpeed);
+    reader.read(dashSpeed);
+    reader.read(airSpeed);
+    reader.read(traction);
+    reader.read(airMobility);
+    reader.read(airFriction);
+
+    reader.read(hopHeight);
+    reader.read(jumpHeight);
+    reader.read(airHopHeight);
+    reader.read(gravity);
+    reader.read(fallSpeed);
+    reader.read(fastFallSpeed);
+    reader.read(weight);
+
+    reader.read(walkAnimSpeed);
+    reader.read(dashAnimSpeed);
+
+    reader.read(extraJumps);
+    reader.read(lightLandTime);
+
+    diamondBones.clear();
+    for (uint8_t count = reader.read<uint8_t>(); count != 0u; --count)
+        diamondBones.push_back(reader.read<uint8_t>());
+
+    reader.read(diamondMinWidth);
+    reader.read(diamondMinHeight);
 }
 
 //============================================================================//
 
 void FighterDef::initialise_hurtblobs()
 {
-    const auto document = JsonDocument::parse_file(fmt::format("assets/{}/HurtBlobs.json", directory));
-    const auto json = document.root().as<JsonObject>();
+    EntityDefData* const edit = get_unshared_data();
+    SQASSERT(edit != nullptr, "can't modify shared data");
 
-    for (const auto [key, jBlob] : json)
-        hurtBlobs[key].from_json(jBlob.as<JsonObject>(), armature);
+    edit->load_hurt_blobs();
 }
 
 //============================================================================//
 
 void FighterDef::initialise_actions()
 {
-    const auto load_action = [this](StringView key)
+    STS_TRACE_ZONE("FighterDef::initialise_actions");
+
+    std::vector<FighterActionDef*> created;
+
+    // only actions with valid json get scripts, same as when they were loaded here
+    for (const auto& [key, action] : data->actions)
     {
-        if (auto [iter, ok] = actions.try_emplace(key, *this, key); ok)
-        {
-            try {
-                iter->second.load_json_from_file();
-                iter->second.load_wren_from_file();
-            }
-            catch (const std::exception& ex) {
-                sq::log_warning("'{}/actions/{}': {}", directory, key, ex.what());
-            }
+        FighterActionDef& def = actions.try_emplace(key, *this, key).first->second;
+        if (action.loaded == true) created.push_back(&def);
+    }
+
+    // read files on workers, then interpret scripts here
+    std::vector<String> errors(created.size());
+
+    WorkerPool::get().parallel_for(created.size(), [&](size_t index)
+    {
+        try {
+            created[index]->read_wren_from_file();
         }
-        else sq::log_warning("'{}/actions/{}': already loaded", directory, key);
-    };
+        catch (const std::exception& ex) {
+            errors[index] = ex.what();
+        }
+    });
 
-    // standard actions
+    for (size_t index = 0u; index < created.size(); ++index)
     {
-        const auto document = JsonDocument::parse_file("assets/fighters/Actions.json");
-        for (const auto [_, key] : document.root().as<JsonArray>())
-            load_action(key.as<StringView>());
+        if (errors[index].empty() == false)
+        {
+            sq::log_warning("'{}/actions/{}': {}", directory, created[index]->name, errors[index]);
+            continue;
+        }
+
+        created[index]->interpret_module();
     }
-    // fighter specific actions
+}
+
+void FighterDef::initialise_native_actions()
+{
+    // the editor is for editing scripts, so it should always run them
+    if (world.options.native_actions == false || world.editor != nullptr)
+        return;
+
+    const auto path = fmt::format("assets/{}/NativeActions.json", directory);
+    if (asset_exists(path) == false) return;
+
+    const auto document = parse_asset_json(path);
+
+    for (const auto [key, jName] : document.root().as<JsonObject>())
     {
-        const auto document = JsonDocument::parse_file(fmt::format("assets/{}/Actions.json", directory));
-        for (const auto [_, key] : document.root().as<JsonArray>())
-            load_action(key.as<StringView>());
+        const auto iter = actions.find(SmallString(key));
+        if (iter == actions.end())
+        {
+            sq::log_warning("'{}': invalid action '{}'", path, key);
+            continue;
+        }
+
+        const auto name = jName.as<StringView>();
+        if ((iter->second.native = NativeActionRegistry::get().find(name)) == nullptr)
+            sq::log_warning("'{}': invalid native action '{}'", path, name);
     }
 }
 
@@ -123,32 +267,45 @@ void FighterDef::initialise_actions()
 
 void FighterDef::initialise_states()
 {
-    const auto load_state = [this](StringView key)
+    STS_TRACE_ZONE("FighterDef::initialise_states");
+
+    std::vector<FighterStateDef*> created;
+
+    const auto load_state = [&](StringView key)
     {
         if (auto [iter, ok] = states.try_emplace(key, *this, key); ok)
-        {
-            try {
-                iter->second.load_wren_from_file();
-            }
-            catch (const std::exception& ex) {
-                sq::log_warning("'{}/states/{}': {}", directory, key, ex.what());
-            }
-        }
+            created.push_back(&iter->second);
         else sq::log_warning("'{}/states/{}': already loaded", directory, key);
     };
 
     // standard states
     {
-        const auto document = JsonDocument::parse_file("assets/fighters/States.json");
+        const auto document = parse_asset_json("assets/fighters/States.json");
         for (const auto [_, key] : document.root().as<JsonArray>())
             load_state(key.as<StringView>());
     }
     // fighter specific states
     {
-        const auto document = JsonDocument::parse_file(fmt::format("assets/{}/States.json", directory));
+        const auto document = parse_asset_json(fmt::format("assets/{}/States.json", directory));
         for (const auto [_, key] : document.root().as<JsonArray>())
             load_state(key.as<StringView>());
     }
+
+    // only reading scripts can be done on workers, the vm isn't thread safe
+    WorkerPool::get().parallel_for(created.size(), [&](size_t index)
+    {
+        created[index]->read_wren_from_file();
+    });
+
+    for (FighterStateDef* state : created)
+    {
+        try {
+            state->interpret_module();
+        }
+        catch (const std::exception& ex) {
+            sq::log_warning("'{}/states/{}': {}", directory, state->name, ex.what());
+        }
+    }
 }
 
 //============================================================================//
@@ -161,9 +318,69 @@ void FighterDef::initialise_articles()
             sq::log_warning("'{}/articles/{}': already loaded", directory, key);
     };
 
-    const auto document = JsonDocument::parse_file(fmt::format("assets/{}/Articles.json", directory));
+    const auto document = parse_asset_json(fmt::format("assets/{}/Articles.json", directory));
     const auto json = document.root().as<JsonObject>();
 
     for (const auto [key, path] : json)
         load_article(key, path.as<StringView>());
 }
+
+//============================================================================//
+
+void FighterDef::initialise_simulation_bones()
+{
+    // worlds that render need every bone anyway
+    if (world.renderer != nullptr) return;
+
+    std::vector<char> used(armature.get_bone_count(), char(false));
+
+    const auto add_bone = [&](int8_t bone)
+    {
+        for (; bone != -1 && used[bone] == false; bone = armature.get_bone_infos()[bone].parent)
+            used[bone] = char(true);
+    };
+
+    // root motion, rotation, and victim attachment bones from Entity::update_animation
+    for (const int8_t bone : { 0, 1, 2, 4 })
+        if (bone < int8_t(armature.get_bone_count()))
+            add_bone(bone);
+
+    for (const uint8_t bone : attributes.diamondBones)
+        add_bone(int8_t(bone));
+
+    for (const auto& [key, blob] : hurtBlobs)
+        add_bone(blob.bone);
+
+    // effects and emitters only affect visuals, but particles are generated in headless worlds too
+    for (const auto& [key, action] : actions)
+    {
+        for (const auto& [blobKey, blob] : action.blobs) add_bone(blob.bone);
+        for (const auto& [effectKey, effect] : action.effects) add_bone(effect.bone);
+        for (const auto& [emitterKey, emitter] : action.emitters) add_bone(emitter.bone);
+    }
+
+    for (uint8_t bone = 0u; bone < uint8_t(used.size()); ++bone)
+        if (used[bone] == true)
+            simulationBones.push_back(bone);
+
+    // nothing to gain if every bone is needed anyway
+    if (simulationBones.size() == used.size())
+    {
+        simulationBones.clear();
+        return;
+    }
+
+    // partial samples have to be exactly the same as full samples, or headless worlds would desync
+    for (const auto& [key, animation] : animations)
+    {
+        // compressed animations are always decompressed whole
+        if (animation.compressed.empty() == false) continue;
+
+        if (validate_partial_sample(armature, animation.anim, simulationBones) == false)
+        {
+            sq::log_warning("'{}/animations/{}': can't be sampled partially, sampling all bones", directory, key);
+            simulationBones.clear();
+            return;
+        }
+    }
+}
@@ -38,6 +38,12 @@ struct FighterDef final : EntityDef
 
         float diamondMinWidth  = 0.4f;
         float diamondMinHeight = 0.4f;
+
+        void from_json(JsonObject json, const sq::Armature& armature);
+
+        void to_binary(StateBuffer& buffer) const;
+
+        void from_binary(StateReader& reader);
     };
 
     //--------------------------------------------------------//
@@ -49,14 +55,17 @@ struct FighterDef final : EntityDef
     void initialise_attributes();
     void initialise_hurtblobs();
     void initialise_actions();
+    void initialise_native_actions();
     void initialise_states();
     void initialise_articles();
+    void initialise_simulation_bones();
 
     //--------------------------------------------------------//
 
     Attributes attributes;
 
-    std::map<TinyString, HurtBlobDef> hurtBlobs;
+    const std::map<TinyString, HurtBlobDef>& hurtBlobs;
+
     std::map<SmallString, FighterActionDef> actions;
     std::map<TinyString, FighterStateDef> states;
 
@@ -1,9 +1,11 @@
 #include "game/FighterState.hpp"
 
 #include "game/Fighter.hpp"
+#include "game/ScriptProfiler.hpp"
 #include "game/World.hpp"
 
-#include <sqee/misc/Files.hpp>
+#include "main/AssetArchive.hpp"
+#include "main/Tracing.hpp"
 
 using namespace sts;
 
@@ -25,18 +27,27 @@ FighterStateDef::~FighterStateDef()
 //============================================================================//
 
 void FighterStateDef::load_wren_from_file()
+{
+    read_wren_from_file();
+    interpret_module();
+}
+
+void FighterStateDef::read_wren_from_file()
+{
+    // first try to load a fighter specific script
+    wrenSource = try_read_asset(fmt::format("assets/{}/states/{}.wren", fighter.directory, name));
+}
+
+void FighterStateDef::interpret_module()
 {
     SQASSERT(scriptClass == nullptr, "module already loaded");
 
     auto& vm = fighter.world.vm;
 
-    // first try to load a fighter specific script
-    auto source = sq::try_read_text_from_file(fmt::format("assets/{}/states/{}.wren", fighter.directory, name));
-
     String module;
 
     // for states, per fighter scripts are not required
-    if (source.has_value() == false)
+    if (wrenSource.has_value() == false)
     {
         module = fmt::format("states/{}", name);
         vm.load_module(module.c_str());
@@ -44,7 +55,8 @@ void FighterStateDef::load_wren_from_file()
     else
     {
         module = fmt::format("{}/states/{}", fighter.directory, name);
-        vm.interpret(module.c_str(), source->c_str());
+        vm.interpret(module.c_str(), wrenSource->c_str());
+        wrenSource.reset();
     }
 
     // store the class for use by FighterState
@@ -80,8 +92,12 @@ void FighterState::call_do_enter()
 
 void FighterState::call_do_updates()
 {
+    STS_TRACE_ZONE("FighterState::call_do_updates");
+
     SQASSERT(fighter.activeState == this, "state not active");
 
+    const ScriptProfiler::Scope profile = { def, "do_updates" };
+
     const auto error = world.vm.safe_call_void(world.handles.state_do_updates, this);
     if (error.empty() == false)
         set_error_message("call_do_updates", error);
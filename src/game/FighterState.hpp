@@ -20,9 +20,17 @@ struct FighterStateDef final
 
     WrenHandle* scriptClass = nullptr;
 
+    /// Fighter specific script, if there is one, only kept until interpreted.
+    std::optional<String> wrenSource;
+
     //--------------------------------------------------------//
 
     void load_wren_from_file();
+
+    void interpret_module();
+
+    /// Set wrenSource without interpreting it, safe to call from workers.
+    void read_wren_from_file();
 };
 
 //============================================================================//
@@ -54,6 +62,14 @@ public: //====================================================//
 
     void call_do_exit();
 
+    //--------------------------------------------------------//
+
+    /// Write the fields returned by the script's save_fields().
+    void save_script_fields(StateBuffer& buffer);
+
+    /// Pass fields written by save_script_fields to the script's load_fields(_).
+    void load_script_fields(StateReader& reader);
+
     //-- wren methods ----------------------------------------//
 
     const TinyString& wren_get_name() { return def.name; }
@@ -70,10 +86,15 @@ public: //====================================================//
 
     void wren_cxx_before_exit();
 
+    void wren_cxx_no_fields() { mScriptHasFields = false; }
+
 private: //===================================================//
 
     WrenHandle* mScriptHandle = nullptr;
 
+    /// Cleared when the default FighterStateScript.save_fields() gets called.
+    bool mScriptHasFields = true;
+
     void set_error_message(StringView method, StringView error);
 
     friend DebugGui;
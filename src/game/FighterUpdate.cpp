@@ -8,6 +8,8 @@
 
 #include "render/Renderer.hpp"
 
+#include "main/Tracing.hpp"
+
 #include <sqee/maths/Functions.hpp>
 
 // todo: merge this file back into Fighter.cpp
@@ -235,6 +237,8 @@ void Fighter::update_jitter()
 
 void Fighter::tick()
 {
+    STS_TRACE_ZONE("Fighter::tick");
+
     Variables& vars = variables;
 
     // set relative x for the newly added input frame
@@ -296,5 +300,5 @@ void Fighter::integrate(float blend)
 
     for (const sq::DrawItem& item : def.drawItems)
         if (check_condition(item.condition) == true)
-            world.renderer.add_draw_call(item, mAnimPlayer);
+            world.renderer->add_draw_call(item, mAnimPlayer);
 }
@@ -1,5 +1,7 @@
 #include "game/HitBlob.hpp"
 
+#include "game/DefCache.hpp"
+
 #include <sqee/misc/Json.hpp>
 
 using namespace sts;
@@ -78,6 +80,74 @@ void HitBlobDef::to_json(JsonMutObject json, const sq::Armature& armature) const
 
 //============================================================================//
 
+void HitBlobDef::to_binary(StateBuffer& buffer) const
+{
+    buffer.write(origin);
+    buffer.write(radius);
+
+    buffer.write(bone);
+
+    buffer.write(index);
+    buffer.write(type);
+
+    buffer.write(damage);
+    buffer.write(freezeMult);
+    buffer.write(freezeDiMult);
+
+    buffer.write(knockAngle);
+    buffer.write(knockBase);
+    buffer.write(knockScale);
+
+    buffer.write(angleMode);
+    buffer.write(facingMode);
+    buffer.write(clangMode);
+    buffer.write(flavour);
+
+    buffer.write(ignoreDamage);
+    buffer.write(ignoreWeight);
+
+    buffer.write(canHitGround);
+    buffer.write(canHitAir);
+
+    DefCache::write_string(buffer, handler);
+    DefCache::write_string(buffer, sound);
+}
+
+void HitBlobDef::from_binary(StateReader& reader)
+{
+    reader.read(origin);
+    reader.read(radius);
+
+    reader.read(bone);
+
+    reader.read(index);
+    reader.read(type);
+
+    reader.read(damage);
+    reader.read(freezeMult);
+    reader.read(freezeDiMult);
+
+    reader.read(knockAngle);
+    reader.read(knockBase);
+    reader.read(knockScale);
+
+    reader.read(angleMode);
+    reader.read(facingMode);
+    reader.read(clangMode);
+    reader.read(flavour);
+
+    reader.read(ignoreDamage);
+    reader.read(ignoreWeight);
+
+    reader.read(canHitGround);
+    reader.read(canHitAir);
+
+    DefCache::read_string(reader, handler);
+    DefCache::read_string(reader, sound);
+}
+
+//============================================================================//
+
 DISABLE_WARNING_FLOAT_EQUALITY()
 
 bool HitBlobDef::operator==(const HitBlobDef& other) const
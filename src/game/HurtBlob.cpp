@@ -1,5 +1,7 @@
 #include "game/HurtBlob.hpp"
 
+#include "game/DefCache.hpp"
+
 #include <sqee/misc/Json.hpp>
 
 using namespace sts;
@@ -32,6 +34,30 @@ void HurtBlobDef::to_json(JsonMutObject json, const sq::Armature& armature) cons
 
 //============================================================================//
 
+void HurtBlobDef::to_binary(StateBuffer& buffer) const
+{
+    buffer.write(originA);
+    buffer.write(originB);
+    buffer.write(radius);
+
+    buffer.write(bone);
+
+    buffer.write(region);
+}
+
+void HurtBlobDef::from_binary(StateReader& reader)
+{
+    reader.read(originA);
+    reader.read(originB);
+    reader.read(radius);
+
+    reader.read(bone);
+
+    reader.read(region);
+}
+
+//============================================================================//
+
 DISABLE_WARNING_FLOAT_EQUALITY()
 
 bool HurtBlobDef::operator==(const HurtBlobDef& other) const
@@ -35,6 +35,11 @@ struct HurtBlobDef final
 
     void to_json(JsonMutObject json, const sq::Armature& armature) const;
 
+    /// Write to a DefCache buffer, bones are stored as indices.
+    void to_binary(StateBuffer& buffer) const;
+
+    void from_binary(StateReader& reader);
+
     bool operator==(const HurtBlobDef& other) const;
 };
 
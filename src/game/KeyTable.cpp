@@ -0,0 +1,21 @@
+#include "game/KeyTable.hpp"
+
+using namespace sts;
+
+//============================================================================//
+
+uint16_t KeyTable::intern(StringView key)
+{
+    const auto iter = mIds.find(key);
+    if (iter != mIds.end()) return iter->second;
+
+    if (mKeys.size() > std::numeric_limits<uint16_t>::max())
+        throw std::runtime_error(fmt::format("too many keys, can't intern '{}'", key));
+
+    const uint16_t id = uint16_t(mKeys.size());
+
+    mKeys.emplace_back(key);
+    mIds.emplace(mKeys.back(), id);
+
+    return id;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "setup.hpp"
+
+namespace sts {
+
+//============================================================================//
+
+/// Dense integer ids for the string keys of actions, states, animations, etc.
+///
+/// Keys are interned while loading, and by scripts that resolve a key once and
+/// cache the id. Ids are never removed or reused, so a cached id stays valid
+/// even if the editor reloads whatever it refers to.
+class KeyTable final
+{
+public: //====================================================//
+
+    KeyTable() = default;
+
+    SQEE_COPY_DELETE(KeyTable)
+    SQEE_MOVE_DELETE(KeyTable)
+
+    /// Get the id of a key, adding it if needed.
+    uint16_t intern(StringView key);
+
+    /// Get the key that an id was interned from, or "?" if it was never interned.
+    StringView get_key(uint16_t id) const { return id < mKeys.size() ? StringView(mKeys[id]) : "?"; }
+
+    /// Number of keys interned so far, every id is less than this.
+    size_t size() const { return mKeys.size(); }
+
+private: //===================================================//
+
+    std::vector<String> mKeys;
+
+    std::map<String, uint16_t, std::less<>> mIds;
+};
+
+//============================================================================//
+
+/// Flat lookup from key ids to values that are stored somewhere else, usually a map.
+///
+/// Only as big as the highest id that has a value, keys missing a value give null.
+template <class Value>
+class KeyIdArray final
+{
+public: //====================================================//
+
+    /// Intern the keys of a map and point to its values.
+    template <class Map>
+    void assign(KeyTable& keys, Map& map)
+    {
+        mValues.clear();
+
+        for (auto& [key, value] : map)
+        {
+            const uint16_t id = keys.intern(key);
+            if (id >= mValues.size()) mValues.resize(id + 1u, nullptr);
+            mValues[id] = &value;
+        }
+    }
+
+    /// Find the value for an id, or null if there isn't one.
+    Value* find(uint16_t id) const
+    {
+        return id < mValues.size() ? mValues[id] : nullptr;
+    }
+
+private: //===================================================//
+
+    std::vector<Value*> mValues;
+};
+
+//============================================================================//
+
+} // namespace sts
@@ -0,0 +1,102 @@
+#include "game/NativeAction.hpp"
+
+#include "game/Fighter.hpp"
+#include "game/FighterAction.hpp"
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+/// Change state and play an animation, then optionally play a sound later.
+///
+/// Covers the many actions whose scripts are just default_begin() and a sound.
+class BasicAction final : public NativeAction
+{
+public: //====================================================//
+
+    struct Params
+    {
+        TinyString state;
+        SmallString animation;
+        uint fade = 0u;
+        SmallString nextAnimation = {};
+        uint nextFade = 0u;
+        SmallString sound = {};
+        uint soundFrame = 0u;
+    };
+
+    BasicAction(Params params) : mParams(std::move(params)) {}
+
+    TinyString get_state() const override
+    {
+        return mParams.state;
+    }
+
+    std::optional<SmallString> update(FighterAction& action, uint frame) const override
+    {
+        if (frame == 0u)
+        {
+            action.fighter.wren_play_animation(mParams.animation, mParams.fade, true);
+
+            if (mParams.nextAnimation.empty() == false)
+                action.fighter.wren_set_next_animation(mParams.nextAnimation, mParams.nextFade);
+        }
+
+        if (mParams.sound.empty() == false && frame == mParams.soundFrame)
+            action.fighter.wren_play_sound(mParams.sound, false);
+
+        if (frame < mParams.soundFrame)
+            return std::nullopt;
+
+        return SmallString();
+    }
+
+private: //===================================================//
+
+    const Params mParams;
+};
+
+} // anonymous namespace
+
+//============================================================================//
+
+NativeActionRegistry::NativeActionRegistry()
+{
+    const auto add_basic = [this](String name, BasicAction::Params params)
+    {
+        add(std::move(name), std::make_unique<BasicAction>(std::move(params)));
+    };
+
+    add_basic("Mario/CrouchOff", { "Neutral", "CrouchOff", 2u, "NeutralLoop", 0u, "CrouchOff", 2u });
+    add_basic("Mario/CrouchOn", { "Crouch", "CrouchOn", 2u, "CrouchLoop", 0u, "CrouchOn", 2u });
+    add_basic("Mario/GrabStart", { "Grab", "GrabLoop", 1u, "", 0u, "LedgeCatch", 2u });
+    add_basic("Mario/HopBack", { "Fall", "JumpBack", 0u, "FallLoop", 0u, "Hop", 2u });
+    add_basic("Mario/HopForward", { "Fall", "JumpForward", 0u, "FallLoop", 0u, "Hop", 2u });
+    add_basic("Mario/JumpBack", { "Fall", "JumpBack", 0u, "FallLoop", 0u, "Jump", 2u });
+    add_basic("Mario/JumpForward", { "Fall", "JumpForward", 0u, "FallLoop", 0u, "Jump", 2u });
+    add_basic("Mario/ShieldOn", { "Shield", "ShieldOn", 2u, "ShieldLoop", 0u, "ShieldOn", 1u });
+    add_basic("Mario/Vertigo", { "Vertigo", "VertigoStart", 2u, "VertigoLoop", 0u, "VoiceVertigo", 0u });
+}
+
+const NativeActionRegistry& NativeActionRegistry::get()
+{
+    static NativeActionRegistry registry;
+    return registry;
+}
+
+//============================================================================//
+
+void NativeActionRegistry::add(String name, std::unique_ptr<NativeAction> action)
+{
+    if (mActions.try_emplace(name, std::move(action)).second == false)
+        sq::log_warning("native action '{}' already added", name);
+}
+
+const NativeAction* NativeActionRegistry::find(StringView name) const
+{
+    const auto iter = mActions.find(name);
+    if (iter == mActions.end()) return nullptr;
+    return iter->second.get();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "setup.hpp"
+
+namespace sts {
+
+//============================================================================//
+
+/// C++ version of a simple action, used instead of its wren script.
+///
+/// Implementations are shared by every fighter that uses them, so they can't
+/// have any state of their own, everything must be based on the frame. None of
+/// the methods may call into wren, so changing state is done by the action
+/// before the first update, and starting the next action after the last one.
+class NativeAction
+{
+public: //====================================================//
+
+    virtual ~NativeAction() = default;
+
+    /// State to change to when starting, or empty to keep the current state.
+    virtual TinyString get_state() const { return {}; }
+
+    /// Called once per frame, starting from zero on the frame the action starts.
+    ///
+    /// Returns nullopt while still running, otherwise the action to start next,
+    /// which will be empty if the fighter should just be left without one.
+    virtual std::optional<SmallString> update(FighterAction& action, uint frame) const = 0;
+
+    /// Called if the action ends before update has finished.
+    virtual void cancel(FighterAction& /*action*/) const {}
+};
+
+//============================================================================//
+
+/// All of the native actions that fighters can choose from, by name.
+class NativeActionRegistry final
+{
+public: //====================================================//
+
+    SQEE_COPY_DELETE(NativeActionRegistry)
+    SQEE_MOVE_DELETE(NativeActionRegistry)
+
+    static const NativeActionRegistry& get();
+
+    /// Find an action by name, or null if there is none.
+    const NativeAction* find(StringView name) const;
+
+private: //===================================================//
+
+    NativeActionRegistry();
+
+    void add(String name, std::unique_ptr<NativeAction> action);
+
+    std::map<String, std::unique_ptr<NativeAction>, std::less<>> mActions;
+};
+
+//============================================================================//
+
+} // namespace sts
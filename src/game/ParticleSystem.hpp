@@ -49,6 +49,10 @@ public: //====================================================//
     /// Simulate all particles, then destroy dead particles.
     void update_and_clean();
 
+    void save_state(StateBuffer& buffer) const;
+
+    void load_state(StateReader& reader);
+
     //--------------------------------------------------------//
 
     // temporarily hardcoded list of sprites
@@ -0,0 +1,124 @@
+#include "game/ScriptProfiler.hpp"
+
+#include "game/ArticleDef.hpp"
+#include "game/FighterAction.hpp"
+#include "game/FighterDef.hpp"
+#include "game/FighterState.hpp"
+#include "game/World.hpp"
+#include "game/WrenHeap.hpp"
+
+using namespace sts;
+
+using Clock = std::chrono::steady_clock;
+
+//============================================================================//
+
+namespace {
+
+// collecting before a call when closer than this to the threshold means the
+// vm almost never collects during one, which would hide what it allocated
+constexpr size_t COLLECTION_MARGIN = 256u * 1024u;
+
+} // anonymous namespace
+
+//============================================================================//
+
+ScriptProfiler::ScriptProfiler(World& world) : mWorld(world) {}
+
+//============================================================================//
+
+ScriptProfiler::Scope::Scope(const FighterActionDef& def, const char* method)
+    : Scope(def.fighter.world.get_script_profiler(), &def, method, [](const void* ptr) {
+        const auto& def = *static_cast<const FighterActionDef*>(ptr);
+        return fmt::format("{}/actions/{}", def.fighter.directory, def.name);
+    }) {}
+
+ScriptProfiler::Scope::Scope(const FighterStateDef& def, const char* method)
+    : Scope(def.fighter.world.get_script_profiler(), &def, method, [](const void* ptr) {
+        const auto& def = *static_cast<const FighterStateDef*>(ptr);
+        return fmt::format("{}/states/{}", def.fighter.directory, def.name);
+    }) {}
+
+ScriptProfiler::Scope::Scope(const ArticleDef& def, const char* method)
+    : Scope(def.world.get_script_profiler(), &def, method, [](const void* ptr) {
+        const auto& def = *static_cast<const ArticleDef*>(ptr);
+        return fmt::format("{}/Article", def.directory);
+    }) {}
+
+ScriptProfiler::Scope::Scope(ScriptProfiler& profiler, const void* def, const char* method, String (*make_module)(const void*))
+    : mDef(def), mMethod(method), mMakeModule(make_module)
+{
+    if (profiler.mEnabled == false) return;
+
+    WrenVM* const vm = profiler.mWorld.vm;
+
+    // only the outermost scope may collect, or it would hide allocations from the others
+    if (profiler.mDepth == 0u && WrenHeap::get_allocated_bytes(vm) + COLLECTION_MARGIN > WrenHeap::get_next_collection(vm))
+        wrenCollectGarbage(vm);
+
+    profiler.mDepth += 1u;
+
+    mProfiler = &profiler;
+    mBeginBytes = WrenHeap::get_allocated_bytes(vm);
+    mBeginNextCollection = WrenHeap::get_next_collection(vm);
+    mBeginTime = Clock::now();
+}
+
+ScriptProfiler::Scope::~Scope()
+{
+    if (mProfiler == nullptr) return;
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - mBeginTime).count();
+
+    WrenVM* const vm = mProfiler->mWorld.vm;
+    mProfiler->mDepth -= 1u;
+
+    const auto [iter, created] = mProfiler->mEntries.try_emplace({mDef, mMethod});
+    Entry& entry = iter->second;
+
+    if (created == true)
+    {
+        entry.module = mMakeModule(mDef);
+        entry.method = mMethod;
+    }
+
+    entry.calls += 1u;
+    entry.totalSeconds += seconds;
+    entry.maxSeconds = maths::max(entry.maxSeconds, seconds);
+
+    // frees aren't counted, so the count only goes down or the threshold changes if the vm collected
+    const size_t endBytes = WrenHeap::get_allocated_bytes(vm);
+    if (endBytes >= mBeginBytes && WrenHeap::get_next_collection(vm) == mBeginNextCollection)
+        entry.allocatedBytes += endBytes - mBeginBytes;
+}
+
+//============================================================================//
+
+std::vector<const ScriptProfiler::Entry*> ScriptProfiler::get_sorted_entries() const
+{
+    std::vector<const Entry*> result;
+    result.reserve(mEntries.size());
+
+    for (const auto& [key, entry] : mEntries)
+        result.push_back(&entry);
+
+    ranges::sort(result, [](const Entry* a, const Entry* b) { return a->totalSeconds > b->totalSeconds; });
+
+    return result;
+}
+
+String ScriptProfiler::to_csv() const
+{
+    String result = "module,method,calls,total_ms,mean_us,max_us,allocated_bytes\n";
+
+    for (const Entry* entry : get_sorted_entries())
+    {
+        result += fmt::format (
+            "{},{},{},{:.3f},{:.3f},{:.3f},{}\n", entry->module, entry->method, entry->calls,
+            entry->totalSeconds * 1000.0, entry->totalSeconds * 1000000.0 / double(entry->calls),
+            entry->maxSeconds * 1000000.0, entry->allocatedBytes
+        );
+    }
+
+    return result;
+}
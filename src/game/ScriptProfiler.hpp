@@ -0,0 +1,102 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include <chrono>
+
+namespace sts {
+
+//============================================================================//
+
+/// Time, call counts, and wren allocations of script calls, by definition.
+///
+/// Times and allocations are inclusive, so if a state script starts an action,
+/// the action's do_start shows up as part of the state's do_updates. Off by
+/// default, when disabled each call only costs a branch.
+class ScriptProfiler final
+{
+public: //====================================================//
+
+    ScriptProfiler(World& world);
+
+    SQEE_COPY_DELETE(ScriptProfiler)
+    SQEE_MOVE_DELETE(ScriptProfiler)
+
+    //--------------------------------------------------------//
+
+    struct Entry
+    {
+        /// Module of the script, like "fighters/Mario/actions/NeutralFirst".
+        String module;
+
+        /// Name of the method called from C++.
+        const char* method;
+
+        uint64_t calls = 0u;
+        double totalSeconds = 0.0;
+        double maxSeconds = 0.0;
+
+        /// Bytes the wren vm allocated during calls, not counting calls where it collected garbage.
+        uint64_t allocatedBytes = 0u;
+    };
+
+    /// Measures a script call until destroyed, if profiling is enabled.
+    class Scope final
+    {
+    public:
+
+        Scope(const FighterActionDef& def, const char* method);
+        Scope(const FighterStateDef& def, const char* method);
+        Scope(const ArticleDef& def, const char* method);
+
+        SQEE_COPY_DELETE(Scope)
+        SQEE_MOVE_DELETE(Scope)
+
+        ~Scope();
+
+    private:
+
+        Scope(ScriptProfiler& profiler, const void* def, const char* method, String (*make_module)(const void*));
+
+        ScriptProfiler* mProfiler = nullptr;
+
+        const void* mDef;
+        const char* mMethod;
+        String (*mMakeModule)(const void*);
+
+        std::chrono::steady_clock::time_point mBeginTime;
+        size_t mBeginBytes;
+        size_t mBeginNextCollection;
+    };
+
+    //--------------------------------------------------------//
+
+    void set_enabled(bool enable) { mEnabled = enable; }
+
+    bool is_enabled() const { return mEnabled; }
+
+    /// Forget everything measured so far.
+    void reset() { mEntries.clear(); }
+
+    /// Get entries sorted by total time, highest first.
+    std::vector<const Entry*> get_sorted_entries() const;
+
+    /// Format all entries as CSV, with a header row.
+    String to_csv() const;
+
+private: //===================================================//
+
+    World& mWorld;
+
+    bool mEnabled = false;
+
+    /// Number of scopes currently open, since calls can be nested.
+    uint mDepth = 0u;
+
+    // methods are always string literals, so can be compared by address
+    std::map<std::pair<const void*, const char*>, Entry> mEntries;
+};
+
+//============================================================================//
+
+} // namespace sts
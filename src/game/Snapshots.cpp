@@ -0,0 +1,746 @@
+#include "game/StateBuffer.hpp"
+
+#include "game/Article.hpp"
+#include "game/Controller.hpp"
+#include "game/EffectSystem.hpp"
+#include "game/Fighter.hpp"
+#include "game/FighterAction.hpp"
+#include "game/FighterState.hpp"
+#include "game/HitBlob.hpp"
+#include "game/HurtBlob.hpp"
+#include "game/ParticleSystem.hpp"
+#include "game/Stage.hpp"
+#include "game/VisualEffect.hpp"
+#include "game/World.hpp"
+
+using namespace sts;
+
+// Snapshots are written with memcpy wherever possible. Definitions are never
+// created or destroyed during a game, so they are stored as raw pointers, but
+// entities are, so they are stored by id.
+
+// Fibers can't be copied, so they are stored as a ScriptProgress, and loading
+// resumes a new fiber from the start until it catches up. Fighters are read
+// before that, so that scripts branch the same way as when they first ran, and
+// again after, so that side effects of the scripts get overwritten.
+
+// Fields of script objects aren't visible from C++, so scripts that have any
+// return them as a list from save_fields(), and get the same list back in
+// load_fields(_) once every fiber has caught up. Only bools, numbers, strings,
+// and null can be stored.
+
+//============================================================================//
+
+namespace {
+
+/// Call save_fields() on a script object and write the list that it returns.
+///
+/// Returns an error message, or an empty string on success.
+String write_script_fields(World& world, WrenHandle* script, StateBuffer& buffer)
+{
+    const auto safe = world.vm.safe_call<WrenHandle*>(world.handles.script_save_fields, script);
+
+    if (safe.ok == false)
+    {
+        buffer.write(uint32_t(0u));
+        return safe.error;
+    }
+
+    WrenVM* const vm = world.vm;
+
+    wrenEnsureSlots(vm, 2);
+    wrenSetSlotHandle(vm, 0, safe.value);
+    wrenReleaseHandle(vm, safe.value);
+
+    if (wrenGetSlotType(vm, 0) != WREN_TYPE_LIST)
+    {
+        buffer.write(uint32_t(0u));
+        return wrenGetSlotType(vm, 0) == WREN_TYPE_NULL ? String() : String("save_fields() must return a list");
+    }
+
+    const int count = wrenGetListCount(vm, 0);
+    buffer.write(uint32_t(count));
+
+    String error;
+
+    for (int index = 0; index < count; ++index)
+    {
+        wrenGetListElement(vm, 0, index, 1);
+
+        WrenType type = wrenGetSlotType(vm, 1);
+
+        // write null instead, so that the buffer can still be read
+        if (type != WREN_TYPE_BOOL && type != WREN_TYPE_NUM && type != WREN_TYPE_STRING && type != WREN_TYPE_NULL)
+        {
+            error = fmt::format("save_fields()[{}] is not a bool, num, string, or null", index);
+            type = WREN_TYPE_NULL;
+        }
+
+        buffer.write(uint8_t(type));
+
+        if (type == WREN_TYPE_BOOL)
+            buffer.write(wrenGetSlotBool(vm, 1));
+
+        else if (type == WREN_TYPE_NUM)
+            buffer.write(wrenGetSlotDouble(vm, 1));
+
+        else if (type == WREN_TYPE_STRING)
+        {
+            int length = 0;
+            const char* bytes = wrenGetSlotBytes(vm, 1, &length);
+            buffer.write(uint32_t(length));
+            buffer.write_bytes(bytes, size_t(length));
+        }
+    }
+
+    return error;
+}
+
+/// Read fields written by write_script_fields and pass them to load_fields(_).
+///
+/// The fields are always read, even if there's no script to give them to.
+/// Returns an error message, or an empty string on success.
+String read_script_fields(World& world, WrenHandle* script, StateReader& reader)
+{
+    const uint32_t count = reader.read<uint32_t>();
+    if (count == 0u) return {};
+
+    WrenVM* const vm = world.vm;
+
+    wrenEnsureSlots(vm, 2);
+    wrenSetSlotNewList(vm, 0);
+
+    for (uint32_t index = 0u; index < count; ++index)
+    {
+        const auto type = WrenType(reader.read<uint8_t>());
+
+        if (type == WREN_TYPE_BOOL)
+            wrenSetSlotBool(vm, 1, reader.read<bool>());
+
+        else if (type == WREN_TYPE_NUM)
+            wrenSetSlotDouble(vm, 1, reader.read<double>());
+
+        else if (type == WREN_TYPE_STRING)
+        {
+            const uint32_t length = reader.read<uint32_t>();
+            reader.check_remaining(length);
+            String bytes(length, '\0');
+            reader.read_bytes(bytes.data(), length);
+            wrenSetSlotBytes(vm, 1, bytes.data(), length);
+        }
+
+        else if (type == WREN_TYPE_NULL)
+            wrenSetSlotNull(vm, 1);
+
+        else throw std::runtime_error("invalid script field in state buffer");
+
+        wrenInsertInList(vm, 0, -1, 1);
+    }
+
+    if (script == nullptr) return {};
+
+    WrenHandle* const fields = wrenGetSlotHandle(vm, 0);
+    const auto error = world.vm.safe_call_void(world.handles.script_load_fields, script, fields);
+    wrenReleaseHandle(vm, fields);
+
+    return error;
+}
+
+} // anonymous namespace
+
+//============================================================================//
+
+void World::save_state(StateBuffer& buffer)
+{
+    buffer.clear();
+
+    //-- world and fighters, loaded before and after scripts -//
+
+    buffer.write(mEntityId);
+    buffer.write(mRandNumGen);
+    buffer.write(mChecksum);
+
+    mStage->save_state(buffer);
+
+    for (const auto& fighter : mFighters)
+        fighter->save_state(buffer);
+
+    //-- scripts ---------------------------------------------//
+
+    for (const auto& fighter : mFighters)
+        fighter->save_script_state(buffer);
+
+    buffer.write(uint32_t(mArticles.size()));
+
+    for (const auto& article : mArticles)
+    {
+        buffer.write(article->eid);
+        buffer.write(&article->def);
+        buffer.write(article->fighter != nullptr ? int8_t(article->fighter->index) : int8_t(-1));
+        buffer.write(article->get_progress());
+    }
+
+    //-- script fields, loaded once fibers have caught up ----//
+
+    for (const auto& fighter : mFighters)
+        fighter->save_script_fields(buffer);
+
+    for (const auto& article : mArticles)
+        article->save_script_fields(buffer);
+
+    //-- everything else -------------------------------------//
+
+    for (const auto& article : mArticles)
+        article->save_state(buffer);
+
+    mEffectSystem->save_state(buffer);
+    mParticleSystem->save_state(buffer);
+}
+
+//============================================================================//
+
+void World::load_state(const StateBuffer& buffer)
+{
+    StateReader reader { buffer };
+
+    //-- world and fighters, loaded before and after scripts -//
+
+    const auto load_world_and_fighters = [this](StateReader& source)
+    {
+        source.read(mEntityId);
+        source.read(mRandNumGen);
+        source.read(mChecksum);
+
+        mStage->load_state(source);
+
+        for (auto& fighter : mFighters)
+            fighter->load_state(source);
+    };
+
+    // so that scripts see the same variables while being fast forwarded as when they first ran
+    load_world_and_fighters(reader);
+
+    //-- scripts ---------------------------------------------//
+
+    mRestoringState = true;
+
+    for (auto& fighter : mFighters)
+        fighter->load_script_state(reader);
+
+    // entity ids get reused after loading, but run ids don't
+    auto oldArticles = std::move(mArticles);
+    mArticles.clear();
+
+    const uint32_t articleCount = reader.read<uint32_t>();
+
+    for (uint32_t i = 0u; i < articleCount; ++i)
+    {
+        const auto eid = reader.read<int32_t>();
+        const auto def = reader.read<const ArticleDef*>();
+        const auto fighterIndex = reader.read<int8_t>();
+        const auto progress = reader.read<ScriptProgress>();
+
+        const auto iter = ranges::find_if(oldArticles, [&](const auto& article) {
+            return article != nullptr && article->get_progress().runId == progress.runId;
+        });
+
+        if (iter != oldArticles.end())
+        {
+            mArticles.push_back(std::move(*iter));
+        }
+        else // article was destroyed since the snapshot was saved
+        {
+            mEntityId = eid - 1; // will be restored properly later
+            Fighter* fighter = fighterIndex >= 0 ? mFighters[fighterIndex].get() : nullptr;
+            mArticles.push_back(std::make_unique<Article>(*def, fighter));
+            mArticles.back()->call_do_construct();
+        }
+
+        mArticles.back()->restore_progress(progress);
+    }
+
+    // any articles left were created after the snapshot was saved
+    oldArticles.clear();
+
+    //-- script fields, loaded once fibers have caught up ----//
+
+    for (auto& fighter : mFighters)
+        fighter->load_script_fields(reader);
+
+    for (auto& article : mArticles)
+        article->load_script_fields(reader);
+
+    mRestoringState = false;
+
+    //-- everything else -------------------------------------//
+
+    // read again from the start, to overwrite any side effects of the scripts
+    StateReader worldReader { buffer };
+    load_world_and_fighters(worldReader);
+
+    for (auto& article : mArticles)
+        article->load_state(reader);
+
+    mEffectSystem->load_state(reader);
+    mParticleSystem->load_state(reader);
+
+    SQASSERT(reader.at_end(), "snapshot not fully read");
+}
+
+//============================================================================//
+
+void Stage::save_state(StateBuffer& buffer) const
+{
+    for (const Ledge& ledge : mLedges)
+        buffer.write(ledge.grabber);
+}
+
+void Stage::load_state(StateReader& reader)
+{
+    for (Ledge& ledge : mLedges)
+        reader.read(ledge.grabber);
+}
+
+//============================================================================//
+
+void Controller::save_state(StateBuffer& buffer) const
+{
+    buffer.write_range(history.frames);
+    buffer.write(history.cleared);
+
+    // gamepad state only comes from the device, so isn't needed
+    buffer.write(mKeyboard);
+
+    buffer.write(mTimeSinceZeroX);
+    buffer.write(mTimeSinceZeroY);
+    buffer.write(mDoneMashX);
+    buffer.write(mDoneMashY);
+
+    buffer.write(mPlaybackIndex);
+}
+
+void Controller::load_state(StateReader& reader)
+{
+    reader.read_range(history.frames);
+    reader.read(history.cleared);
+
+    reader.read(mKeyboard);
+
+    reader.read(mTimeSinceZeroX);
+    reader.read(mTimeSinceZeroY);
+    reader.read(mDoneMashX);
+    reader.read(mDoneMashY);
+
+    reader.read(mPlaybackIndex);
+}
+
+//============================================================================//
+
+void Entity::save_entity_state(StateBuffer& buffer) const
+{
+    const EntityVars& vars = get_vars();
+
+    buffer.write(vars.bully != nullptr ? vars.bully->eid : int32_t(-1));
+    buffer.write(vars.victim != nullptr ? vars.victim->eid : int32_t(-1));
+
+    buffer.write(previous);
+    buffer.write(current);
+
+    buffer.write(mAnimPlayer.animation);
+    buffer.write(mAnimPlayer.animTime);
+    buffer.write_range(mAnimPlayer.previousSample);
+    buffer.write_range(mAnimPlayer.currentSample);
+
+    buffer.write(mModelMatrix);
+
+    buffer.write_range(mTransientSounds);
+    buffer.write_range(mTransientEffects);
+
+    buffer.write(uint32_t(mHitBlobs.size()));
+
+    for (const HitBlob& blob : mHitBlobs)
+    {
+        buffer.write(&blob.def);
+        buffer.write(blob.capsule);
+        buffer.write(blob.justCreated);
+        buffer.write(blob.cancelled);
+    }
+
+    buffer.write_range(mIgnoreCollisions);
+
+    buffer.write(mNextAnimation);
+    buffer.write(mFadeFrames);
+    buffer.write(mNextFadeFrames);
+    buffer.write(mFadeProgress);
+
+    buffer.write(mRootMotionPreviousOffset);
+    buffer.write(mRootMotionTranslate);
+
+    buffer.write(mFadeStartPosition);
+    buffer.write(mFadeStartRotation);
+    buffer.write_range(mFadeStartSample);
+
+    buffer.write(mRotateMode);
+    buffer.write(mRotateSlowTime);
+    buffer.write(mRotateSlowProgress);
+}
+
+void Entity::load_entity_state(StateReader& reader)
+{
+    EntityVars& vars = get_vars();
+
+    // variables have already been read, but pointers might be stale
+    vars.bully = world.find_entity(reader.read<int32_t>());
+    vars.victim = world.find_entity(reader.read<int32_t>());
+
+    reader.read(previous);
+    reader.read(current);
+
+    reader.read(mAnimPlayer.animation);
+    reader.read(mAnimPlayer.animTime);
+    reader.read_range(mAnimPlayer.previousSample);
+    reader.read_range(mAnimPlayer.currentSample);
+    mAnimPlayer.invalidate_bone_matrices();
+
+    reader.read(mModelMatrix);
+
+    reader.read_range(mTransientSounds);
+    reader.read_range(mTransientEffects);
+
+    mHitBlobs.clear();
+
+    for (uint32_t count = reader.read<uint32_t>(); count != 0u; --count)
+    {
+        HitBlob& blob = mHitBlobs.emplace_back(*reader.read<const HitBlobDef*>(), this);
+        reader.read(blob.capsule);
+        reader.read(blob.justCreated);
+        reader.read(blob.cancelled);
+    }
+
+    reader.read_range(mIgnoreCollisions);
+
+    reader.read(mNextAnimation);
+    reader.read(mFadeFrames);
+    reader.read(mNextFadeFrames);
+    reader.read(mFadeProgress);
+
+    reader.read(mRootMotionPreviousOffset);
+    reader.read(mRootMotionTranslate);
+
+    reader.read(mFadeStartPosition);
+    reader.read(mFadeStartRotation);
+    reader.read_range(mFadeStartSample);
+
+    reader.read(mRotateMode);
+    reader.read(mRotateSlowTime);
+    reader.read(mRotateSlowProgress);
+}
+
+//============================================================================//
+
+void Fighter::save_script_state(StateBuffer& buffer) const
+{
+    buffer.write(activeState);
+    buffer.write(activeAction);
+
+    if (activeAction != nullptr)
+        buffer.write(activeAction->get_progress());
+}
+
+void Fighter::load_script_state(StateReader& reader)
+{
+    reader.read(activeState);
+    reader.read(activeAction);
+
+    if (activeAction != nullptr)
+        activeAction->restore_progress(reader.read<ScriptProgress>());
+}
+
+void Fighter::save_script_fields(StateBuffer& buffer)
+{
+    // written again, since loading fast forwards actions before reading fields
+    buffer.write(activeState);
+    buffer.write(activeAction);
+
+    if (activeState != nullptr)
+        activeState->save_script_fields(buffer);
+
+    if (activeAction != nullptr)
+        activeAction->save_script_fields(buffer);
+}
+
+void Fighter::load_script_fields(StateReader& reader)
+{
+    const auto state = reader.read<FighterState*>();
+    const auto action = reader.read<FighterAction*>();
+
+    if (state != nullptr)
+        state->load_script_fields(reader);
+
+    if (action != nullptr)
+        action->load_script_fields(reader);
+}
+
+//----------------------------------------------------------------------------//
+
+void Fighter::save_state(StateBuffer& buffer) const
+{
+    buffer.write(variables);
+
+    save_entity_state(buffer);
+
+    buffer.write(diamond);
+
+    // scripts may have changed these while being fast forwarded
+    buffer.write(activeState);
+    buffer.write(activeAction);
+
+    for (const HurtBlob& blob : mHurtBlobs)
+    {
+        buffer.write(blob.capsule);
+        buffer.write(blob.intangible);
+        buffer.write(blob.invincible);
+    }
+
+    buffer.write(mJitterCounter);
+    buffer.write(mHurtRegion);
+
+    if (controller != nullptr)
+        controller->save_state(buffer);
+}
+
+void Fighter::load_state(StateReader& reader)
+{
+    reader.read(variables);
+
+    load_entity_state(reader);
+
+    reader.read(diamond);
+
+    reader.read(activeState);
+    reader.read(activeAction);
+
+    for (HurtBlob& blob : mHurtBlobs)
+    {
+        reader.read(blob.capsule);
+        reader.read(blob.intangible);
+        reader.read(blob.invincible);
+    }
+
+    reader.read(mJitterCounter);
+    reader.read(mHurtRegion);
+
+    if (controller != nullptr)
+        controller->load_state(reader);
+}
+
+//============================================================================//
+
+ScriptProgress FighterAction::get_progress() const
+{
+    return { mRunId, mCurrentFrame, mWaitUntil };
+}
+
+void FighterAction::restore_progress(const ScriptProgress& progress)
+{
+    // fiber is already in the right place
+    if (progress.runId == mRunId && progress.currentFrame == mCurrentFrame)
+        return;
+
+    // native actions only depend on the frame, so there's nothing to replay
+    if (def.native == nullptr)
+    {
+        const auto error = world.vm.safe_call_void(world.handles.action_do_fast_forward, this, progress.currentFrame);
+        if (error.empty() == false)
+            set_error_message("restore_progress", error);
+    }
+
+    mRunId = progress.runId;
+    mCurrentFrame = progress.currentFrame;
+    mWaitUntil = progress.waitUntil;
+}
+
+void FighterAction::save_script_fields(StateBuffer& buffer)
+{
+    if (mScriptHasFields == false)
+    {
+        buffer.write(uint32_t(0u));
+        return;
+    }
+
+    const auto error = write_script_fields(world, mScriptHandle, buffer);
+    if (error.empty() == false)
+        set_error_message("save_script_fields", error);
+}
+
+void FighterAction::load_script_fields(StateReader& reader)
+{
+    const auto error = read_script_fields(world, mScriptHandle, reader);
+    if (error.empty() == false)
+        set_error_message("load_script_fields", error);
+}
+
+//============================================================================//
+
+void FighterState::save_script_fields(StateBuffer& buffer)
+{
+    if (mScriptHasFields == false)
+    {
+        buffer.write(uint32_t(0u));
+        return;
+    }
+
+    const auto error = write_script_fields(world, mScriptHandle, buffer);
+    if (error.empty() == false)
+        set_error_message("save_script_fields", error);
+}
+
+void FighterState::load_script_fields(StateReader& reader)
+{
+    const auto error = read_script_fields(world, mScriptHandle, reader);
+    if (error.empty() == false)
+        set_error_message("load_script_fields", error);
+}
+
+//============================================================================//
+
+ScriptProgress Article::get_progress() const
+{
+    return { mRunId, mCurrentFrame, mWaitUntil };
+}
+
+void Article::restore_progress(const ScriptProgress& progress)
+{
+    // fiber is already in the right place
+    if (progress.runId == mRunId && progress.currentFrame == mCurrentFrame)
+        return;
+
+    // won't have a script if its constructor aborted
+    if (mScriptHandle != nullptr)
+    {
+        const auto error = world.vm.safe_call_void(world.handles.article_do_fast_forward, this, progress.currentFrame);
+        if (error.empty() == false)
+            set_error_message("restore_progress", error);
+    }
+
+    mRunId = progress.runId;
+    mCurrentFrame = progress.currentFrame;
+    mWaitUntil = progress.waitUntil;
+}
+
+void Article::save_script_fields(StateBuffer& buffer)
+{
+    // won't have a script if its constructor aborted
+    if (mScriptHandle == nullptr || mScriptHasFields == false)
+    {
+        buffer.write(uint32_t(0u));
+        return;
+    }
+
+    const auto error = write_script_fields(world, mScriptHandle, buffer);
+    if (error.empty() == false)
+        set_error_message("save_script_fields", error);
+}
+
+void Article::load_script_fields(StateReader& reader)
+{
+    const auto error = read_script_fields(world, mScriptHandle, reader);
+    if (error.empty() == false)
+        set_error_message("load_script_fields", error);
+}
+
+//----------------------------------------------------------------------------//
+
+void Article::save_state(StateBuffer& buffer) const
+{
+    buffer.write(variables);
+
+    save_entity_state(buffer);
+
+    buffer.write(mJustCreated);
+    buffer.write(mMarkedForDestroy);
+}
+
+void Article::load_state(StateReader& reader)
+{
+    reader.read(variables);
+
+    load_entity_state(reader);
+
+    reader.read(mJustCreated);
+    reader.read(mMarkedForDestroy);
+}
+
+//============================================================================//
+
+void EffectSystem::save_state(StateBuffer& buffer) const
+{
+    buffer.write(mCurrentId);
+    buffer.write(uint32_t(mEffects.size()));
+
+    for (const auto& effect : mEffects)
+    {
+        buffer.write(&effect->def);
+        buffer.write(effect->entity != nullptr ? effect->entity->eid : int32_t(-1));
+        buffer.write(effect->id);
+
+        buffer.write(effect->animPlayer.animTime);
+        buffer.write_range(effect->animPlayer.previousSample);
+        buffer.write_range(effect->animPlayer.currentSample);
+
+        buffer.write(effect->modelMatrix);
+        buffer.write(effect->bbScaleX);
+    }
+}
+
+void EffectSystem::load_state(StateReader& reader)
+{
+    reader.read(mCurrentId);
+
+    auto oldEffects = std::move(mEffects);
+    mEffects.clear();
+
+    for (uint32_t count = reader.read<uint32_t>(); count != 0u; --count)
+    {
+        const auto def = reader.read<const VisualEffectDef*>();
+        const Entity* entity = world.find_entity(reader.read<int32_t>());
+        const auto id = reader.read<int32_t>();
+
+        // reuse effects that still exist, since creating them allocates
+        const auto iter = ranges::find_if(oldEffects, [&](const auto& effect) {
+            return effect != nullptr && effect->id == id && &effect->def == def && effect->entity == entity;
+        });
+
+        if (iter != oldEffects.end())
+            mEffects.push_back(std::move(*iter));
+        else
+            mEffects.push_back(std::make_unique<VisualEffect>(*def, entity));
+
+        VisualEffect& effect = *mEffects.back();
+
+        effect.id = id;
+
+        reader.read(effect.animPlayer.animTime);
+        reader.read_range(effect.animPlayer.previousSample);
+        reader.read_range(effect.animPlayer.currentSample);
+
+        reader.read(effect.modelMatrix);
+        reader.read(effect.bbScaleX);
+    }
+}
+
+//============================================================================//
+
+void ParticleSystem::save_state(StateBuffer& buffer) const
+{
+    SQASSERT(mGenerateCalls.empty() == true, "can only save between ticks");
+
+    buffer.write_range(mParticles);
+}
+
+void ParticleSystem::load_state(StateReader& reader)
+{
+    mGenerateCalls.clear();
+
+    reader.read_range(mParticles);
+}
@@ -7,12 +7,13 @@ using namespace sts;
 
 //============================================================================//
 
-void SoundEffect::from_json(JsonObject json, SoundCache& cache)
+void SoundEffect::from_json(JsonObject json, SoundCache* cache)
 {
     path = json["path"].as_auto();
     volume = json["volume"].as_auto();
 
-    handle = cache.acquire(path);
+    if (cache != nullptr)
+        handle = cache->acquire(path);
 }
 
 //============================================================================//
@@ -28,7 +28,8 @@ struct SoundEffect final
         return *std::prev(reinterpret_cast<const SmallString*>(this));
     }
 
-    void from_json(JsonObject json, SoundCache& cache);
+    /// Load from json, acquiring the sound if a cache is given.
+    void from_json(JsonObject json, SoundCache* cache);
 
     void to_json(JsonMutObject json) const;
 
@@ -3,6 +3,8 @@
 #include "game/Physics.hpp"
 #include "game/World.hpp"
 
+#include "main/AssetArchive.hpp"
+
 #include "render/Camera.hpp"
 #include "render/Renderer.hpp"
 #include "render/UniformBlocks.hpp"
@@ -19,7 +21,7 @@ Stage::Stage(World& world, TinyString name)
     , mArmature(fmt::format("assets/stages/{}/Armature.json", name))
     , mAnimPlayer(mArmature)
 {
-    const auto document = JsonDocument::parse_file(fmt::format("assets/stages/{}/Stage.json", name));
+    const auto document = parse_asset_json(fmt::format("assets/stages/{}/Stage.json", name));
     const auto json = document.root().as<JsonObject>();
 
     const auto jRender = json["render"].as<JsonObject>();
@@ -60,19 +62,23 @@ Stage::Stage(World& world, TinyString name)
         platform.maxX = jPlatform["maxX"].as_auto();
     }
 
+    // headless worlds only need the collision geometry
+    if (world.is_headless() == true)
+        return;
+
     // load environment maps
     {
-        mEnvironment.cubemaps.skybox = world.caches.cubeTextures.acquire(mSkyboxPath + "/Sky");
-        mEnvironment.cubemaps.irradiance = world.caches.cubeTextures.acquire(mSkyboxPath + "/Irradiance");
-        mEnvironment.cubemaps.radiance = world.caches.cubeTextures.acquire(mSkyboxPath + "/Radiance");
+        mEnvironment.cubemaps.skybox = world.caches->cubeTextures.acquire(mSkyboxPath + "/Sky");
+        mEnvironment.cubemaps.irradiance = world.caches->cubeTextures.acquire(mSkyboxPath + "/Irradiance");
+        mEnvironment.cubemaps.radiance = world.caches->cubeTextures.acquire(mSkyboxPath + "/Radiance");
 
-        world.renderer.set_environment(mEnvironment);
-        world.renderer.update_cubemap_descriptor_sets();
+        world.renderer->set_environment(mEnvironment);
+        world.renderer->update_cubemap_descriptor_sets();
     }
 
     mDrawItems = sq::DrawItem::load_from_json (
         fmt::format("assets/stages/{}/Render.json", name), mArmature,
-        world.caches.meshes, world.caches.pipelines, world.caches.textures
+        world.caches->meshes, world.caches->pipelines, world.caches->textures
     );
 
     // todo: change to wren expressions
@@ -95,10 +101,10 @@ void Stage::tick()
 
 void Stage::integrate(float /*blend*/)
 {
-    Mat34F* modelMats = world.renderer.reserve_matrices(1u, mAnimPlayer.modelMatsIndex);
+    Mat34F* modelMats = world.renderer->reserve_matrices(1u, mAnimPlayer.modelMatsIndex);
     modelMats[0] = Mat34F();
 
-    Mat34F* normalMats = world.renderer.reserve_matrices(1u, mAnimPlayer.normalMatsIndex);
+    Mat34F* normalMats = world.renderer->reserve_matrices(1u, mAnimPlayer.normalMatsIndex);
     normalMats[0] = Mat34F();
 
     const auto check_condition = [&](const TinyString& condition)
@@ -109,9 +115,9 @@ void Stage::integrate(float /*blend*/)
 
     for (const sq::DrawItem& item : mDrawItems)
         if (check_condition(item.condition) == true)
-            world.renderer.add_draw_call(item, mAnimPlayer);
+            world.renderer->add_draw_call(item, mAnimPlayer);
 
-    auto& environmentBlock = *reinterpret_cast<EnvironmentBlock*>(world.renderer.ubos.environment.swap_map());
+    auto& environmentBlock = *reinterpret_cast<EnvironmentBlock*>(world.renderer->ubos.environment.swap_map());
     environmentBlock.lightColour = mLightColour;
     environmentBlock.lightDirection = maths::normalize(mLightDirection);
 
@@ -121,7 +127,7 @@ void Stage::integrate(float /*blend*/)
     const Vec3F minimum = maths::min(mShadowCasters.min, Vec3F(fighters.min, +INFINITY));
     const Vec3F maximum = maths::max(mShadowCasters.max, Vec3F(fighters.max, -INFINITY));
 
-    environmentBlock.projViewMatrix = world.renderer.get_camera().compute_light_matrix(environmentBlock.viewMatrix, minimum, maximum);
+    environmentBlock.projViewMatrix = world.renderer->get_camera().compute_light_matrix(environmentBlock.viewMatrix, minimum, maximum);
 }
 
 //============================================================================//
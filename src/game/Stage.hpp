@@ -70,6 +70,10 @@ public: //====================================================//
 
     bool check_point_out_of_bounds(Vec2F point);
 
+    void save_state(StateBuffer& buffer) const;
+
+    void load_state(StateReader& reader);
+
     //--------------------------------------------------------//
 
     const Environment& get_environment() const { return mEnvironment; }
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include <cstring> // memcpy
+#include <stdexcept>
+
+namespace sts {
+
+//============================================================================//
+
+/// Flat binary storage for World snapshots.
+///
+/// Snapshots store raw pointers to definitions, so a buffer is only valid for
+/// the World that wrote it. Use replay files for anything that leaves memory.
+class StateBuffer final
+{
+public: //====================================================//
+
+    void clear() { mBytes.clear(); }
+
+    size_t size() const { return mBytes.size(); }
+
+    const std::byte* data() const { return mBytes.data(); }
+
+    //--------------------------------------------------------//
+
+    /// Append a trivially copyable value.
+    template <class Type>
+    void write(const Type& value)
+    {
+        static_assert(std::is_trivially_copyable_v<Type>);
+        write_bytes(&value, sizeof(Type));
+    }
+
+    /// Append a size followed by a contiguous range of trivially copyable values.
+    template <class Range>
+    void write_range(const Range& range)
+    {
+        static_assert(std::is_trivially_copyable_v<std::remove_cvref_t<decltype(*std::data(range))>>);
+        write(uint32_t(std::size(range)));
+        write_bytes(std::data(range), sizeof(*std::data(range)) * std::size(range));
+    }
+
+    void write_bytes(const void* source, size_t count)
+    {
+        const size_t offset = mBytes.size();
+        mBytes.resize(offset + count);
+        std::memcpy(mBytes.data() + offset, source, count);
+    }
+
+private: //===================================================//
+
+    // capacity is kept when cleared, so reusing a buffer doesn't allocate
+    std::vector<std::byte> mBytes;
+};
+
+//============================================================================//
+
+/// Reads values from a StateBuffer in the order that they were written.
+///
+/// Reading past the end throws, rather than asserting, since buffers can come
+/// from files that were truncated or written by an older version.
+class StateReader final
+{
+public: //====================================================//
+
+    StateReader(const StateBuffer& buffer) : mBuffer(buffer) {}
+
+    //--------------------------------------------------------//
+
+    template <class Type>
+    void read(Type& value)
+    {
+        static_assert(std::is_trivially_copyable_v<Type>);
+        read_bytes(&value, sizeof(Type));
+    }
+
+    template <class Type>
+    Type read()
+    {
+        Type value; read(value);
+        return value;
+    }
+
+    /// Read a range into a container that will be resized to fit.
+    template <class Container>
+    void read_range(Container& container)
+    {
+        const uint32_t count = read<uint32_t>();
+        check_remaining(sizeof(*container.data()) * count);
+        container.resize(count);
+        read_bytes(container.data(), sizeof(*container.data()) * count);
+    }
+
+    /// Read a range into a container that should already be the right size.
+    template <class Container>
+    void read_fixed_range(Container& container)
+    {
+        const uint32_t count = read<uint32_t>();
+        if (count != container.size())
+            throw std::runtime_error("state buffer range size mismatch");
+        read_bytes(container.data(), sizeof(*container.data()) * count);
+    }
+
+    void read_bytes(void* dest, size_t count)
+    {
+        check_remaining(count);
+        std::memcpy(dest, mBuffer.data() + mOffset, count);
+        mOffset += count;
+    }
+
+    bool at_end() const { return mOffset == mBuffer.size(); }
+
+    /// Throw if there are less than count bytes left to read.
+    void check_remaining(size_t count) const
+    {
+        if (count > mBuffer.size() - mOffset)
+            throw std::runtime_error("read past end of state buffer");
+    }
+
+private: //===================================================//
+
+    const StateBuffer& mBuffer;
+
+    size_t mOffset = 0u;
+};
+
+//============================================================================//
+
+/// Position of a script fiber within a run of an action or article.
+///
+/// Wren fibers can't be copied, so snapshots store this instead, and
+/// restoring rebuilds the fiber by resuming it from the start again.
+struct ScriptProgress final
+{
+    uint32_t runId = 0u;
+    uint currentFrame = 0u;
+    uint waitUntil = 0u;
+};
+
+//============================================================================//
+
+} // namespace sts
@@ -1,5 +1,7 @@
 #include "game/VisualEffect.hpp"
 
+#include "game/DefCache.hpp"
+
 #include <sqee/maths/Functions.hpp>
 #include <sqee/misc/Json.hpp>
 
@@ -28,7 +30,7 @@ void EffectAsset::load_from_directory(const String& path, ResourceCaches& caches
 
 //============================================================================//
 
-void VisualEffectDef::from_json(JsonObject json, const sq::Armature& armature, EffectCache& cache)
+void VisualEffectDef::from_json(JsonObject json, const sq::Armature& armature, EffectCache* cache)
 {
     path = json["path"].as_auto();
 
@@ -41,7 +43,8 @@ void VisualEffectDef::from_json(JsonObject json, const sq::Armature& armature, E
     attached = json["attached"].as_auto();
     transient = json["transient"].as_auto();
 
-    handle = cache.acquire(path);
+    if (cache != nullptr)
+        handle = cache->acquire(path);
 
     localMatrix = maths::transform(origin, rotation, scale);
 }
@@ -64,6 +67,38 @@ void VisualEffectDef::to_json(JsonMutObject json, const sq::Armature& armature)
 
 //============================================================================//
 
+void VisualEffectDef::to_binary(StateBuffer& buffer) const
+{
+    DefCache::write_string(buffer, path);
+
+    buffer.write(origin);
+    buffer.write(rotation);
+    buffer.write(scale);
+
+    buffer.write(bone);
+
+    buffer.write(attached);
+    buffer.write(transient);
+}
+
+void VisualEffectDef::from_binary(StateReader& reader)
+{
+    DefCache::read_string(reader, path);
+
+    reader.read(origin);
+    reader.read(rotation);
+    reader.read(scale);
+
+    reader.read(bone);
+
+    reader.read(attached);
+    reader.read(transient);
+
+    localMatrix = maths::transform(origin, rotation, scale);
+}
+
+//============================================================================//
+
 DISABLE_WARNING_FLOAT_EQUALITY()
 
 bool VisualEffectDef::operator==(const VisualEffectDef& other) const
@@ -59,10 +59,16 @@ struct VisualEffectDef final
         return *std::prev(reinterpret_cast<const TinyString*>(this));
     }
 
-    void from_json(JsonObject json, const sq::Armature& armature, EffectCache& cache);
+    /// Load from json, acquiring the asset if a cache is given.
+    void from_json(JsonObject json, const sq::Armature& armature, EffectCache* cache);
 
     void to_json(JsonMutObject json, const sq::Armature& armature) const;
 
+    /// Write to a DefCache buffer, bones are stored as indices.
+    void to_binary(StateBuffer& buffer) const;
+
+    void from_binary(StateReader& reader);
+
     bool operator==(const VisualEffectDef& other) const;
 };
 
@@ -1,22 +1,25 @@
 #include "game/World.hpp"
 
 #include "game/Article.hpp"
+#include "game/CollisionSystem.hpp"
 #include "game/Controller.hpp"
 #include "game/EffectSystem.hpp"
 #include "game/Fighter.hpp"
 #include "game/FighterAction.hpp"
 #include "game/FighterState.hpp"
-#include "game/HitBlob.hpp"
-#include "game/HurtBlob.hpp"
 #include "game/ParticleSystem.hpp"
 #include "game/Physics.hpp"
+#include "game/ScriptProfiler.hpp"
 #include "game/Stage.hpp"
+#include "game/WrenHeap.hpp"
 
-#include <sqee/maths/Culling.hpp>
+#include "main/AllocationCounter.hpp"
+#include "main/Options.hpp"
+#include "main/Tracing.hpp"
 
-using namespace sts;
+#include <chrono>
 
-// todo: move collision stuff to a separate CollisionSystem class
+using namespace sts;
 
 //============================================================================//
 
@@ -42,13 +45,27 @@ WRENPLUS_BASE_CLASS_DEFINITION(sts::Entity, sts::Article, sts::Fighter)
 //============================================================================//
 
 World::World(const Options& options, sq::AudioContext& audio, ResourceCaches& caches, Renderer& renderer)
+    : World(options, &audio, &caches, &renderer) {}
+
+World::World(const Options& options)
+    : World(options, nullptr, nullptr, nullptr) {}
+
+World::World(const Options& options, sq::AudioContext* audio, ResourceCaches* caches, Renderer* renderer)
     : options(options), audio(audio), caches(caches), renderer(renderer)
 {
-    mEffectSystem = std::make_unique<EffectSystem>(renderer);
+    mCollisionSystem = std::make_unique<CollisionSystem>(*this);
+    mEffectSystem = std::make_unique<EffectSystem>(*this);
     mParticleSystem = std::make_unique<ParticleSystem>(*this);
+    mScriptProfiler = std::make_unique<ScriptProfiler>(*this);
+
+    wrenPool.install(vm);
 
     vm.set_module_import_dirs({"wren", "assets"});
 
+    // a collection in the middle of a tick is much worse than one between ticks
+    if (options.wren_heap_budget != 0u)
+        WrenHeap::raise_collection_threshold(vm, size_t(options.wren_heap_budget) * 2u * 1024u * 1024u);
+
     //--------------------------------------------------------//
 
     // Vec2I
@@ -142,6 +159,12 @@ World::World(const Options& options, sq::AudioContext& audio, ResourceCaches& ca
     WRENPLUS_ADD_METHOD(vm, Fighter, wren_set_next_animation, "set_next_animation(_,_)");
     WRENPLUS_ADD_METHOD(vm, Article, wren_play_sound, "play_sound(_,_)");
     WRENPLUS_ADD_METHOD(vm, Fighter, wren_play_sound, "play_sound(_,_)");
+    WRENPLUS_ADD_METHOD(vm, Article, wren_play_animation_id, "play_animation_id(_,_,_)");
+    WRENPLUS_ADD_METHOD(vm, Fighter, wren_play_animation_id, "play_animation_id(_,_,_)");
+    WRENPLUS_ADD_METHOD(vm, Article, wren_set_next_animation_id, "set_next_animation_id(_,_)");
+    WRENPLUS_ADD_METHOD(vm, Fighter, wren_set_next_animation_id, "set_next_animation_id(_,_)");
+    WRENPLUS_ADD_METHOD(vm, Article, wren_play_sound_id, "play_sound_id(_,_)");
+    WRENPLUS_ADD_METHOD(vm, Fighter, wren_play_sound_id, "play_sound_id(_,_)");
 
     //--------------------------------------------------------//
 
@@ -161,8 +184,13 @@ World::World(const Options& options, sq::AudioContext& audio, ResourceCaches& ca
     WRENPLUS_ADD_METHOD(vm, Article, wren_cxx_wait_until, "cxx_wait_until(_)");
     WRENPLUS_ADD_METHOD(vm, Article, wren_cxx_wait_for, "cxx_wait_for(_)");
     WRENPLUS_ADD_METHOD(vm, Article, wren_cxx_next_frame, "cxx_next_frame()");
+    WRENPLUS_ADD_METHOD(vm, Article, wren_cxx_no_update, "cxx_no_update()");
+    WRENPLUS_ADD_METHOD(vm, Article, wren_cxx_no_fields, "cxx_no_fields()");
+    WRENPLUS_ADD_METHOD(vm, Article, wren_cxx_before_fast_forward, "cxx_before_fast_forward()");
+    WRENPLUS_ADD_METHOD(vm, Article, wren_cxx_fast_forward, "cxx_fast_forward(_)");
     WRENPLUS_ADD_METHOD(vm, Article, wren_mark_for_destroy, "mark_for_destroy()");
     WRENPLUS_ADD_METHOD(vm, Article, wren_enable_hitblobs, "enable_hitblobs(_)");
+    WRENPLUS_ADD_METHOD(vm, Article, wren_enable_hitblobs_id, "enable_hitblobs_id(_)");
     WRENPLUS_ADD_METHOD(vm, Article, wren_disable_hitblobs, "disable_hitblobs(_)");
     WRENPLUS_ADD_METHOD(vm, Article, wren_play_effect, "play_effect(_)");
     WRENPLUS_ADD_METHOD(vm, Article, wren_emit_particles, "emit_particles(_)");
@@ -226,6 +254,8 @@ World::World(const Options& options, sq::AudioContext& audio, ResourceCaches& ca
     WRENPLUS_ADD_METHOD(vm, Fighter, wren_cxx_assign_action, "cxx_assign_action(_)");
     WRENPLUS_ADD_METHOD(vm, Fighter, wren_cxx_assign_action_null, "cxx_assign_action_null()");
     WRENPLUS_ADD_METHOD(vm, Fighter, wren_cxx_assign_state, "cxx_assign_state(_)");
+    WRENPLUS_ADD_METHOD(vm, Fighter, wren_cxx_assign_action_id, "cxx_assign_action_id(_)");
+    WRENPLUS_ADD_METHOD(vm, Fighter, wren_cxx_assign_state_id, "cxx_assign_state_id(_)");
     WRENPLUS_ADD_METHOD(vm, Fighter, wren_cxx_spawn_article, "cxx_spawn_article(_)");
     WRENPLUS_ADD_METHOD(vm, Fighter, wren_attempt_ledge_catch, "attempt_ledge_catch()");
     WRENPLUS_ADD_METHOD(vm, Fighter, wren_enable_hurtblob, "enable_hurtblob(_)");
@@ -249,8 +279,17 @@ World::World(const Options& options, sq::AudioContext& audio, ResourceCaches& ca
     WRENPLUS_ADD_METHOD(vm, FighterAction, wren_cxx_wait_until, "cxx_wait_until(_)");
     WRENPLUS_ADD_METHOD(vm, FighterAction, wren_cxx_wait_for, "cxx_wait_for(_)");
     WRENPLUS_ADD_METHOD(vm, FighterAction, wren_cxx_next_frame, "cxx_next_frame()");
+    WRENPLUS_ADD_METHOD(vm, FighterAction, wren_cxx_no_update, "cxx_no_update()");
+    WRENPLUS_ADD_METHOD(vm, FighterAction, wren_cxx_no_fields, "cxx_no_fields()");
+    WRENPLUS_ADD_METHOD(vm, FighterAction, wren_cxx_fast_forward, "cxx_fast_forward(_)");
     WRENPLUS_ADD_METHOD(vm, FighterAction, wren_cxx_before_cancel, "cxx_before_cancel()");
+    WRENPLUS_ADD_METHOD(vm, FighterAction, wren_cxx_is_native, "cxx_is_native");
+    WRENPLUS_ADD_METHOD(vm, FighterAction, wren_cxx_native_state, "cxx_native_state");
+    WRENPLUS_ADD_METHOD(vm, FighterAction, wren_cxx_native_frame, "cxx_native_frame()");
+    WRENPLUS_ADD_METHOD(vm, FighterAction, wren_cxx_native_result, "cxx_native_result");
+    WRENPLUS_ADD_METHOD(vm, FighterAction, wren_cxx_native_cancel, "cxx_native_cancel()");
     WRENPLUS_ADD_METHOD(vm, FighterAction, wren_enable_hitblobs, "enable_hitblobs(_)");
+    WRENPLUS_ADD_METHOD(vm, FighterAction, wren_enable_hitblobs_id, "enable_hitblobs_id(_)");
     WRENPLUS_ADD_METHOD(vm, FighterAction, wren_disable_hitblobs, "disable_hitblobs(_)");
     WRENPLUS_ADD_METHOD(vm, FighterAction, wren_play_effect, "play_effect(_)");
     WRENPLUS_ADD_METHOD(vm, FighterAction, wren_emit_particles, "emit_particles(_)");
@@ -269,6 +308,7 @@ World::World(const Options& options, sq::AudioContext& audio, ResourceCaches& ca
     WRENPLUS_ADD_METHOD(vm, FighterState, wren_log_with_prefix, "log_with_prefix(_)");
     WRENPLUS_ADD_METHOD(vm, FighterState, wren_cxx_before_enter, "cxx_before_enter()");
     WRENPLUS_ADD_METHOD(vm, FighterState, wren_cxx_before_exit, "cxx_before_exit()");
+    WRENPLUS_ADD_METHOD(vm, FighterState, wren_cxx_no_fields, "cxx_no_fields()");
 
     vm.load_module("FighterState");
     vm.cache_handles<FighterState>();
@@ -300,6 +340,7 @@ World::World(const Options& options, sq::AudioContext& audio, ResourceCaches& ca
     WRENPLUS_ADD_METHOD(vm, World, wren_random_float, "random_float(_,_)");
     WRENPLUS_ADD_METHOD(vm, World, wren_cancel_sound, "cancel_sound(_)");
     WRENPLUS_ADD_METHOD(vm, World, wren_cancel_effect, "cancel_effect(_)");
+    WRENPLUS_ADD_METHOD(vm, World, wren_key_id, "key_id(_)");
 
     vm.load_module("World");
     vm.cache_handles<World>();
@@ -310,14 +351,23 @@ World::World(const Options& options, sq::AudioContext& audio, ResourceCaches& ca
 
     handles.action_do_start = wrenMakeCallHandle(vm, "do_start()");
     handles.action_do_updates = wrenMakeCallHandle(vm, "do_updates()");
+    handles.action_do_update = wrenMakeCallHandle(vm, "do_update()");
     handles.action_do_cancel = wrenMakeCallHandle(vm, "do_cancel()");
+    handles.action_do_native_finish = wrenMakeCallHandle(vm, "do_native_finish()");
+    handles.action_do_fast_forward = wrenMakeCallHandle(vm, "do_fast_forward(_)");
 
     handles.state_do_enter = wrenMakeCallHandle(vm, "do_enter()");
     handles.state_do_updates = wrenMakeCallHandle(vm, "do_updates()");
     handles.state_do_exit = wrenMakeCallHandle(vm, "do_exit()");
 
     handles.article_do_updates = wrenMakeCallHandle(vm, "do_updates()");
+    handles.article_do_update = wrenMakeCallHandle(vm, "do_update()");
     handles.article_do_destroy = wrenMakeCallHandle(vm, "do_destroy()");
+    handles.article_do_construct = wrenMakeCallHandle(vm, "do_construct()");
+    handles.article_do_fast_forward = wrenMakeCallHandle(vm, "do_fast_forward(_)");
+
+    handles.script_save_fields = wrenMakeCallHandle(vm, "save_fields()");
+    handles.script_load_fields = wrenMakeCallHandle(vm, "load_fields(_)");
 }
 
 //============================================================================//
@@ -328,33 +378,70 @@ World::~World()
 
     wrenReleaseHandle(vm, handles.action_do_start);
     wrenReleaseHandle(vm, handles.action_do_updates);
+    wrenReleaseHandle(vm, handles.action_do_update);
     wrenReleaseHandle(vm, handles.action_do_cancel);
+    wrenReleaseHandle(vm, handles.action_do_native_finish);
+    wrenReleaseHandle(vm, handles.action_do_fast_forward);
 
     wrenReleaseHandle(vm, handles.state_do_enter);
     wrenReleaseHandle(vm, handles.state_do_updates);
     wrenReleaseHandle(vm, handles.state_do_exit);
 
     wrenReleaseHandle(vm, handles.article_do_updates);
+    wrenReleaseHandle(vm, handles.article_do_update);
     wrenReleaseHandle(vm, handles.article_do_destroy);
+    wrenReleaseHandle(vm, handles.article_do_construct);
+    wrenReleaseHandle(vm, handles.article_do_fast_forward);
+
+    wrenReleaseHandle(vm, handles.script_save_fields);
+    wrenReleaseHandle(vm, handles.script_load_fields);
 }
 
 //============================================================================//
 
 void World::tick()
 {
+    STS_TRACE_ZONE("World::tick");
+
+    using Clock = std::chrono::steady_clock;
+
+    // only check the clock when measuring, so that normal ticks cost nothing extra
+    Clock::time_point previous = mMeasureTimings ? Clock::now() : Clock::time_point();
+
+    const auto measure = [&](double& dest)
+    {
+        if (mMeasureTimings == false) return;
+        const Clock::time_point now = Clock::now();
+        dest += std::chrono::duration<double>(now - previous).count();
+        previous = now;
+    };
+
+    mTickTimings = TickTimings();
+
+    const uint64_t wrenAllocations = wrenPool.get_allocation_count();
+    const uint64_t wrenAllocatedBytes = wrenPool.get_allocated_bytes();
+
     mStage->tick();
+    measure(mTickTimings.stage);
 
     for (auto& fighter : get_sorted_fighters())
         fighter->tick();
+    measure(mTickTimings.fighters);
 
     for (auto& article : mArticles)
         article->tick();
+    measure(mTickTimings.articles);
 
-    impl_update_collisions();
+    const size_t allocations = AllocationCounter::count;
+    mCollisionSystem->tick();
+    measure(mTickTimings.collisions);
+    mTickTimings.collisionAllocations = AllocationCounter::count - allocations;
 
     mEffectSystem->tick();
+    measure(mTickTimings.effects);
 
     mParticleSystem->update_and_clean();
+    measure(mTickTimings.particles);
 
     for (auto iter = mArticles.begin(); iter != mArticles.end();)
     {
@@ -362,12 +449,47 @@ void World::tick()
         if (article.check_marked_for_destroy() == false) ++iter;
         else iter = mArticles.erase(iter);
     }
+    measure(mTickTimings.articles);
+
+    mTickTimings.wrenAllocations = wrenPool.get_allocation_count() - wrenAllocations;
+    mTickTimings.wrenAllocatedBytes = wrenPool.get_allocated_bytes() - wrenAllocatedBytes;
+
+    impl_update_checksum();
+}
+
+//============================================================================//
+
+bool World::collect_garbage(bool force)
+{
+    const size_t before = WrenHeap::get_allocated_bytes(vm);
+
+    if (force == false && (options.wren_heap_budget == 0u || before < size_t(options.wren_heap_budget) * 1024u * 1024u))
+        return false;
+
+    STS_TRACE_ZONE("World::collect_garbage");
+
+    const auto start = std::chrono::steady_clock::now();
+    wrenCollectGarbage(vm);
+    const double pause = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    mGarbageStats.collections += 1u;
+    mGarbageStats.lastPause = pause;
+    mGarbageStats.maxPause = maths::max(mGarbageStats.maxPause, pause);
+    mGarbageStats.totalPause += pause;
+    mGarbageStats.lastBefore = before;
+    mGarbageStats.lastAfter = WrenHeap::get_allocated_bytes(vm);
+
+    return true;
 }
 
 //============================================================================//
 
 void World::integrate(float blend)
 {
+    STS_TRACE_ZONE("World::integrate");
+
+    SQASSERT(is_headless() == false, "can't integrate a headless world");
+
     mStage->integrate(blend);
 
     for (auto& fighter : mFighters)
@@ -422,6 +544,17 @@ Article& World::create_article(const ArticleDef& def, Fighter* fighter)
     return *mArticles.emplace_back(std::make_unique<Article>(def, fighter));
 }
 
+Entity* World::find_entity(int32_t eid) const
+{
+    for (const auto& fighter : mFighters)
+        if (fighter->eid == eid) return fighter.get();
+
+    for (const auto& article : mArticles)
+        if (article->eid == eid) return article.get();
+
+    return nullptr;
+}
+
 //============================================================================//
 
 void World::finish_setup()
@@ -452,331 +585,6 @@ void World::finish_setup()
 
 //============================================================================//
 
-void World::impl_update_collisions()
-{
-    //-- update capsules of hurt and hit blobs ---------------//
-
-    for (auto& fighter : mFighters)
-    {
-        for (HurtBlob& blob : fighter->get_hurt_blobs())
-        {
-            const Mat4F matrix = fighter->get_model_matrix(blob.def.bone);
-
-            blob.capsule.originA = Vec3F(matrix * Vec4F(blob.def.originA, 1.f));
-            blob.capsule.originB = Vec3F(matrix * Vec4F(blob.def.originB, 1.f));
-            blob.capsule.radius = blob.def.radius;
-        }
-    }
-
-    const auto update_hit_blob_transforms = [](Entity& entity)
-    {
-        for (HitBlob& blob : entity.get_hit_blobs())
-        {
-            const Mat4F matrix = entity.get_model_matrix(blob.def.bone);
-
-            if (blob.justCreated == true)
-            {
-                blob.capsule.originA = Vec3F(matrix * Vec4F(blob.def.origin, 1.f));
-                blob.capsule.originB = blob.capsule.originA;
-                blob.capsule.radius = blob.def.radius;
-                blob.justCreated = false;
-            }
-            else
-            {
-                blob.capsule.originB = blob.capsule.originA;
-                blob.capsule.originA = Vec3F(matrix * Vec4F(blob.def.origin, 1.f));
-            }
-        }
-    };
-
-    for (auto& fighter : mFighters)
-        update_hit_blob_transforms(*fighter);
-
-    for (auto& article : mArticles)
-        update_hit_blob_transforms(*article);
-
-    //-- find collisions between hit blobs -------------------//
-
-    // max damage of hitblobs causing rebound
-    std::array<float, MAX_FIGHTERS> reboundDamages {};
-
-    for (size_t firstIndex = 0; firstIndex + 1 < mFighters.size(); ++firstIndex)
-    {
-        auto& firstFighter = mFighters[firstIndex];
-        for (HitBlob& firstBlob : firstFighter->get_hit_blobs())
-        {
-            for (size_t secondIndex = firstIndex + 1; secondIndex < mFighters.size(); ++secondIndex)
-            {
-                auto& secondFighter = mFighters[secondIndex];
-                for (HitBlob& secondBlob : secondFighter->get_hit_blobs())
-                {
-                    // blobs do not intersect
-                    if (!maths::intersect_capsule_capsule(firstBlob.capsule, secondBlob.capsule)) continue;
-\
-                    if (firstBlob.def.type == BlobType::Damage)
-                    {
-                        if (secondBlob.def.type != BlobType::Damage) continue;
-
-                        // first or second blob is transcendent
-                        if (firstBlob.def.clangMode == BlobClangMode::Ignore || secondBlob.def.clangMode == BlobClangMode::Ignore) continue;
-
-                        // todo: air attacks can clang with projectiles
-                        if (firstBlob.def.clangMode == BlobClangMode::Air || secondBlob.def.clangMode == BlobClangMode::Air) continue;
-
-                        const float damageDiff = firstBlob.def.damage - secondBlob.def.damage;
-
-                        if (damageDiff < +9.f) firstBlob.cancelled = true;
-                        if (damageDiff > -9.f) secondBlob.cancelled = true;
-
-                        if (damageDiff > -9.f && damageDiff < +9.f)
-                        {
-                            if (firstBlob.def.clangMode == BlobClangMode::Ground)
-                                reboundDamages[firstFighter->index] =
-                                    std::max(reboundDamages[firstFighter->index], firstBlob.def.damage);
-
-                            if (secondBlob.def.clangMode == BlobClangMode::Ground)
-                                reboundDamages[secondFighter->index] =
-                                    std::max(reboundDamages[secondFighter->index], secondBlob.def.damage);
-                        }
-                    }
-
-                    else if (firstBlob.def.type == BlobType::Grab)
-                    {
-                        if (secondBlob.def.type != BlobType::Grab) continue;
-
-                        // grabs can only rebound if both fighters are facing each other
-                        const auto &firstVars = firstFighter->variables, &secondVars = secondFighter->variables;
-                        if (firstVars.position.x < secondVars.position.x && (firstVars.facing == -1 || secondVars.facing == +1)) continue;
-                        if (firstVars.position.x > secondVars.position.x && (firstVars.facing == +1 || secondVars.facing == -1)) continue;
-
-                        // grabs always rebound with the same damage
-                        reboundDamages[firstFighter->index] = std::max(reboundDamages[firstFighter->index], 5.f);
-                        reboundDamages[secondFighter->index] = std::max(reboundDamages[secondFighter->index], 5.f);
-                        firstBlob.cancelled = true;
-                        secondBlob.cancelled = true;
-                    }
-
-                    else SQEE_UNREACHABLE();
-                }
-            }
-        }
-    }
-
-    //-- find collisions between hurt and hit blobs ----------//
-
-    struct HurtCollision { HurtBlob* hurt; HitBlob* hit; };
-
-    using HurtCollisionMap = std::map<Entity*, HurtCollision>;
-    using HurtMapItem = HurtCollisionMap::value_type;
-
-    // best collision for each [fighter][entity] combination
-    std::array<HurtCollisionMap, MAX_FIGHTERS> hurtCollisionMaps;
-
-    for (auto& hurtFighter : mFighters)
-    {
-        const Fighter::Variables& hurtVars = hurtFighter->variables;
-
-        if (hurtVars.intangible) continue;
-
-        for (HurtBlob& hurtBlob : hurtFighter->get_hurt_blobs())
-        {
-            if (hurtBlob.intangible) continue;
-
-            const auto find_hit_blob_collisions = [&](Entity& hitEntity)
-            {
-                // hitEntity has already hit hurtFighter since the last reset
-                if (auto& vec = hitEntity.get_ignore_collisions(); ranges::find(vec, hurtFighter->eid) != vec.end()) return;
-
-                // defer inserting new map entry until there is a collision
-                HurtMapItem* mapItem = nullptr;
-
-                for (HitBlob& hitBlob : hitEntity.get_hit_blobs())
-                {
-                    if (hitBlob.def.type == BlobType::Grab)
-                    {
-                        const Fighter::Variables& hitVars = static_cast<Fighter&>(hitEntity).variables;
-
-                        // fighter is not grabable
-                        if (!hurtVars.grabable) continue;
-
-                        // can only grab fighters in front of you
-                        if (hitVars.facing == -1 && hitVars.position.x < hurtVars.position.x) continue;
-                        if (hitVars.facing == +1 && hitVars.position.x > hurtVars.position.x) continue;
-                    }
-
-                    // hitBlob got cancelled by another hitBlob
-                    if (hitBlob.cancelled) continue;
-
-                    // hitBlob can not hit grounded or airborne fighter
-                    if (!hitBlob.def.canHitGround && hurtVars.onGround) continue;
-                    if (!hitBlob.def.canHitAir && !hurtVars.onGround) continue;
-
-                    // blobs do not intersect
-                    if (!maths::intersect_capsule_capsule(hitBlob.capsule, hurtBlob.capsule)) continue;
-
-                    // already have a collision, check if the new one is better
-                    if (mapItem != nullptr)
-                    {
-                        HurtCollision& best = mapItem->second;
-
-                        // todo: should invincible hurtBlobs have special rules?
-
-                        // same hitBlob, choose hurtBlob with highest priority
-                        if (&hitBlob == best.hit)
-                        {
-                            // lower enum value means higher priority (middle, lower, upper)
-                            if (hurtBlob.def.region >= best.hurt->def.region) continue;
-                        }
-
-                        // choose hitBlob with highest priority
-                        else if (hitBlob.def.index >= best.hit->def.index) continue;
-                    }
-
-                    // first time this frame that hurtFighter was hit by hitEntity
-                    else mapItem = &*hurtCollisionMaps[hurtBlob.fighter.index].try_emplace(&hitEntity).first;
-
-                    mapItem->second = { &hurtBlob, &hitBlob };
-                }
-            };
-
-            for (auto& hitFighter : mFighters)
-                if (hitFighter != hurtFighter)
-                    find_hit_blob_collisions(*hitFighter);
-
-            for (auto& hitArticle : mArticles)
-                if (hitArticle->fighter != hurtFighter.get())
-                    find_hit_blob_collisions(*hitArticle);
-        }
-    }
-
-    //-- apply hits and build lists of possible grabs --------//
-
-    // whether each fighter got hit by any attacks
-    std::array<bool, MAX_FIGHTERS> hitByAttack {};
-
-    // list of potential grab victims for each fighter
-    std::array<StackVector<Fighter*, MAX_FIGHTERS-1>, MAX_FIGHTERS> possibleGrabs;
-
-    for (auto& hurtFighter : mFighters)
-    {
-        if (hurtCollisionMaps[hurtFighter->index].empty() == false)
-        {
-            for (const auto& [hitEntity, collision] : hurtCollisionMaps[hurtFighter->index])
-            {
-                if (collision.hit->def.type == BlobType::Damage)
-                {
-                    // note that the order that hits accumulate does not matter
-                    if (hurtFighter->accumulate_hit(*collision.hit, *collision.hurt))
-                        hitByAttack[hurtFighter->index] = true;
-
-                    hitEntity->get_ignore_collisions().push_back(hurtFighter->eid);
-                }
-                else if (collision.hit->def.type == BlobType::Grab)
-                {
-                    Fighter* hitFighter = dynamic_cast<Fighter*>(hitEntity);
-                    SQASSERT(hitFighter != nullptr, "non-fighter hitblob can't be a grab");
-
-                    // todo: check the stage for a wall between the fighters
-                    possibleGrabs[hitFighter->index].push_back(hurtFighter.get());
-                }
-                else SQEE_UNREACHABLE();
-            }
-
-            if (hitByAttack[hurtFighter->index] == true)
-            {
-                // change action and state after one or more hits are accumlated
-                hurtFighter->apply_hits();
-
-                // getting hit by an attack prevents grabbing and rebounding
-                possibleGrabs[hurtFighter->index].clear();
-                reboundDamages[hurtFighter->index] = 0.f;
-            }
-        }
-    }
-
-    //-- find the closest possible grab for each fighter -----//
-
-    std::array<Fighter*, MAX_FIGHTERS> closestGrabs {};
-
-    for (auto& fighter : mFighters)
-    {
-        // can only grab fighters that weren't hit by an attack
-        sq::erase_if(possibleGrabs[fighter->index], [&](Fighter* victim) { return hitByAttack[victim->index]; });
-
-        if (possibleGrabs[fighter->index].empty() == false)
-        {
-            // technically port priority if two fighters are somehow EXACTLY the same distance away
-            closestGrabs[fighter->index] = *ranges::min_element (
-                possibleGrabs[fighter->index], {},
-                [&](Fighter* victim) { return maths::distance_squared(fighter->variables.position, victim->variables.position); }
-            );
-        }
-    }
-
-    //-- confirm all non-circular grabs and apply them -------//
-
-    if (ranges::any_of(closestGrabs, std::identity())) // at least one non-nullptr
-    {
-        // will randomise winners of any contested grabs
-        StackVector<Fighter*, MAX_FIGHTERS> shuffled;
-        for (auto& fighter : mFighters) shuffled.push_back(fighter.get());
-        ranges::shuffle(shuffled, mRandNumGen);
-
-        std::array<bool, MAX_FIGHTERS> confirmedGrabs {};
-
-        while (true)
-        {
-            bool confirmedSome = false;
-
-            for (auto& fighter : shuffled)
-            {
-                if (auto& victim = closestGrabs[fighter->index])
-                {
-                    // nobody else is trying to grab us
-                    if (ranges::find(closestGrabs, fighter) == closestGrabs.end())
-                    {
-                        // prevent anyone else from grabbing our victim
-                        for (auto& otherVictim : closestGrabs)
-                            if (&otherVictim != &victim && otherVictim == victim)
-                                otherVictim = nullptr;
-
-                        // prevent our victim from grabbing anyone else
-                        closestGrabs[victim->index] = nullptr;
-
-                        confirmedSome = confirmedGrabs[fighter->index] = true;
-                    }
-                }
-            }
-
-            // all possible grabs have been confirmed
-            if (ranges::equal(closestGrabs, confirmedGrabs, [](Fighter* lhs, bool rhs) { return bool(lhs) == rhs; })) break;
-
-            // failed to confirm any grabs, the rest are circular
-            if (confirmedSome == false) break;
-        }
-
-        for (auto& fighter : mFighters)
-        {
-            if (auto& victim = closestGrabs[fighter->index])
-            {
-                if (confirmedGrabs[fighter->index] == true)
-                    fighter->apply_grab(*victim);
-
-                // our grab was prevented due to circular grabs
-                else reboundDamages[fighter->index] = 5.f;
-            }
-        }
-    }
-
-    //-- apply rebounds --------------------------------------//
-
-    for (auto& fighter : mFighters)
-        if (reboundDamages[fighter->index] != 0.f)
-            fighter->apply_rebound(reboundDamages[fighter->index]);
-}
-
-//============================================================================//
-
 MinMax<Vec2F> World::compute_fighter_bounds() const
 {
     MinMax<Vec2F> result;
@@ -2,6 +2,9 @@
 
 #include "setup.hpp"
 
+#include "game/KeyTable.hpp"
+#include "game/WrenPool.hpp"
+
 #include "main/Resources.hpp"
 
 #include <sqee/app/WrenPlus.hpp>
@@ -16,8 +19,12 @@ class World final
 {
 public: //====================================================//
 
+    /// Create a world with audio, resources and rendering.
     World(const Options& options, sq::AudioContext& audio, ResourceCaches& caches, Renderer& renderer);
 
+    /// Create a headless world, for simulation without a window.
+    World(const Options& options);
+
     SQEE_COPY_DELETE(World)
     SQEE_MOVE_DELETE(World)
 
@@ -27,11 +34,19 @@ public: //====================================================//
 
     const Options& options;
 
-    sq::AudioContext& audio;
+    // these will all be null for a headless world
+    sq::AudioContext* const audio;
+    ResourceCaches* const caches;
+    Renderer* const renderer;
+
+    /// Check if the world has no audio, resources, or renderer.
+    bool is_headless() const { return renderer == nullptr; }
 
-    ResourceCaches& caches;
+    /// Set while ticks are simulated again after a rollback, except for the last one.
+    void set_resimulating(bool resimulating) { mResimulating = resimulating; }
 
-    Renderer& renderer;
+    /// Check if the current tick will never be rendered, true for headless worlds.
+    bool is_unrendered_tick() const { return renderer == nullptr || mResimulating == true; }
 
     //--------------------------------------------------------//
 
@@ -46,18 +61,34 @@ public: //====================================================//
 
     //--------------------------------------------------------//
 
+    /// Ids of action, state, animation, sound, and hitblob keys.
+    KeyTable keys;
+
+    //--------------------------------------------------------//
+
+    /// Memory used by vm, so must be declared before it.
+    WrenPool wrenPool;
+
     wren::WrenPlusVM vm;
 
     struct {
         WrenHandle* new_1 = nullptr;
         WrenHandle* action_do_start = nullptr;
         WrenHandle* action_do_updates = nullptr;
+        WrenHandle* action_do_update = nullptr;
         WrenHandle* action_do_cancel = nullptr;
+        WrenHandle* action_do_native_finish = nullptr;
+        WrenHandle* action_do_fast_forward = nullptr;
         WrenHandle* state_do_enter = nullptr;
         WrenHandle* state_do_updates = nullptr;
         WrenHandle* state_do_exit = nullptr;
         WrenHandle* article_do_updates = nullptr;
+        WrenHandle* article_do_update = nullptr;
         WrenHandle* article_do_destroy = nullptr;
+        WrenHandle* article_do_construct = nullptr;
+        WrenHandle* article_do_fast_forward = nullptr;
+        WrenHandle* script_save_fields = nullptr;
+        WrenHandle* script_load_fields = nullptr;
     } handles;
 
     //--------------------------------------------------------//
@@ -68,9 +99,37 @@ public: //====================================================//
 
     //--------------------------------------------------------//
 
+    /// Write everything that affects the next tick to a buffer.
+    ///
+    /// Not const, because scripts get called to save their fields.
+    void save_state(StateBuffer& buffer);
+
+    /// Restore a buffer written by save_state, so that ticks repeat exactly.
+    void load_state(const StateBuffer& buffer);
+
+    /// Check if load_state is currently rebuilding script fibers.
+    bool is_restoring_state() const { return mRestoringState; }
+
+    /// Rolling hash of gameplay state, updated at the end of every tick.
+    ///
+    /// Each value includes the previous one, so once two worlds have diverged,
+    /// their checksums will never match again.
+    uint64_t get_checksum() const { return mChecksum; }
+
+    /// Format every value that goes into the checksum, one per line.
+    String dump_checksum_fields() const;
+
+    //--------------------------------------------------------//
+
     /// Generate a new entity id.
     int32_t generate_entity_id() { return ++mEntityId; }
 
+    /// Generate an id for one run of an action or article script.
+    uint32_t generate_script_run_id() { return ++mScriptRunId; }
+
+    /// Find a fighter or article by entity id.
+    Entity* find_entity(int32_t eid) const;
+
     /// Set the stage for the game.
     Stage& create_stage(TinyString name);
 
@@ -118,6 +177,62 @@ public: //====================================================//
     /// Access the ParticleSystem.
     ParticleSystem& get_particle_system() { return *mParticleSystem; }
 
+    /// Access the CollisionSystem.
+    CollisionSystem& get_collision_system() { return *mCollisionSystem; }
+
+    /// Access the ScriptProfiler.
+    ScriptProfiler& get_script_profiler() { return *mScriptProfiler; }
+
+    //--------------------------------------------------------//
+
+    /// Time taken by each part of a tick, in seconds.
+    struct TickTimings
+    {
+        double stage = 0.0;
+        double fighters = 0.0;
+        double articles = 0.0;
+        double collisions = 0.0;
+        double effects = 0.0;
+        double particles = 0.0;
+
+        /// Heap allocations done by the collision pass, if counting is enabled.
+        size_t collisionAllocations = 0u;
+
+        /// Allocations made by the wren vm during the tick, always counted.
+        uint64_t wrenAllocations = 0u;
+        uint64_t wrenAllocatedBytes = 0u;
+    };
+
+    /// Garbage collections done by collect_garbage, times are in seconds.
+    struct GarbageStats
+    {
+        uint32_t collections = 0u;
+
+        double lastPause = 0.0;
+        double maxPause = 0.0;
+        double totalPause = 0.0;
+
+        /// Heap size before and after the last collection.
+        size_t lastBefore = 0u;
+        size_t lastAfter = 0u;
+    };
+
+    /// Collect wren garbage if the heap is over Options::wren_heap_budget, or if forced.
+    ///
+    /// Call after tick, at a point where a pause won't delay anything. Returns
+    /// true if a collection was done.
+    bool collect_garbage(bool force = false);
+
+    const GarbageStats& get_garbage_stats() const { return mGarbageStats; }
+
+    //--------------------------------------------------------//
+
+    /// Enable or disable measuring tick timings, off by default.
+    void set_measure_timings(bool enable) { mMeasureTimings = enable; }
+
+    /// Timings of the most recent tick, if measuring is enabled.
+    const TickTimings& get_tick_timings() const { return mTickTimings; }
+
     //-- wren methods ----------------------------------------//
 
     double wren_random_int(int min, int max);
@@ -128,16 +243,29 @@ public: //====================================================//
 
     void wren_cancel_effect(int32_t id);
 
+    uint16_t wren_key_id(StringView key);
+
 private: //===================================================//
 
-    void impl_update_collisions();
+    World(const Options& options, sq::AudioContext* audio, ResourceCaches* caches, Renderer* renderer);
+
+    void impl_update_checksum();
+
+    uint64_t impl_hash_rng_state() const;
+
+    template <class Visitor>
+    void impl_visit_checksum_fields(Visitor& visitor) const;
 
     //--------------------------------------------------------//
 
+    std::unique_ptr<CollisionSystem> mCollisionSystem;
+
     std::unique_ptr<EffectSystem> mEffectSystem;
 
     std::unique_ptr<ParticleSystem> mParticleSystem;
 
+    std::unique_ptr<ScriptProfiler> mScriptProfiler;
+
     std::unique_ptr<Stage> mStage;
 
     StackVector<std::unique_ptr<Fighter>, MAX_FIGHTERS> mFighters;
@@ -152,9 +280,28 @@ private: //===================================================//
 
     int32_t mEntityId = -1;
 
+    // not part of snapshots, so that run ids are never reused
+    uint32_t mScriptRunId = 0u;
+
+    bool mRestoringState = false;
+
+    bool mResimulating = false;
+
+    uint64_t mChecksum = 0u;
+
+    bool mMeasureTimings = false;
+
+    TickTimings mTickTimings;
+
+    GarbageStats mGarbageStats;
+
     // at the end of the structure, because it's huge
     std::mt19937 mRandNumGen;
 
+    // copy of the rng when its state was last hashed, since hashing it is slow
+    mutable std::mt19937 mHashedRandNumGen;
+    mutable std::optional<uint64_t> mRandNumGenHash;
+
     friend EditorScene;
 };
 
@@ -0,0 +1,32 @@
+#include "game/WrenHeap.hpp"
+
+#include <wren_vm.h>
+
+using namespace sts;
+
+//============================================================================//
+
+size_t WrenHeap::get_allocated_bytes(WrenVM* vm)
+{
+    return vm->bytesAllocated;
+}
+
+size_t WrenHeap::get_next_collection(WrenVM* vm)
+{
+    return vm->nextGC;
+}
+
+void WrenHeap::raise_collection_threshold(WrenVM* vm, size_t size)
+{
+    // wrenCollectGarbage reads these to choose the next threshold
+    vm->config.minHeapSize = size;
+    vm->config.heapGrowthPercent = 100;
+
+    vm->nextGC = std::max(vm->nextGC, size);
+}
+
+WrenReallocateFn WrenHeap::replace_allocator(WrenVM* vm, WrenReallocateFn fn)
+{
+    // read for every allocation, not only when the vm is created
+    return std::exchange(vm->config.reallocateFn, fn);
+}
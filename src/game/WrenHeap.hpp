@@ -0,0 +1,39 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include <sqee/app/WrenPlus.hpp>
+
+namespace sts {
+
+//============================================================================//
+
+/// Parts of the wren vm's heap that its public api doesn't expose.
+///
+/// These read and write fields of WrenVM directly, so they are only valid
+/// for the version of wren that sqee was built with. Only WrenHeap.cpp
+/// includes wren's private headers.
+namespace WrenHeap {
+
+/// Bytes wren counts as allocated, set to the size of live objects by each collection.
+size_t get_allocated_bytes(WrenVM* vm);
+
+/// Value of get_allocated_bytes that will cause the next collection.
+size_t get_next_collection(WrenVM* vm);
+
+/// Stop the vm from collecting by itself until get_allocated_bytes reaches size.
+///
+/// After each collection the threshold doubles the live size, but never goes
+/// back below size.
+void raise_collection_threshold(WrenVM* vm, size_t size);
+
+/// Make the vm use a different allocator, returning the one it used before.
+///
+/// Blocks allocated before this will still be passed to the new allocator.
+WrenReallocateFn replace_allocator(WrenVM* vm, WrenReallocateFn fn);
+
+} // namespace WrenHeap
+
+//============================================================================//
+
+} // namespace sts
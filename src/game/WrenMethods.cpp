@@ -12,6 +12,7 @@
 #include "game/Emitter.hpp"
 #include "game/HitBlob.hpp"
 #include "game/HurtBlob.hpp"
+#include "game/NativeAction.hpp"
 #include "game/ParticleSystem.hpp"
 #include "game/SoundEffect.hpp"
 #include "game/VisualEffect.hpp"
@@ -84,49 +85,92 @@ void Entity::wren_reset_collisions()
 
 void Entity::wren_play_animation(SmallString key, uint fade, bool fromStart)
 {
-    const EntityDef& def = get_def();
+    const auto iter = get_def().animations.find(key);
+    const Animation* animation = iter != get_def().animations.end() ? &iter->second : nullptr;
 
-    const auto iter = def.animations.find(key);
-    if (iter == def.animations.end())
+    impl_wren_play_animation(animation, key, fade, fromStart);
+}
+
+void Entity::wren_set_next_animation(SmallString key, uint fade)
+{
+    const auto iter = get_def().animations.find(key);
+    const Animation* animation = iter != get_def().animations.end() ? &iter->second : nullptr;
+
+    impl_wren_set_next_animation(animation, key, fade);
+}
+
+int32_t Entity::wren_play_sound(SmallString key, bool stopWithAction)
+{
+    const auto iter = get_def().sounds.find(key);
+    const SoundEffect* sound = iter != get_def().sounds.end() ? &iter->second : nullptr;
+
+    return impl_wren_play_sound(sound, key, stopWithAction);
+}
+
+void Entity::wren_play_animation_id(uint16_t id, uint fade, bool fromStart)
+{
+    impl_wren_play_animation(get_def().find_animation(id), world.keys.get_key(id), fade, fromStart);
+}
+
+void Entity::wren_set_next_animation_id(uint16_t id, uint fade)
+{
+    impl_wren_set_next_animation(get_def().find_animation(id), world.keys.get_key(id), fade);
+}
+
+int32_t Entity::wren_play_sound_id(uint16_t id, bool stopWithAction)
+{
+    return impl_wren_play_sound(get_def().find_sound(id), world.keys.get_key(id), stopWithAction);
+}
+
+//----------------------------------------------------------------------------//
+
+void Entity::impl_wren_play_animation(const Animation* animation, StringView key, uint fade, bool fromStart)
+{
+    // animation state will be overwritten when the snapshot is loaded
+    if (world.is_restoring_state() == true)
+        return;
+
+    if (animation == nullptr)
         throw wren::Exception("invalid animation '{}'", key);
 
-    if (fromStart == false && iter->second.anim.frameCount <= mAnimPlayer.animTime)
-        throw wren::Exception("current frame is {}, but animation only has {}", mAnimPlayer.animTime, iter->second.anim.frameCount);
+    if (fromStart == false && animation->anim.frameCount <= mAnimPlayer.animTime)
+        throw wren::Exception("current frame is {}, but animation only has {}", mAnimPlayer.animTime, animation->anim.frameCount);
 
-    play_animation(iter->second, fade, fromStart);
+    play_animation(*animation, fade, fromStart);
 }
 
-void Entity::wren_set_next_animation(SmallString key, uint fade)
+void Entity::impl_wren_set_next_animation(const Animation* animation, StringView key, uint fade)
 {
-    const EntityDef& def = get_def();
+    if (world.is_restoring_state() == true)
+        return;
 
-    const auto iter = def.animations.find(key);
-    if (iter == def.animations.end())
+    if (animation == nullptr)
         throw wren::Exception("invalid animation '{}'", key);
 
     if (mAnimPlayer.animation != nullptr && (mAnimPlayer.animation->manual == true || mAnimPlayer.animation->loop == true))
         throw wren::Exception("already playing a loop animation, '{}'", mAnimPlayer.animation->get_key());
 
-    if (mAnimPlayer.animation == &iter->second)
+    if (mAnimPlayer.animation == animation)
         throw wren::Exception("specified animation already playing");
 
-    set_next_animation(iter->second, fade);
+    set_next_animation(*animation, fade);
 }
 
-int32_t Entity::wren_play_sound(SmallString key, bool stopWithAction)
+int32_t Entity::impl_wren_play_sound(const SoundEffect* sound, StringView key, bool stopWithAction)
 {
-    const EntityDef& def = get_def();
-
-    const auto iter = def.sounds.find(key);
-    if (iter == def.sounds.end())
+    if (sound == nullptr)
         throw wren::Exception("invalid sound '{}'", key);
 
-    const SoundEffect& sound = iter->second;
+    // headless worlds don't load sounds, so the id will be invalid
+    int32_t id = -1;
 
-    if (sound.handle.good() == false)
-        throw wren::Exception("could not load sound '{}'", sound.get_key());
+    if (world.audio != nullptr && world.is_restoring_state() == false)
+    {
+        if (sound->handle.good() == false)
+            throw wren::Exception("could not load sound '{}'", sound->get_key());
 
-    int32_t id = world.audio.play_sound(sound.handle.value(), sq::SoundGroup::Sfx, sound.volume, false);
+        id = world.audio->play_sound(sound->handle.value(), sq::SoundGroup::Sfx, sound->volume, false);
+    }
 
     if (stopWithAction == true)
     {
@@ -161,6 +205,35 @@ void Entity::impl_wren_enable_hitblobs(const std::map<TinyString, HitBlobDef>& b
         throw wren::Exception("no hitblobs matching '{}*'", prefix);
 }
 
+void Entity::impl_wren_enable_hitblobs_id(const std::map<TinyString, HitBlobDef>& blobs, std::vector<std::vector<const HitBlobDef*>>& groups, uint16_t id)
+{
+    // the editor modifies blobs, so groups could be out of date
+    if (world.editor != nullptr)
+        return impl_wren_enable_hitblobs(blobs, world.keys.get_key(id));
+
+    if (id >= world.keys.size())
+        throw wren::Exception("invalid key id {}", id);
+
+    if (id >= groups.size())
+        groups.resize(id + 1u);
+
+    // a group is never empty once filled, since that would be an error
+    if (groups[id].empty() == true)
+    {
+        const StringView prefix = world.keys.get_key(id);
+
+        for (auto& [key, def] : blobs)
+            if (key.starts_with(prefix) == true)
+                groups[id].push_back(&def);
+
+        if (groups[id].empty() == true)
+            throw wren::Exception("no hitblobs matching '{}*'", prefix);
+    }
+
+    for (const HitBlobDef* def : groups[id])
+        mHitBlobs.emplace_back(*def, this);
+}
+
 int32_t Entity::impl_wren_play_effect(const std::map<TinyString, VisualEffectDef>& effects, TinyString key)
 {
     const auto iter = effects.find(key);
@@ -169,6 +242,10 @@ int32_t Entity::impl_wren_play_effect(const std::map<TinyString, VisualEffectDef
 
     const VisualEffectDef& effect = iter->second;
 
+    // effects are purely visual, so headless worlds don't need them
+    if (world.is_headless() == true || world.is_restoring_state() == true)
+        return -1;
+
     if (effect.handle.good() == false)
         throw wren::Exception("could not load effect '{}'", effect.get_key());
 
@@ -191,6 +268,10 @@ int32_t Entity::impl_wren_play_effect(const std::map<TinyString, VisualEffectDef
 
 void Entity::impl_wren_emit_particles(const std::map<TinyString, Emitter>& emitters, TinyString key)
 {
+    // particles will be overwritten when the snapshot is loaded
+    if (world.is_restoring_state() == true)
+        return;
+
     const auto iter = emitters.find(key);
     if (iter == emitters.end())
         throw wren::Exception("invalid emitter '{}'", key);
@@ -229,6 +310,27 @@ bool Article::wren_cxx_next_frame()
     return ++mCurrentFrame > mWaitUntil;
 }
 
+void Article::wren_cxx_before_fast_forward()
+{
+    mCurrentFrame = mWaitUntil = 0u;
+
+    // don't need to set to null because do_fast_forward will assign a new fiber anyway
+    if (mFiberHandle) wrenReleaseHandle(world.vm, mFiberHandle);
+}
+
+bool Article::wren_cxx_fast_forward(uint frame)
+{
+    // skip to the next frame that would resume the fiber
+    if (mWaitUntil + 1u > frame)
+    {
+        mCurrentFrame = frame;
+        return false;
+    }
+
+    mCurrentFrame = mWaitUntil + 1u;
+    return true;
+}
+
 //----------------------------------------------------------------------------//
 
 void Article::wren_enable_hitblobs(StringView prefix)
@@ -236,6 +338,11 @@ void Article::wren_enable_hitblobs(StringView prefix)
     impl_wren_enable_hitblobs(def.blobs, prefix);
 }
 
+void Article::wren_enable_hitblobs_id(uint16_t id)
+{
+    impl_wren_enable_hitblobs_id(def.blobs, def.blobGroups, id);
+}
+
 void Article::wren_disable_hitblobs(bool resetCollisions)
 {
     mHitBlobs.clear();
@@ -282,6 +389,26 @@ void Fighter::wren_cxx_assign_state(TinyString key)
     activeState = &iter->second;
 }
 
+void Fighter::wren_cxx_assign_action_id(uint16_t id)
+{
+    clear_action();
+
+    FighterAction* action = mActionIds.find(id);
+    if (action == nullptr)
+        throw wren::Exception("invalid action '{}'", world.keys.get_key(id));
+
+    activeAction = action;
+}
+
+void Fighter::wren_cxx_assign_state_id(uint16_t id)
+{
+    FighterState* state = mStateIds.find(id);
+    if (state == nullptr)
+        throw wren::Exception("invalid state '{}'", world.keys.get_key(id));
+
+    activeState = state;
+}
+
 Article* Fighter::wren_cxx_spawn_article(TinyString key)
 {
     const auto iter = def.articles.find(key);
@@ -342,6 +469,7 @@ void FighterAction::wren_cxx_before_start()
 //        wren_log_with_prefix("start");
 
     mCurrentFrame = mWaitUntil = 0u;
+    mRunId = world.generate_script_run_id();
 
     fighter.variables.hitSomething = false;
 
@@ -370,12 +498,44 @@ bool FighterAction::wren_cxx_next_frame()
     return ++mCurrentFrame > mWaitUntil;
 }
 
+bool FighterAction::wren_cxx_fast_forward(uint frame)
+{
+    // skip to the next frame that would resume the fiber
+    if (mWaitUntil + 1u > frame)
+    {
+        mCurrentFrame = frame;
+        return false;
+    }
+
+    mCurrentFrame = mWaitUntil + 1u;
+    return true;
+}
+
 void FighterAction::wren_cxx_before_cancel()
 {
 //    if (world.options.log_script == true)
 //        wren_log_with_prefix("cancel");
 }
 
+TinyString FighterAction::wren_cxx_native_state()
+{
+    return def.native->get_state();
+}
+
+std::optional<SmallString> FighterAction::wren_cxx_native_result()
+{
+    // wren expects null rather than an empty string
+    if (mNativeResult.has_value() == false || mNativeResult->empty() == true)
+        return std::nullopt;
+
+    return mNativeResult;
+}
+
+void FighterAction::wren_cxx_native_cancel()
+{
+    def.native->cancel(*this);
+}
+
 //----------------------------------------------------------------------------//
 
 void FighterAction::wren_enable_hitblobs(StringView prefix)
@@ -383,6 +543,11 @@ void FighterAction::wren_enable_hitblobs(StringView prefix)
     fighter.impl_wren_enable_hitblobs(def.blobs, prefix);
 }
 
+void FighterAction::wren_enable_hitblobs_id(uint16_t id)
+{
+    fighter.impl_wren_enable_hitblobs_id(def.blobs, def.blobGroups, id);
+}
+
 void FighterAction::wren_disable_hitblobs(bool resetCollisions)
 {
     fighter.get_hit_blobs().clear();
@@ -454,7 +619,8 @@ double World::wren_random_float(float min, float max)
 
 void World::wren_cancel_sound(int32_t id)
 {
-    audio.stop_sound(id);
+    if (audio != nullptr)
+        audio->stop_sound(id);
 }
 
 void World::wren_cancel_effect(int32_t id)
@@ -462,3 +628,13 @@ void World::wren_cancel_effect(int32_t id)
     mEffectSystem->cancel_effect(id);
 
 }
+
+uint16_t World::wren_key_id(StringView key)
+{
+    try {
+        return keys.intern(key);
+    }
+    catch (const std::runtime_error& ex) {
+        throw wren::Exception("{}", ex.what());
+    }
+}
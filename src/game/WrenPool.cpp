@@ -0,0 +1,207 @@
+#include "game/WrenPool.hpp"
+
+#include "game/WrenHeap.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+// wren passes the userData of the vm to its allocator, which WrenPlusVM uses
+// for itself, so pools are found from that instead
+std::vector<std::pair<void*, WrenPool*>> gInstalledPools;
+
+WrenPool& find_installed_pool(void* userData)
+{
+    // vms are only used from one thread, see WorkerPool
+    for (const auto& [key, pool] : gInstalledPools)
+        if (key == userData) return *pool;
+
+    SQEE_UNREACHABLE();
+}
+
+} // anonymous namespace
+
+//============================================================================//
+
+WrenPool::~WrenPool()
+{
+    std::erase_if(gInstalledPools, [this](const auto& pair) { return pair.second == this; });
+
+    // the vm has already been freed, so every block has been returned
+    for (const Chunk& chunk : mChunks)
+        std::free(chunk.begin);
+}
+
+void WrenPool::install(WrenVM* vm)
+{
+    SQASSERT(mPreviousFn == nullptr, "pool already installed");
+
+    mUserData = wrenGetUserData(vm);
+    gInstalledPools.emplace_back(mUserData, this);
+
+    mPreviousFn = WrenHeap::replace_allocator(vm, &WrenPool::impl_reallocate);
+}
+
+//============================================================================//
+
+int WrenPool::impl_find_size_class(size_t size)
+{
+    for (size_t index = 0u; index < SIZE_CLASSES.size(); ++index)
+        if (size <= SIZE_CLASSES[index])
+            return int(index);
+
+    return -1;
+}
+
+int WrenPool::impl_find_chunk_class(const void* memory) const
+{
+    const auto address = static_cast<const std::byte*>(memory);
+
+    const auto iter = std::upper_bound (
+        mChunks.begin(), mChunks.end(), address,
+        [](const std::byte* value, const Chunk& chunk) { return std::less()(value, chunk.begin); }
+    );
+
+    if (iter == mChunks.begin()) return -1;
+
+    const Chunk& chunk = *std::prev(iter);
+    return std::less()(address, chunk.begin + CHUNK_SIZE) ? chunk.sizeClass : -1;
+}
+
+//============================================================================//
+
+void* WrenPool::impl_reallocate(void* memory, size_t newSize, void* userData)
+{
+    WrenPool& pool = find_installed_pool(userData);
+
+    if (memory == nullptr)
+        return newSize == 0u ? nullptr : pool.impl_allocate(newSize);
+
+    const int oldClass = pool.impl_find_chunk_class(memory);
+    const auto largeIter = oldClass < 0 ? pool.mLargeSizes.find(memory) : pool.mLargeSizes.end();
+
+    // allocated before install, its size is unknown so leave it with the old allocator
+    if (oldClass < 0 && largeIter == pool.mLargeSizes.end())
+        return pool.mPreviousFn(memory, newSize, userData);
+
+    if (newSize == 0u)
+    {
+        pool.impl_free(memory, oldClass);
+        return nullptr;
+    }
+
+    const size_t oldSize = oldClass >= 0 ? SIZE_CLASSES[oldClass] : largeIter->second;
+    const int newClass = impl_find_size_class(newSize);
+
+    // still fits in the same block, happens a lot for growing strings and lists
+    if (oldClass >= 0 && oldClass == newClass)
+        return memory;
+
+    // neither size is pooled, so let malloc try to resize in place
+    if (oldClass < 0 && newClass < 0)
+    {
+        void* result = std::realloc(memory, newSize);
+        if (result == nullptr) return nullptr;
+
+        pool.mLargeSizes.erase(largeIter);
+        pool.mLargeSizes.emplace(result, newSize);
+
+        pool.impl_count_growth(oldSize, newSize);
+        return result;
+    }
+
+    void* result = pool.impl_allocate(newSize);
+    if (result == nullptr) return nullptr;
+
+    std::memcpy(result, memory, std::min(oldSize, newSize));
+    pool.impl_free(memory, oldClass);
+
+    return result;
+}
+
+//============================================================================//
+
+void* WrenPool::impl_allocate(size_t size)
+{
+    const int sizeClass = impl_find_size_class(size);
+
+    if (sizeClass < 0)
+    {
+        void* block = std::malloc(size);
+        if (block == nullptr) return nullptr;
+
+        mLargeSizes.emplace(block, size);
+        impl_count_growth(0u, size);
+        return block;
+    }
+
+    std::byte* block = nullptr;
+
+    if (mFreeLists[sizeClass] != nullptr)
+    {
+        // free blocks store the next free block at the start
+        block = mFreeLists[sizeClass];
+        std::memcpy(&mFreeLists[sizeClass], block, sizeof(std::byte*));
+    }
+    else
+    {
+        const size_t blockSize = SIZE_CLASSES[sizeClass];
+
+        // the end of the old chunk is wasted, but that's never more than one block
+        if (mChunkRemaining[sizeClass] < blockSize)
+        {
+            auto chunk = static_cast<std::byte*>(std::malloc(CHUNK_SIZE));
+            if (chunk == nullptr) return nullptr;
+
+            const auto iter = std::upper_bound (
+                mChunks.begin(), mChunks.end(), chunk,
+                [](const std::byte* value, const Chunk& other) { return std::less()(value, other.begin); }
+            );
+            mChunks.insert(iter, Chunk { chunk, sizeClass });
+
+            mChunkCursors[sizeClass] = chunk;
+            mChunkRemaining[sizeClass] = CHUNK_SIZE;
+        }
+
+        block = mChunkCursors[sizeClass];
+        mChunkCursors[sizeClass] += blockSize;
+        mChunkRemaining[sizeClass] -= blockSize;
+    }
+
+    impl_count_growth(0u, SIZE_CLASSES[sizeClass]);
+    return block;
+}
+
+void WrenPool::impl_free(void* memory, int sizeClass)
+{
+    if (sizeClass < 0)
+    {
+        const auto iter = mLargeSizes.find(memory);
+        mLiveBytes -= iter->second;
+        mLargeSizes.erase(iter);
+        std::free(memory);
+    }
+    else
+    {
+        mLiveBytes -= SIZE_CLASSES[sizeClass];
+        std::memcpy(memory, &mFreeLists[sizeClass], sizeof(std::byte*));
+        mFreeLists[sizeClass] = static_cast<std::byte*>(memory);
+    }
+}
+
+void WrenPool::impl_count_growth(size_t oldSize, size_t newSize)
+{
+    mLiveBytes = mLiveBytes - oldSize + newSize;
+    mPeakBytes = maths::max(mPeakBytes, mLiveBytes);
+
+    if (newSize > oldSize)
+    {
+        mAllocatedBytes += newSize - oldSize;
+        mAllocationCount += 1u;
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include <sqee/app/WrenPlus.hpp>
+
+namespace sts {
+
+//============================================================================//
+
+/// Allocator for a wren vm that pools small blocks and counts what it uses.
+///
+/// Blocks of up to 256 bytes come from size class free lists, carved out of
+/// chunks that are kept until the pool is destroyed, so the constant churn of
+/// strings, lists, and fibers doesn't go through malloc. Bigger blocks use
+/// malloc.
+///
+/// WrenPlusVM creates its vm with the default allocator, so install replaces
+/// it afterwards. Blocks from before then stay with the old allocator, and
+/// aren't counted. Must outlive the vm, so World declares it first.
+class WrenPool final
+{
+public: //====================================================//
+
+    WrenPool() = default;
+
+    SQEE_COPY_DELETE(WrenPool)
+    SQEE_MOVE_DELETE(WrenPool)
+
+    ~WrenPool();
+
+    /// Make the vm allocate from this pool from now on, only call once.
+    void install(WrenVM* vm);
+
+    //--------------------------------------------------------//
+
+    /// Bytes in blocks currently held by the vm, small blocks count their whole size class.
+    size_t get_live_bytes() const { return mLiveBytes; }
+
+    /// Highest value of live bytes since creation or reset_peak_bytes.
+    size_t get_peak_bytes() const { return mPeakBytes; }
+
+    /// Bytes ever allocated by the vm, never decreases.
+    uint64_t get_allocated_bytes() const { return mAllocatedBytes; }
+
+    /// Number of allocations ever made by the vm, including growing reallocations.
+    uint64_t get_allocation_count() const { return mAllocationCount; }
+
+    /// Bytes held in chunks for small blocks, whether in use or not.
+    size_t get_reserved_bytes() const { return mChunks.size() * CHUNK_SIZE; }
+
+    void reset_peak_bytes() { mPeakBytes = mLiveBytes; }
+
+private: //===================================================//
+
+    static constexpr size_t CHUNK_SIZE = 64u * 1024u;
+
+    /// Usable sizes of small blocks, multiples of 16 so that malloc's alignment is kept.
+    static constexpr std::array<size_t, 8u> SIZE_CLASSES = { 16u, 32u, 48u, 64u, 96u, 128u, 192u, 256u };
+
+    /// Find the smallest class that fits, or -1 if too big for any.
+    static int impl_find_size_class(size_t size);
+
+    static void* impl_reallocate(void* memory, size_t newSize, void* userData);
+
+    /// Find the size class of a block from one of the chunks, or -1 if it isn't from one.
+    int impl_find_chunk_class(const void* memory) const;
+
+    void* impl_allocate(size_t size);
+
+    void impl_free(void* memory, int sizeClass);
+
+    void impl_count_growth(size_t oldSize, size_t newSize);
+
+    //--------------------------------------------------------//
+
+    struct Chunk
+    {
+        std::byte* begin;
+        int sizeClass;
+    };
+
+    /// Sorted by address, so that blocks can be found with a binary search.
+    std::vector<Chunk> mChunks;
+
+    std::array<std::byte*, SIZE_CLASSES.size()> mFreeLists = {};
+
+    // each class carves blocks from its newest chunk until it runs out
+    std::array<std::byte*, SIZE_CLASSES.size()> mChunkCursors = {};
+    std::array<size_t, SIZE_CLASSES.size()> mChunkRemaining = {};
+
+    /// Sizes of big blocks, since wren doesn't pass the old size when reallocating.
+    std::map<void*, size_t> mLargeSizes;
+
+    /// Allocator the vm had before install, still used for blocks from before then.
+    WrenReallocateFn mPreviousFn = nullptr;
+
+    void* mUserData = nullptr;
+
+    size_t mLiveBytes = 0u;
+    size_t mPeakBytes = 0u;
+
+    uint64_t mAllocatedBytes = 0u;
+    uint64_t mAllocationCount = 0u;
+};
+
+//============================================================================//
+
+} // namespace sts
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include <atomic>
+
+namespace sts {
+
+//============================================================================//
+
+/// Count of heap allocations made by the process.
+///
+/// Nothing increments this by default. Tools that want to count allocations
+/// replace the global operator new and increment it from there.
+struct AllocationCounter final
+{
+    static inline std::atomic<size_t> count = 0u;
+
+    /// Call from a replacement operator new.
+    static void increment() { count.fetch_add(1u, std::memory_order_relaxed); }
+};
+
+//============================================================================//
+
+} // namespace sts
@@ -0,0 +1,235 @@
+#include "main/AssetArchive.hpp"
+
+#include <cstring> // memcpy
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace sts;
+
+//============================================================================//
+
+AssetArchive::AssetArchive(const String& path)
+{
+  #ifdef _WIN32
+
+    const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error(fmt::format("could not open archive '{}'", path));
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    mSize = size_t(fileSize.QuadPart);
+
+    mFileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0u, 0u, nullptr);
+    CloseHandle(file);
+
+    if (mFileMapping == nullptr)
+        throw std::runtime_error(fmt::format("could not map archive '{}'", path));
+
+    mData = static_cast<const std::byte*>(MapViewOfFile(mFileMapping, FILE_MAP_READ, 0u, 0u, 0u));
+
+    if (mData == nullptr)
+    {
+        CloseHandle(mFileMapping);
+        throw std::runtime_error(fmt::format("could not map archive '{}'", path));
+    }
+
+  #else
+
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file == -1)
+        throw std::runtime_error(fmt::format("could not open archive '{}'", path));
+
+    struct stat info;
+    fstat(file, &info);
+    mSize = size_t(info.st_size);
+
+    void* const mapping = mSize != 0u ? mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+    close(file);
+
+    if (mapping == MAP_FAILED)
+        throw std::runtime_error(fmt::format("could not map archive '{}'", path));
+
+    mData = static_cast<const std::byte*>(mapping);
+
+  #endif
+
+    // destructors don't run for constructors that throw, so unmap here
+    const auto fail = [&](StringView reason)
+    {
+        impl_unmap();
+        throw std::runtime_error(fmt::format("archive '{}' {}", path, reason));
+    };
+
+    if (mSize < sizeof(Header)) fail("is truncated");
+
+    Header header;
+    std::memcpy(&header, mData, sizeof(Header));
+
+    if (header.magic != MAGIC) fail("is not an asset archive");
+
+    if (header.version != VERSION)
+        fail(fmt::format("has version {}, expected {}", header.version, VERSION));
+
+    if (sizeof(Header) + sizeof(Entry) * size_t(header.entryCount) > mSize) fail("is truncated");
+
+    mEntries = reinterpret_cast<const Entry*>(mData + sizeof(Header));
+    mEntryCount = header.entryCount;
+
+    // check everything that find will touch, so that it never has to
+    for (size_t index = 0u; index < mEntryCount; ++index)
+    {
+        const Entry& entry = mEntries[index];
+
+        if (size_t(entry.pathOffset) + entry.pathSize > mSize || entry.dataOffset > mSize || entry.dataSize > mSize - entry.dataOffset)
+            fail("has an invalid entry");
+
+        if (index != 0u && impl_get_path(mEntries[index - 1u]) >= impl_get_path(entry))
+            fail("has unsorted entries");
+    }
+}
+
+AssetArchive::~AssetArchive()
+{
+    impl_unmap();
+}
+
+void AssetArchive::impl_unmap()
+{
+  #ifdef _WIN32
+    UnmapViewOfFile(mData);
+    CloseHandle(mFileMapping);
+  #else
+    munmap(const_cast<std::byte*>(mData), mSize);
+  #endif
+}
+
+const AssetArchive* AssetArchive::get_default()
+{
+    static const std::unique_ptr<AssetArchive> archive = []() -> std::unique_ptr<AssetArchive>
+    {
+        if (std::filesystem::exists(DEFAULT_PATH) == false) return nullptr;
+
+        try {
+            auto result = std::make_unique<AssetArchive>(DEFAULT_PATH);
+            sq::log_info("using asset archive '{}' with {} entries", DEFAULT_PATH, result->get_entry_count());
+            return result;
+        }
+        catch (const std::exception& ex) {
+            sq::log_warning("{}, using loose files only", ex.what());
+            return nullptr;
+        }
+    }();
+
+    return archive.get();
+}
+
+//============================================================================//
+
+StringView AssetArchive::impl_get_path(const Entry& entry) const
+{
+    return StringView(reinterpret_cast<const char*>(mData + entry.pathOffset), entry.pathSize);
+}
+
+std::optional<StringView> AssetArchive::find(StringView path) const
+{
+    const auto iter = std::lower_bound (
+        mEntries, mEntries + mEntryCount, path,
+        [this](const Entry& entry, StringView value) { return impl_get_path(entry) < value; }
+    );
+
+    if (iter == mEntries + mEntryCount || impl_get_path(*iter) != path)
+        return std::nullopt;
+
+    return StringView(reinterpret_cast<const char*>(mData + iter->dataOffset), iter->dataSize);
+}
+
+//============================================================================//
+
+std::optional<String> sts::try_read_asset(const String& path)
+{
+    // loose files always win, so that assets can be modified without repacking
+    if (std::ifstream stream { path, std::ios::binary }; stream.good() == true)
+        return String(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+    if (const AssetArchive* archive = AssetArchive::get_default())
+        if (const auto contents = archive->find(path))
+            return String(*contents);
+
+    return std::nullopt;
+}
+
+String sts::read_asset(const String& path)
+{
+    auto result = try_read_asset(path);
+
+    if (result.has_value() == false)
+        throw std::runtime_error(fmt::format("could not open asset '{}'", path));
+
+    return std::move(*result);
+}
+
+bool sts::asset_exists(const String& path)
+{
+    if (std::filesystem::exists(path) == true) return true;
+
+    const AssetArchive* archive = AssetArchive::get_default();
+    return archive != nullptr && archive->find(path).has_value() == true;
+}
+
+std::filesystem::file_time_type sts::get_asset_timestamp(const String& path)
+{
+    std::error_code error;
+
+    if (const auto time = std::filesystem::last_write_time(path, error); !error)
+        return time;
+
+    const AssetArchive* archive = AssetArchive::get_default();
+    if (archive != nullptr && archive->find(path).has_value() == true)
+        if (const auto time = std::filesystem::last_write_time(AssetArchive::DEFAULT_PATH, error); !error)
+            return time;
+
+    return std::filesystem::file_time_type::min();
+}
+
+JsonDocument sts::parse_asset_json(const String& path)
+{
+    return JsonDocument::parse_string(read_asset(path), path);
+}
+
+void sts::check_loose_assets()
+{
+    const AssetArchive* archive = AssetArchive::get_default();
+    if (archive == nullptr) return;
+
+    const auto contents = archive->find(AssetArchive::LOOSE_FILES_PATH);
+    if (contents.has_value() == false)
+        throw std::runtime_error(fmt::format("'{}' has no list of loose files, pack it again", AssetArchive::DEFAULT_PATH));
+
+    std::vector<StringView> missing;
+
+    for (size_t begin = 0u, end; begin < contents->size(); begin = end + 1u)
+    {
+        end = std::min(contents->find('\n', begin), contents->size());
+        const StringView path = contents->substr(begin, end - begin);
+
+        if (path.empty() == false && std::filesystem::exists(path) == false)
+            missing.push_back(path);
+    }
+
+    if (missing.empty() == false)
+        throw std::runtime_error (
+            fmt::format("{} files needed alongside '{}' are missing, including '{}'", missing.size(), AssetArchive::DEFAULT_PATH, missing.front())
+        );
+}
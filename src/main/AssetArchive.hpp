@@ -0,0 +1,119 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include <sqee/misc/Json.hpp>
+
+#include <filesystem>
+
+namespace sts {
+
+//============================================================================//
+
+/// Read only, memory mapped archive of asset files, made by sts-pack-assets.
+///
+/// The file starts with a header and a table of entries sorted by path,
+/// followed by the paths and then the contents of each file, every one
+/// aligned to ALIGNMENT. Opening an archive only maps it, pages are
+/// read by the OS as entries are used.
+///
+/// Only files that the game opens itself can come from an archive: json
+/// definitions, wren scripts, and compressed animations. Meshes, textures,
+/// sounds, armatures, and draw items are loaded by sqee from loose files,
+/// which are listed in the archive so that check_loose_assets can find them.
+class AssetArchive final
+{
+public: //====================================================//
+
+    static constexpr const std::array<char, 4u> MAGIC = { 'S', 'T', 'S', 'P' };
+
+    // increment whenever the layout changes
+    static constexpr const uint32_t VERSION = 1u;
+
+    static constexpr const size_t ALIGNMENT = 64u;
+
+    struct Header
+    {
+        std::array<char, 4u> magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t reserved;
+    };
+
+    struct Entry
+    {
+        uint64_t dataOffset;
+        uint64_t dataSize;
+        uint32_t pathOffset;
+        uint32_t pathSize;
+    };
+
+    //--------------------------------------------------------//
+
+    /// Map and validate an archive, throws std::runtime_error on failure.
+    AssetArchive(const String& path);
+
+    SQEE_COPY_DELETE(AssetArchive)
+    SQEE_MOVE_DELETE(AssetArchive)
+
+    ~AssetArchive();
+
+    /// Archive at DEFAULT_PATH, opened on first use, or null if there isn't one.
+    static const AssetArchive* get_default();
+
+    static constexpr const char* DEFAULT_PATH = "assets.stsp";
+
+    /// Entry listing files that were not packed, one path per line.
+    static constexpr const char* LOOSE_FILES_PATH = "LooseFiles.txt";
+
+    //--------------------------------------------------------//
+
+    /// Find the contents of a file, using the same relative paths as loose files.
+    std::optional<StringView> find(StringView path) const;
+
+    size_t get_entry_count() const { return mEntryCount; }
+
+private: //===================================================//
+
+    StringView impl_get_path(const Entry& entry) const;
+
+    void impl_unmap();
+
+    const std::byte* mData = nullptr;
+    size_t mSize = 0u;
+
+    const Entry* mEntries = nullptr;
+    size_t mEntryCount = 0u;
+
+    void* mFileMapping = nullptr; ///< Only used on windows.
+};
+
+//============================================================================//
+
+/// Read a whole asset file, from the default archive if there's no loose file.
+std::optional<String> try_read_asset(const String& path);
+
+/// Read a whole asset file, from the default archive if there's no loose file, throws on failure.
+String read_asset(const String& path);
+
+/// Check if an asset exists as a loose file or in the default archive.
+bool asset_exists(const String& path);
+
+/// Modification time of an asset, or of the default archive if there's no loose file.
+///
+/// Returns the minimum time for assets that don't exist, so that adding one is
+/// still noticed when comparing timestamps.
+std::filesystem::file_time_type get_asset_timestamp(const String& path);
+
+/// Parse a json asset, from the default archive if there's no loose file.
+JsonDocument parse_asset_json(const String& path);
+
+/// If there's a default archive, check that the files it needs alongside it exist.
+///
+/// Throws std::runtime_error listing missing files, so that a partial install
+/// fails at startup rather than when sqee first tries to open one of them.
+void check_loose_assets();
+
+//============================================================================//
+
+} // namespace sts
@@ -5,12 +5,14 @@
 #include "game/Fighter.hpp"
 #include "game/FighterAction.hpp"
 #include "game/FighterState.hpp"
+#include "game/ScriptProfiler.hpp"
 #include "game/Stage.hpp"
 #include "game/World.hpp"
 
 #include "render/Renderer.hpp"
 
 #include <sqee/app/GuiWidgets.hpp>
+#include <sqee/misc/Files.hpp>
 
 using namespace sts;
 
@@ -90,7 +92,7 @@ void DebugGui::show_widget_fighter(Fighter& fighter)
 
             const auto& c = reinterpret_cast<sq::Armature::Bone*>(fighter.mAnimPlayer.currentSample.data())[bone];
             const auto& p = reinterpret_cast<sq::Armature::Bone*>(fighter.mAnimPlayer.previousSample.data())[bone];
-            const auto& m = reinterpret_cast<Mat34F*>(fighter.world.renderer.ubos.matrices.map_only())[fighter.mAnimPlayer.modelMatsIndex + 1u + bone];
+            const auto& m = reinterpret_cast<Mat34F*>(fighter.world.renderer->ubos.matrices.map_only())[fighter.mAnimPlayer.modelMatsIndex + 1u + bone];
 
             ImPlus::HoverTooltip (
                 true, ImGuiDir_Left,
@@ -348,3 +350,63 @@ void DebugGui::show_widget_stage(Stage& stage)
         ImPlus::SliderValue("Black",    tonemap.black,    0.5f,  2.f);
     }
 }
+
+//============================================================================//
+
+void DebugGui::show_widget_script_profiler(ScriptProfiler& profiler)
+{
+    if (!ImGui::CollapsingHeader("Script Profiler", 0))
+        return;
+
+    //--------------------------------------------------------//
+
+    bool enabled = profiler.is_enabled();
+    if (ImGui::Checkbox("enabled", &enabled)) profiler.set_enabled(enabled);
+    ImPlus::HoverTooltip("measure script calls, adds some overhead");
+
+    ImGui::SameLine();
+
+    if (ImGui::Button("reset")) profiler.reset();
+    ImPlus::HoverTooltip("forget everything measured so far");
+
+    ImGui::SameLine();
+
+    if (ImGui::Button("export"))
+    {
+        sq::write_text_to_file("script_profile.csv", profiler.to_csv(), true);
+        sq::log_info("wrote script_profile.csv");
+    }
+    ImPlus::HoverTooltip("write results to script_profile.csv");
+
+    //--------------------------------------------------------//
+
+    IMPLUS_WITH(Scope_Font) = ImPlus::FONT_MONO;
+
+    ImPlus::if_Table("", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_SizingFixedFit, ImVec2(), 0.f, [&]()
+    {
+        ImGui::TableSetupColumn("script", ImGuiTableColumnFlags_WidthStretch, 0.f);
+        ImGui::TableSetupColumn("calls", 0, 0.f);
+        ImGui::TableSetupColumn("ms", 0, 0.f);
+        ImGui::TableSetupColumn("KiB", 0, 0.f);
+        ImGui::TableHeadersRow();
+
+        for (const ScriptProfiler::Entry* entry : profiler.get_sorted_entries())
+        {
+            ImGui::TableNextColumn();
+            ImPlus::Text(fmt::format("{}.{}", entry->module.substr(entry->module.rfind('/') + 1u), entry->method));
+            ImPlus::HoverTooltip (
+                true, ImGuiDir_Left, "{}\n{}()\nmean: {:.2f}us\nmax:  {:.2f}us",
+                entry->module, entry->method, entry->totalSeconds * 1000000.0 / double(entry->calls), entry->maxSeconds * 1000000.0
+            );
+
+            ImGui::TableNextColumn();
+            ImPlus::Text(fmt::to_string(entry->calls));
+
+            ImGui::TableNextColumn();
+            ImPlus::Text(fmt::format("{:.2f}", entry->totalSeconds * 1000.0));
+
+            ImGui::TableNextColumn();
+            ImPlus::Text(fmt::format("{:.1f}", double(entry->allocatedBytes) / 1024.0));
+        }
+    });
+}
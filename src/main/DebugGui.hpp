@@ -11,6 +11,7 @@ struct DebugGui final
     static void show_widget_fighter(Fighter& fighter);
     static void show_widget_article(Article& article);
     static void show_widget_stage(Stage& stage);
+    static void show_widget_script_profiler(ScriptProfiler& profiler);
 };
 
 //============================================================================//
@@ -3,12 +3,14 @@
 #include "main/DebugGui.hpp"
 #include "main/GameSetup.hpp"
 #include "main/Options.hpp"
+#include "main/Replay.hpp"
 #include "main/SmashApp.hpp"
 
 #include "game/Controller.hpp"
 #include "game/Fighter.hpp"
 #include "game/Stage.hpp"
 #include "game/World.hpp"
+#include "game/WrenHeap.hpp"
 
 #include "render/Renderer.hpp"
 #include "render/StandardCamera.hpp"
@@ -20,7 +22,8 @@
 #include <sqee/maths/Colours.hpp>
 #include <sqee/vk/VulkanContext.hpp>
 
-#include <ctime> // rng seed
+#include <ctime> // rng seed, replay names
+#include <filesystem>
 
 using namespace sts;
 
@@ -65,7 +68,9 @@ GameScene::GameScene(SmashApp& smashApp, GameSetup setup)
 
     mRenderer = std::make_unique<Renderer>(window, options, resourceCaches);
     mWorld = std::make_unique<World>(options, audioContext, resourceCaches, *mRenderer);
-    mWorld->set_rng_seed(uint_fast32_t(std::time(nullptr)));
+
+    const auto seed = uint32_t(std::time(nullptr));
+    mWorld->set_rng_seed(seed);
 
     mStandardCamera = std::make_unique<StandardCamera>(*mRenderer);
     mEditorCamera = std::make_unique<EditorCamera>(*mRenderer);
@@ -88,6 +93,24 @@ GameScene::GameScene(SmashApp& smashApp, GameSetup setup)
     }
 
     mWorld->finish_setup();
+
+    //--------------------------------------------------------//
+
+    if (options.record_replays == true)
+    {
+        std::error_code error;
+        std::filesystem::create_directories("replays", error);
+
+        // make room for the new replay
+        remove_old_replays("replays", maths::max(options.max_replays, 1u) - 1u);
+
+        // local time, so that files sort by when they were played
+        const std::time_t time = std::time(nullptr);
+        std::array<char, 32u> timeStr;
+        std::strftime(timeStr.data(), timeStr.size(), "%Y-%m-%d_%H-%M-%S", std::localtime(&time));
+
+        mReplayWriter = std::make_unique<ReplayWriter>(fmt::format("replays/{}.stsr", timeStr.data()), setup, seed);
+    }
 }
 
 GameScene::~GameScene()
@@ -136,10 +159,10 @@ void GameScene::handle_event(sq::Event event)
             if (mGamePaused == true)
             {
                 for (auto& controller : mControllers)
-                    controller->refresh(), controller->tick();
+                    controller->refresh();
 
                 // advance by a single frame
-                mWorld->tick();
+                impl_tick_world();
 
                 // todo: tell audio context to play one tick's worth of sound
             }
@@ -152,14 +175,28 @@ void GameScene::handle_event(sq::Event event)
 void GameScene::update()
 {
     if (mGamePaused == false)
+        impl_tick_world();
+
+    mRenderer->get_camera().update_from_world(*mWorld);
+}
+
+//============================================================================//
+
+void GameScene::impl_tick_world()
+{
+    for (auto& controller : mControllers)
+        controller->tick();
+
+    if (mReplayWriter != nullptr)
     {
+        ReplayTick frames;
         for (auto& controller : mControllers)
-            controller->tick();
+            frames.push_back(controller->history.frames.front());
 
-        mWorld->tick();
+        mReplayWriter->write_tick(frames);
     }
 
-    mRenderer->get_camera().update_from_world(*mWorld);
+    mWorld->tick();
 }
 
 //============================================================================//
@@ -186,6 +223,16 @@ void GameScene::integrate(double /*elapsed*/, float blend)
     }
 
     mSmashApp.get_debug_overlay().update_sub_timers(mRenderer->get_frame_timings().data());
+
+    // not part of a tick, so a pause here can only delay rendering
+    if (mWorld->collect_garbage() == true)
+    {
+        const World::GarbageStats& stats = mWorld->get_garbage_stats();
+        mSmashApp.get_debug_overlay().notify (
+            fmt::format("wren gc took {:.2f}ms, {:.1f} -> {:.1f} MiB", stats.lastPause * 1000.0,
+                        double(stats.lastBefore) / 1048576.0, double(stats.lastAfter) / 1048576.0)
+        );
+    }
 }
 
 //============================================================================//
@@ -270,6 +317,28 @@ void GameScene::impl_show_general_window()
     ImGui::SetNextItemWidth(-1.f);
     ImPlus::SliderValue("##zoom", options.camera_zoom_out, 0.5f, 2.f, "zoom out: %.2f");
     options.camera_zoom_out = std::round(options.camera_zoom_out * 4.f) * 0.25f;
+
+    //--------------------------------------------------------//
+
+    const World::GarbageStats& gcStats = mWorld->get_garbage_stats();
+
+    const WrenPool& pool = mWorld->wrenPool;
+    const World::TickTimings& timings = mWorld->get_tick_timings();
+
+    ImPlus::Text(fmt::format("Wren Heap: {:.1f} / {} MiB", double(WrenHeap::get_allocated_bytes(mWorld->vm)) / 1048576.0, options.wren_heap_budget));
+    ImPlus::HoverTooltip (
+        true, ImGuiDir_Right,
+        "Live:        {:.1f} MiB\nPeak:        {:.1f} MiB\nReserved:    {:.1f} MiB\nLast Tick:   {} allocs, {:.1f} KiB\n"
+        "Collections: {}\nLast Pause:  {:.2f}ms\nMax Pause:   {:.2f}ms\nTotal Pause: {:.2f}ms",
+        double(pool.get_live_bytes()) / 1048576.0, double(pool.get_peak_bytes()) / 1048576.0,
+        double(pool.get_reserved_bytes()) / 1048576.0, timings.wrenAllocations, double(timings.wrenAllocatedBytes) / 1024.0,
+        gcStats.collections, gcStats.lastPause * 1000.0, gcStats.maxPause * 1000.0, gcStats.totalPause * 1000.0
+    );
+
+    ImGui::SameLine();
+
+    if (ImGui::Button("collect")) mWorld->collect_garbage(true);
+    ImPlus::HoverTooltip("collect wren garbage now");
 }
 
 //============================================================================//
@@ -287,6 +356,8 @@ void GameScene::impl_show_objects_window()
 
     //--------------------------------------------------------//
 
+    DebugGui::show_widget_script_profiler(mWorld->get_script_profiler());
+
     DebugGui::show_widget_stage(mWorld->get_stage());
 
     for (auto& fighter : mWorld->get_fighters())
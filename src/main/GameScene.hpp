@@ -46,12 +46,18 @@ private: //===================================================//
 
     std::unique_ptr<EditorCamera> mEditorCamera;
 
+    std::unique_ptr<ReplayWriter> mReplayWriter;
+
     //--------------------------------------------------------//
 
     SmashApp& mSmashApp;
 
     //--------------------------------------------------------//
 
+    void impl_tick_world();
+
+    //--------------------------------------------------------//
+
     void impl_show_general_window();
     void impl_show_objects_window();
     void impl_show_portraits();
@@ -0,0 +1,107 @@
+#include "main/HeadlessGame.hpp"
+
+#include "main/GameSetup.hpp"
+
+#include "game/Controller.hpp"
+#include "game/Fighter.hpp"
+#include "game/World.hpp"
+
+using namespace sts;
+
+//============================================================================//
+
+HeadlessGame::HeadlessGame(const GameSetup& setup, uint_fast32_t seed)
+{
+    SQASSERT(setup.players.size() != 0u, "need at least one player");
+
+    // script logging is far too slow for running uncapped
+    mOptions.log_animation = false;
+    mOptions.log_script = false;
+
+    // nothing is rendered, so spend the memory on faster sampling instead
+    mOptions.bake_animations = true;
+
+    mWorld = std::make_unique<World>(mOptions);
+    mWorld->set_rng_seed(seed);
+
+    mWorld->create_stage(setup.stage);
+
+    for (const GameSetup::Player& player : setup.players)
+    {
+        auto& controller = mControllers.emplace_back(std::make_unique<Controller>());
+        mRandomInputs.emplace_back(seed + mRandomInputs.size());
+
+        Fighter& fighter = mWorld->create_fighter(player.fighter);
+        fighter.controller = controller.get();
+    }
+
+    mWorld->finish_setup();
+}
+
+HeadlessGame::~HeadlessGame() = default;
+
+//============================================================================//
+
+void RandomInput::feed(Controller& controller)
+{
+    // hold each combination for a few frames
+    if (mHoldTime == 0u)
+    {
+        const auto random_int = [this](int min, int max)
+        {
+            return std::uniform_int_distribution<int>(min, max)(mRandNumGen);
+        };
+
+        for (bool& button : mButtons)
+            button = random_int(0, 5) == 0;
+
+        mAxes.x = float(random_int(-4, +4)) * 0.25f;
+        mAxes.y = float(random_int(-4, +4)) * 0.25f;
+        mHoldTime = uint8_t(random_int(1, 12));
+    }
+
+    controller.feed_input(mButtons, mAxes);
+    --mHoldTime;
+}
+
+//============================================================================//
+
+void HeadlessGame::feed_random_input()
+{
+    for (uint8_t index = 0u; index < mControllers.size(); ++index)
+        mRandomInputs[index].feed(*mControllers[index]);
+}
+
+//============================================================================//
+
+void HeadlessGame::tick()
+{
+    for (auto& controller : mControllers)
+        controller->tick();
+
+    if (mReplayWriter != nullptr)
+    {
+        ReplayTick frames;
+        for (auto& controller : mControllers)
+            frames.push_back(controller->history.frames.front());
+
+        mReplayWriter->write_tick(frames);
+    }
+
+    mWorld->tick();
+    mWorld->collect_garbage();
+}
+
+void HeadlessGame::tick(const ReplayTick& frames)
+{
+    SQASSERT(frames.size() == mControllers.size(), "wrong number of frames");
+
+    for (uint8_t index = 0u; index < mControllers.size(); ++index)
+        mControllers[index]->push_frame(frames[index]);
+
+    if (mReplayWriter != nullptr)
+        mReplayWriter->write_tick(frames);
+
+    mWorld->tick();
+    mWorld->collect_garbage();
+}
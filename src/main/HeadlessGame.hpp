@@ -0,0 +1,84 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include "main/Options.hpp"
+#include "main/Replay.hpp"
+
+#include <random> // mt19937
+
+namespace sts {
+
+//============================================================================//
+
+/// Feeds pseudo random input to a controller, like a very bad human would.
+class RandomInput final
+{
+public: //====================================================//
+
+    RandomInput(uint_fast32_t seed) : mRandNumGen(seed) {}
+
+    void feed(Controller& controller);
+
+private: //===================================================//
+
+    std::array<bool, 5> mButtons {};
+    Vec2F mAxes {};
+    uint8_t mHoldTime = 0u;
+
+    std::mt19937 mRandNumGen;
+};
+
+//============================================================================//
+
+/// Runs a game without a window, audio, or renderer.
+class HeadlessGame final
+{
+public: //====================================================//
+
+    HeadlessGame(const GameSetup& setup, uint_fast32_t seed);
+
+    SQEE_COPY_DELETE(HeadlessGame)
+    SQEE_MOVE_DELETE(HeadlessGame)
+
+    ~HeadlessGame();
+
+    //--------------------------------------------------------//
+
+    /// Feed every controller some pseudo random input.
+    void feed_random_input();
+
+    /// Tick all controllers, then the world.
+    void tick();
+
+    /// Give each controller a complete frame, then tick the world.
+    void tick(const ReplayTick& frames);
+
+    /// Record input from every following tick, or stop if null.
+    void set_replay_writer(ReplayWriter* writer) { mReplayWriter = writer; }
+
+    //--------------------------------------------------------//
+
+    World& get_world() { return *mWorld; }
+
+    Controller& get_controller(uint8_t index) { return *mControllers[index]; }
+
+    uint8_t get_player_count() const { return uint8_t(mControllers.size()); }
+
+private: //===================================================//
+
+    Options mOptions;
+
+    std::unique_ptr<World> mWorld;
+
+    StackVector<std::unique_ptr<Controller>, MAX_FIGHTERS> mControllers;
+
+    // separate from the world, so that inputs don't depend on the game
+    StackVector<RandomInput, MAX_FIGHTERS> mRandomInputs;
+
+    ReplayWriter* mReplayWriter = nullptr;
+};
+
+//============================================================================//
+
+} // namespace sts
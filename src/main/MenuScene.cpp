@@ -1,6 +1,8 @@
 #include "main/MenuScene.hpp"
 
+#include "main/AssetArchive.hpp"
 #include "main/Options.hpp"
+#include "main/Preloader.hpp"
 #include "main/SmashApp.hpp"
 
 #include <sqee/app/Event.hpp>
@@ -19,7 +21,7 @@ MenuScene::MenuScene(SmashApp& smashApp)
 
     // load stage names
     {
-        const auto document = JsonDocument::parse_file("assets/stages/Stages.json");
+        const auto document = parse_asset_json("assets/stages/Stages.json");
         const auto json = document.root().as<JsonArray>();
         mStageNames.reserve(json.size());
         for (const auto [_, name] : json)
@@ -28,12 +30,14 @@ MenuScene::MenuScene(SmashApp& smashApp)
 
     // load fighter names
     {
-        const auto document = JsonDocument::parse_file("assets/fighters/Fighters.json");
+        const auto document = parse_asset_json("assets/fighters/Fighters.json");
         const auto json = document.root().as<JsonArray>();
         mFighterNames.reserve(json.size());
         for (const auto [_, name] : json)
             mFighterNames.emplace_back(name.as<String>());
     }
+
+    mPreloader = std::make_unique<Preloader>(mSmashApp.get_options(), mSmashApp.get_resource_caches());
 }
 
 MenuScene::~MenuScene() = default;
@@ -60,6 +64,9 @@ void MenuScene::handle_event(sq::Event event)
 
 void MenuScene::update()
 {
+    // start loading as soon as anything is chosen, cancelling if choices change
+    mPreloader->start(mSetup);
+    mPreloader->update();
 }
 
 //============================================================================//
@@ -132,7 +139,7 @@ void MenuScene::show_imgui_widgets()
                 auto pNum = std::distance(mSetup.players.begin(), undecided) + 1;
                 mSmashApp.get_debug_overlay().notify(fmt::format("Please choose a Fighter for Player {}", pNum));
             }
-            else mSmashApp.start_game(mSetup);
+            else impl_start_game(mSetup);
         }
     }
     ImPlus::HoverTooltip("WARNING: Sara and Tux are usually broken, if you want a mostly working fighter use Mario (Quick Start)");
@@ -146,9 +153,34 @@ void MenuScene::show_imgui_widgets()
     ImGui::SameLine();
     if (ImGui::Button("Quick Start"))
     {
-        mSmashApp.start_game(GameSetup::get_quickstart());
+        impl_start_game(GameSetup::get_quickstart());
     }
     ImPlus::HoverTooltip("currently this starts a game in TestZone with four Marios");
+
+    //--------------------------------------------------------//
+
+    if (mPreloader->get_step_count() != 0u)
+    {
+        ImGui::Separator();
+
+        const float fraction = float(mPreloader->get_steps_done()) / float(mPreloader->get_step_count());
+
+        if (mPreloader->is_finished() == false)
+            ImGui::ProgressBar(fraction, {-1.f, 0.f}, fmt::format("Loading {}", mPreloader->get_current_step()).c_str());
+        else
+            ImGui::ProgressBar(fraction, {-1.f, 0.f}, "Ready");
+    }
+}
+
+//============================================================================//
+
+void MenuScene::impl_start_game(const GameSetup& setup)
+{
+    // whatever hasn't been loaded yet would be loaded by GameScene anyway
+    mPreloader->start(setup);
+    mPreloader->finish();
+
+    mSmashApp.start_game(setup);
 }
 
 //============================================================================//
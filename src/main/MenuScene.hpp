@@ -36,6 +36,8 @@ private: //===================================================//
 
     void integrate(double elapsed, float blend) override;
 
+    void impl_start_game(const GameSetup& setup);
+
     //--------------------------------------------------------//
 
     SmashApp& mSmashApp;
@@ -46,6 +48,9 @@ private: //===================================================//
     std::vector<TinyString> mFighterNames;
 
     GameSetup mSetup;
+
+    /// Loads assets for mSetup while choices are being made.
+    std::unique_ptr<Preloader> mPreloader;
 };
 
 //============================================================================//
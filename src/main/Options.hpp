@@ -38,6 +38,16 @@ struct Options final
     bool log_animation = false;     ///< Enable logging of animation stuff
     bool log_script = true;         ///< Enable logging of script stuff
 
+    bool record_replays = false;    ///< Write a replay file for every match, or pass --replays
+    uint max_replays = 50u;         ///< Oldest replay files are deleted when there are more than this
+
+    // baked poses for Mario take about 10 MiB, compared to 3.6 MiB for the raw tracks
+    bool bake_animations = false;   ///< Precompute poses for every frame, always on for headless games
+
+    bool native_actions = true;     ///< Use C++ versions of actions where fighters have them
+
+    uint wren_heap_budget = 16u;    ///< Megabytes of wren heap before collecting between ticks, zero to leave it to wren
+
     bool debug_toggle_1 = false;    ///< Used for whatever, press 1
     bool debug_toggle_2 = false;    ///< Used for whatever, press 2
 
@@ -0,0 +1,348 @@
+#include "main/Preloader.hpp"
+
+#include "game/EntityDef.hpp"
+#include "game/SoundEffect.hpp"
+
+#include "main/AssetArchive.hpp"
+#include "main/Options.hpp"
+#include "main/Tracing.hpp"
+#include "main/WorkerPool.hpp"
+
+#include <sqee/misc/Json.hpp>
+
+#include <fstream>
+#include <set>
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+bool is_same_setup(const GameSetup& a, const GameSetup& b)
+{
+    if (a.stage != b.stage || a.players.size() != b.players.size())
+        return false;
+
+    for (size_t index = 0u; index < a.players.size(); ++index)
+        if (a.players[index].fighter != b.players[index].fighter)
+            return false;
+
+    return true;
+}
+
+/// Add keys for the meshes and textures listed in a Render.json file.
+void append_render_keys(const String& renderPath, std::vector<String>& keys)
+{
+    const auto document = parse_asset_json(renderPath);
+    const auto jAssets = document.root().as<JsonObject>()["assets"].as<JsonObject>();
+
+    for (const auto [_, jKey] : jAssets["meshes"].as<JsonObject>())
+        keys.emplace_back(jKey.as<StringView>());
+
+    for (const auto [_, jKey] : jAssets["textures"].as<JsonObject>())
+        keys.emplace_back(jKey.as<StringView>());
+}
+
+/// Read the loose files for some resource keys on the WorkerPool, throwing away the contents.
+///
+/// Sqee reads these files itself and uploads them in the same call, so this
+/// can't hand it the data. It does mean sqee finds them in the OS file cache
+/// instead of waiting for the disk on the main thread.
+void prefetch_loose_files(const std::vector<String>& keys)
+{
+    STS_TRACE_ZONE("prefetch_loose_files");
+
+    std::set<std::filesystem::path> directories;
+    std::set<std::filesystem::path> stems;
+
+    for (const String& key : keys)
+    {
+        const auto path = std::filesystem::path("assets/" + key);
+        directories.insert(path.parent_path());
+        stems.insert(path);
+    }
+
+    // sqee picks the extensions, so read every file matching a key apart from its extension
+    std::vector<std::filesystem::path> paths;
+
+    for (const auto& directory : directories)
+    {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+            if (entry.is_regular_file() && stems.contains(entry.path().parent_path() / entry.path().stem()))
+                paths.push_back(entry.path());
+    }
+
+    WorkerPool::get().parallel_for(paths.size(), [&](size_t index)
+    {
+        auto buffer = std::make_unique<char[]>(65536u);
+        auto file = std::ifstream(paths[index], std::ios::binary);
+        while (file.read(buffer.get(), 65536u)) {}
+    });
+}
+
+} // anonymous namespace
+
+//============================================================================//
+
+Preloader::Preloader(const Options& options, ResourceCaches& caches)
+    : mOptions(options), mCaches(caches) {}
+
+Preloader::~Preloader()
+{
+    impl_cancel();
+}
+
+//============================================================================//
+
+void Preloader::impl_cancel()
+{
+    if (mThread.joinable() == true)
+    {
+        // animations already being loaded will finish, but nothing else will start
+        mCancel = true;
+        mThread.join();
+        mCancel = false;
+    }
+
+    mSteps.clear();
+    mNextStep = 0u;
+
+    mEntityData = nullptr;
+    mThreadError.clear();
+}
+
+//============================================================================//
+
+bool Preloader::impl_run_on_thread(std::function<void()> work)
+{
+    if (mThread.joinable() == false)
+    {
+        mThreadDone = false;
+
+        mThread = std::thread([this, work = std::move(work)]()
+        {
+            try {
+                work();
+            }
+            catch (const std::exception& ex) {
+                mThreadError = ex.what();
+            }
+            mThreadDone = true;
+            mThreadDone.notify_all();
+        });
+
+        return false;
+    }
+
+    if (mThreadDone == false) return false;
+
+    mThread.join();
+
+    if (mThreadError.empty() == false)
+        throw std::runtime_error(std::exchange(mThreadError, {}));
+
+    return true;
+}
+
+//============================================================================//
+
+void Preloader::start(const GameSetup& setup)
+{
+    if (is_same_setup(setup, mSetup) == true) return;
+
+    impl_cancel();
+
+    mSetup = setup;
+
+    // anything already loaded stays in the caches, and will be skipped
+    mStageDrawItems.clear();
+    mStageArmature = nullptr;
+    mStageSkybox.clear();
+    mCubeTextures.clear();
+    mSounds.clear();
+
+    if (setup.stage.empty() == false)
+        impl_add_stage_steps(setup.stage);
+
+    std::vector<String> directories;
+
+    const auto add_entity = [&](String directory, std::vector<String> animationPaths, bool fighter)
+    {
+        if (ranges::find(directories, directory) != directories.end()) return;
+        directories.push_back(directory);
+        impl_add_entity_steps(std::move(directory), std::move(animationPaths), fighter);
+    };
+
+    for (const auto& player : setup.players)
+    {
+        if (player.fighter.empty() == true) continue;
+
+        const auto directory = fmt::format("fighters/{}", player.fighter);
+
+        add_entity(directory, { "assets/fighters/Animations.json", fmt::format("assets/{}/Animations.json", directory) }, true);
+
+        try {
+            const auto document = parse_asset_json(fmt::format("assets/{}/Articles.json", directory));
+            for (const auto [_, path] : document.root().as<JsonObject>())
+                add_entity(path.as<String>(), { fmt::format("assets/{}/Animations.json", path.as<StringView>()) }, false);
+        }
+        catch (const std::exception& ex) {
+            sq::log_warning("preload '{}': {}", directory, ex.what());
+        }
+    }
+}
+
+//============================================================================//
+
+void Preloader::impl_add_stage_steps(TinyString name)
+{
+    mSteps.push_back({ fmt::format("stage {} files", name), [this, name]()
+    {
+        // doesn't touch the caches, so it's fine for the main thread to keep going
+        return impl_run_on_thread([this, name]()
+        {
+            const auto document = parse_asset_json(fmt::format("assets/stages/{}/Stage.json", name));
+            const auto skyboxPath = document.root().as<JsonObject>()["render"].as<JsonObject>()["skybox"].as<String>();
+
+            auto armature = std::make_unique<sq::Armature>(fmt::format("assets/stages/{}/Armature.json", name));
+
+            std::vector<String> keys = { skyboxPath + "/Sky", skyboxPath + "/Irradiance", skyboxPath + "/Radiance" };
+            append_render_keys(fmt::format("assets/stages/{}/Render.json", name), keys);
+            prefetch_loose_files(keys);
+
+            mStageSkybox = skyboxPath;
+            mStageArmature = std::move(armature);
+        });
+    }});
+
+    mSteps.push_back({ fmt::format("stage {}", name), [this, name]()
+    {
+        if (mStageArmature == nullptr) return true;
+
+        mCubeTextures.push_back(mCaches.cubeTextures.acquire(mStageSkybox + "/Sky"));
+        mCubeTextures.push_back(mCaches.cubeTextures.acquire(mStageSkybox + "/Irradiance"));
+        mCubeTextures.push_back(mCaches.cubeTextures.acquire(mStageSkybox + "/Radiance"));
+
+        mStageDrawItems = sq::DrawItem::load_from_json (
+            fmt::format("assets/stages/{}/Render.json", name), *mStageArmature,
+            mCaches.meshes, mCaches.pipelines, mCaches.textures
+        );
+
+        return true;
+    }});
+}
+
+//============================================================================//
+
+void Preloader::impl_add_entity_steps(String directory, std::vector<String> animationPaths, bool fighter)
+{
+    mSteps.push_back({ fmt::format("{} sounds", directory), [this, directory]()
+    {
+        const auto document = parse_asset_json(fmt::format("assets/{}/Sounds.json", directory));
+
+        for (const auto [_, jSound] : document.root().as<JsonObject>() | views::json_as<JsonObject>)
+        {
+            SoundEffect sound;
+            sound.from_json(jSound, &mCaches.sounds);
+            mSounds.push_back(std::move(sound.handle));
+        }
+
+        return true;
+    }});
+
+    mSteps.push_back({ fmt::format("{} files", directory), [this, directory]()
+    {
+        // data loaded for a previous game can be used as is
+        if (mThread.joinable() == false && mCaches.entityData->find(directory, mOptions.bake_animations) != nullptr)
+            return true;
+
+        return impl_run_on_thread([this, directory]()
+        {
+            auto data = std::make_shared<EntityDefData>(directory, mOptions.bake_animations);
+
+            std::vector<String> keys;
+            append_render_keys(fmt::format("assets/{}/Render.json", directory), keys);
+            prefetch_loose_files(keys);
+
+            mEntityData = std::move(data);
+        });
+    }});
+
+    mSteps.push_back({ fmt::format("{} models", directory), [this]()
+    {
+        if (mEntityData == nullptr) return true;
+
+        mEntityData->load_draw_items(mCaches);
+
+        return true;
+    }});
+
+    mSteps.push_back({ fmt::format("{} animations", directory), [this, animationPaths, fighter]()
+    {
+        if (mEntityData == nullptr) return true;
+
+        const bool done = impl_run_on_thread([this, animationPaths, fighter]()
+        {
+            for (const String& path : animationPaths)
+                mEntityData->load_animations(path, &mCancel);
+
+            // FighterDef expects everything to be loaded if it finds the data
+            if (fighter == true)
+            {
+                mEntityData->load_hurt_blobs();
+                mEntityData->load_actions(&mCancel);
+            }
+        });
+
+        if (done == true)
+        {
+            mEntityData->acquire_effect_assets(mCaches);
+            mCaches.entityData->insert(mEntityData->directory, mEntityData);
+            mEntityData = nullptr;
+        }
+
+        return done;
+    }});
+}
+
+//============================================================================//
+
+void Preloader::update()
+{
+    if (is_finished() == true) return;
+
+    STS_TRACE_ZONE("Preloader::update");
+
+    bool done = true;
+
+    try {
+        done = mSteps[mNextStep].func();
+    }
+    catch (const std::exception& ex) {
+        // the game will try again, and show the same error
+        sq::log_warning("preload {}: {}", mSteps[mNextStep].description, ex.what());
+        mEntityData = nullptr;
+    }
+
+    if (done == true) ++mNextStep;
+}
+
+void Preloader::finish()
+{
+    while (is_finished() == false)
+    {
+        update();
+
+        // nothing else to do on this thread, so just wait for the other one
+        if (mThread.joinable() == true)
+            mThreadDone.wait(false);
+    }
+}
+
+StringView Preloader::get_current_step() const
+{
+    if (is_finished() == true) return {};
+    return mSteps[mNextStep].description;
+}
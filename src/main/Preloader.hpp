@@ -0,0 +1,118 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include "main/GameSetup.hpp"
+#include "main/Resources.hpp"
+
+#include <sqee/objects/Armature.hpp>
+#include <sqee/objects/DrawItem.hpp>
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+namespace sts {
+
+//============================================================================//
+
+/// Loads assets for a game while the menu is still open.
+///
+/// Everything ends up in ResourceCaches and its EntityDataCache, where the
+/// next World will find it. Anything that touches the caches is done one step
+/// per update on the main thread. Everything else, reading and parsing files
+/// and loading animations and fighter actions, is done on another thread
+/// using the WorkerPool.
+///
+/// Resources are kept alive until the preloader is destroyed, which happens
+/// after GameScene has acquired them itself.
+class Preloader final
+{
+public: //====================================================//
+
+    Preloader(const Options& options, ResourceCaches& caches);
+
+    SQEE_COPY_DELETE(Preloader)
+    SQEE_MOVE_DELETE(Preloader)
+
+    ~Preloader();
+
+    //--------------------------------------------------------//
+
+    /// Start loading assets for a setup, cancelling anything still loading.
+    ///
+    /// Does nothing if the stage and fighters are the same as last time.
+    void start(const GameSetup& setup);
+
+    /// Do the next step of loading, call once per update.
+    void update();
+
+    /// Do every remaining step right now, blocking until done.
+    void finish();
+
+    //--------------------------------------------------------//
+
+    bool is_finished() const { return mNextStep == mSteps.size(); }
+
+    size_t get_steps_done() const { return mNextStep; }
+
+    size_t get_step_count() const { return mSteps.size(); }
+
+    /// Description of the step currently being done, or empty if finished.
+    StringView get_current_step() const;
+
+private: //===================================================//
+
+    struct Step
+    {
+        String description;
+
+        /// Do some work, returning true once the step is done.
+        std::function<bool()> func;
+    };
+
+    void impl_cancel();
+
+    /// Start work on mThread if not running, returning true once it has finished.
+    ///
+    /// Throws on the main thread if the work threw.
+    bool impl_run_on_thread(std::function<void()> work);
+
+    void impl_add_stage_steps(TinyString name);
+
+    void impl_add_entity_steps(String directory, std::vector<String> animationPaths, bool fighter);
+
+    //--------------------------------------------------------//
+
+    const Options& mOptions;
+
+    ResourceCaches& mCaches;
+
+    GameSetup mSetup;
+
+    std::vector<Step> mSteps;
+    size_t mNextStep = 0u;
+
+    /// Read from Stage.json on the thread, for acquiring cube textures.
+    String mStageSkybox;
+
+    // held so that nothing gets freed before the game acquires it
+    std::unique_ptr<sq::Armature> mStageArmature;
+    std::vector<sq::DrawItem> mStageDrawItems;
+    std::vector<TextureHandle> mCubeTextures;
+    std::vector<SoundHandle> mSounds;
+
+    /// Entity currently being loaded, not yet in the cache.
+    std::shared_ptr<EntityDefData> mEntityData;
+
+    std::thread mThread;
+    std::atomic<bool> mThreadDone = false;
+    std::atomic<bool> mCancel = false;
+
+    /// Set by the thread if its work threw.
+    String mThreadError;
+};
+
+//============================================================================//
+
+} // namespace sts
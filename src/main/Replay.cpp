@@ -0,0 +1,299 @@
+#include "main/Replay.hpp"
+
+#include <cstring> // memcpy
+#include <filesystem>
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+constexpr const std::array<char, 4u> REPLAY_MAGIC = { 'S', 'T', 'S', 'R' };
+
+// increment whenever the layout changes
+constexpr const uint16_t REPLAY_VERSION = 1u;
+
+// one second of input per chunk
+constexpr const uint REPLAY_CHUNK_TICKS = 48u;
+
+//----------------------------------------------------------------------------//
+
+// the fields that don't come from the controller (float and relative axes) are
+// derived by Controller::tick or the fighter, so they aren't stored
+
+uint32_t pack_buttons(const InputFrame& frame)
+{
+    return uint32_t(frame.pressAttack) << 0 | uint32_t(frame.pressSpecial) << 1 | uint32_t(frame.pressJump) << 2 |
+           uint32_t(frame.pressShield) << 3 | uint32_t(frame.pressGrab) << 4 | uint32_t(frame.holdAttack) << 5 |
+           uint32_t(frame.holdSpecial) << 6 | uint32_t(frame.holdJump) << 7 | uint32_t(frame.holdShield) << 8 |
+           uint32_t(frame.holdGrab) << 9;
+}
+
+uint32_t pack_axes(const InputFrame& frame)
+{
+    return uint32_t(frame.intX + 4) | uint32_t(frame.intY + 4) << 4;
+}
+
+uint32_t pack_extras(const InputFrame& frame)
+{
+    return uint32_t(frame.mashX + 1) | uint32_t(frame.mashY + 1) << 2 |
+           uint32_t(frame.modX + 1) << 4 | uint32_t(frame.modY + 1) << 6;
+}
+
+void unpack_buttons(uint32_t bits, InputFrame& frame)
+{
+    frame.pressAttack = bits >> 0 & 1u; frame.pressSpecial = bits >> 1 & 1u; frame.pressJump = bits >> 2 & 1u;
+    frame.pressShield = bits >> 3 & 1u; frame.pressGrab = bits >> 4 & 1u; frame.holdAttack = bits >> 5 & 1u;
+    frame.holdSpecial = bits >> 6 & 1u; frame.holdJump = bits >> 7 & 1u; frame.holdShield = bits >> 8 & 1u;
+    frame.holdGrab = bits >> 9 & 1u;
+}
+
+void unpack_axes(uint32_t bits, InputFrame& frame)
+{
+    frame.intX = int8_t(int(bits & 15u) - 4);
+    frame.intY = int8_t(int(bits >> 4 & 15u) - 4);
+    frame.floatX = float(frame.intX) * 0.25f;
+    frame.floatY = float(frame.intY) * 0.25f;
+}
+
+void unpack_extras(uint32_t bits, InputFrame& frame)
+{
+    frame.mashX = int8_t(int(bits & 3u) - 1);
+    frame.mashY = int8_t(int(bits >> 2 & 3u) - 1);
+    frame.modX = int8_t(int(bits >> 4 & 3u) - 1);
+    frame.modY = int8_t(int(bits >> 6 & 3u) - 1);
+}
+
+//----------------------------------------------------------------------------//
+
+void write_bits(std::vector<uint8_t>& bytes, uint& bitCount, uint32_t value, uint count)
+{
+    for (uint i = 0u; i < count; ++i, ++bitCount)
+    {
+        if (bitCount % 8u == 0u) bytes.push_back(0u);
+        bytes.back() |= uint8_t((value >> i & 1u) << (bitCount % 8u));
+    }
+}
+
+template <class Type>
+void write_value(std::ofstream& stream, Type value)
+{
+    static_assert(std::is_trivially_copyable_v<Type>);
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(Type));
+}
+
+void write_string(std::ofstream& stream, StringView str)
+{
+    write_value(stream, uint8_t(str.size()));
+    stream.write(str.data(), std::streamsize(str.size()));
+}
+
+} // anonymous namespace
+
+//============================================================================//
+
+ReplayWriter::ReplayWriter(const String& path, const GameSetup& setup, uint32_t seed)
+    : mStream(path, std::ios::binary)
+{
+    if (mStream.good() == false)
+        sq::log_warning("could not open replay file '{}' for writing", path);
+
+    mStream.write(REPLAY_MAGIC.data(), REPLAY_MAGIC.size());
+    write_value(mStream, REPLAY_VERSION);
+
+    write_string(mStream, setup.stage);
+    write_value(mStream, uint8_t(setup.players.size()));
+
+    for (const GameSetup::Player& player : setup.players)
+        write_string(mStream, player.fighter);
+
+    write_value(mStream, seed);
+
+    mPrevious.resize(setup.players.size());
+    mStream.flush();
+}
+
+ReplayWriter::~ReplayWriter()
+{
+    impl_flush_chunk();
+}
+
+//============================================================================//
+
+void ReplayWriter::write_tick(const ReplayTick& frames)
+{
+    SQASSERT(frames.size() == mPrevious.size(), "wrong number of frames");
+
+    for (size_t index = 0u; index < frames.size(); ++index)
+    {
+        const InputFrame& frame = frames[index];
+        const InputFrame& previous = mPrevious[index];
+
+        const uint32_t buttons = pack_buttons(frame), prevButtons = pack_buttons(previous);
+        const uint32_t axes = pack_axes(frame), prevAxes = pack_axes(previous);
+        const uint32_t extras = pack_extras(frame), prevExtras = pack_extras(previous);
+
+        const bool changed = buttons != prevButtons || axes != prevAxes || extras != prevExtras;
+        write_bits(mChunkBytes, mChunkBits, changed, 1u);
+
+        if (changed == false) continue;
+
+        write_bits(mChunkBytes, mChunkBits, buttons != prevButtons, 1u);
+        if (buttons != prevButtons) write_bits(mChunkBytes, mChunkBits, buttons, 10u);
+
+        write_bits(mChunkBytes, mChunkBits, axes != prevAxes, 1u);
+        if (axes != prevAxes) write_bits(mChunkBytes, mChunkBits, axes, 8u);
+
+        write_bits(mChunkBytes, mChunkBits, extras != prevExtras, 1u);
+        if (extras != prevExtras) write_bits(mChunkBytes, mChunkBits, extras, 8u);
+
+        mPrevious[index] = frame;
+    }
+
+    ++mTickCount;
+
+    if (++mChunkTicks == REPLAY_CHUNK_TICKS)
+        impl_flush_chunk();
+}
+
+//============================================================================//
+
+void ReplayWriter::impl_flush_chunk()
+{
+    if (mChunkTicks == 0u) return;
+
+    write_value(mStream, uint16_t(mChunkTicks));
+    write_value(mStream, uint16_t(mChunkBytes.size()));
+    mStream.write(reinterpret_cast<const char*>(mChunkBytes.data()), std::streamsize(mChunkBytes.size()));
+    mStream.flush();
+
+    mChunkBytes.clear();
+    mChunkBits = 0u;
+    mChunkTicks = 0u;
+}
+
+//============================================================================//
+
+ReplayReader::ReplayReader(const String& path)
+{
+    std::ifstream stream(path, std::ios::binary);
+
+    if (stream.good() == false)
+        throw std::runtime_error(fmt::format("could not open replay file '{}'", path));
+
+    mBytes.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+    size_t offset = 0u;
+
+    const auto read_bytes = [&](void* dest, size_t count)
+    {
+        if (offset + count > mBytes.size())
+            throw std::runtime_error(fmt::format("replay file '{}' is truncated", path));
+        std::memcpy(dest, mBytes.data() + offset, count);
+        offset += count;
+    };
+
+    const auto read_string = [&]() -> TinyString
+    {
+        uint8_t length; read_bytes(&length, 1u);
+        // stack strings store their characters inline, with one byte for the terminator
+        if (length >= sizeof(TinyString))
+            throw std::runtime_error(fmt::format("replay file '{}' has an invalid name", path));
+        std::array<char, 256u> buffer; read_bytes(buffer.data(), length);
+        return TinyString(StringView(buffer.data(), length));
+    };
+
+    std::array<char, 4u> magic; read_bytes(magic.data(), 4u);
+    uint16_t version; read_bytes(&version, 2u);
+
+    if (magic != REPLAY_MAGIC)
+        throw std::runtime_error(fmt::format("'{}' is not a replay file", path));
+
+    if (version != REPLAY_VERSION)
+        throw std::runtime_error(fmt::format("replay file '{}' has version {}, expected {}", path, version, REPLAY_VERSION));
+
+    mSetup.stage = read_string();
+
+    uint8_t playerCount; read_bytes(&playerCount, 1u);
+    if (playerCount == 0u || playerCount > MAX_FIGHTERS)
+        throw std::runtime_error(fmt::format("replay file '{}' has {} players", path, playerCount));
+
+    for (uint8_t index = 0u; index < playerCount; ++index)
+        mSetup.players.push_back({read_string()});
+
+    read_bytes(&mSeed, 4u);
+
+    mPrevious.resize(playerCount);
+    mChunkStart = mChunkEnd = offset;
+}
+
+//============================================================================//
+
+bool ReplayReader::read_tick(ReplayTick& frames)
+{
+    if (mChunkTicksLeft == 0u)
+    {
+        // either the end of the file, or a chunk that was only partly written
+        if (mChunkEnd + 4u > mBytes.size()) return false;
+
+        uint16_t tickCount, byteCount;
+        std::memcpy(&tickCount, mBytes.data() + mChunkEnd, 2u);
+        std::memcpy(&byteCount, mBytes.data() + mChunkEnd + 2u, 2u);
+
+        if (mChunkEnd + 4u + byteCount > mBytes.size()) return false;
+
+        mChunkStart = mChunkEnd + 4u;
+        mChunkEnd = mChunkStart + byteCount;
+        mBitOffset = 0u;
+        mChunkTicksLeft = tickCount;
+    }
+
+    const auto read_bits = [this](uint count)
+    {
+        uint32_t result = 0u;
+        for (uint i = 0u; i < count; ++i, ++mBitOffset)
+        {
+            // running off the end of a chunk means the file is corrupt, treat it as zeros
+            const size_t byte = mChunkStart + mBitOffset / 8u;
+            if (byte < mChunkEnd) result |= uint32_t(mBytes[byte] >> (mBitOffset % 8u) & 1u) << i;
+        }
+        return result;
+    };
+
+    for (InputFrame& frame : mPrevious)
+    {
+        if (read_bits(1u) == 0u) continue;
+
+        if (read_bits(1u) != 0u) unpack_buttons(read_bits(10u), frame);
+        if (read_bits(1u) != 0u) unpack_axes(read_bits(8u), frame);
+        if (read_bits(1u) != 0u) unpack_extras(read_bits(8u), frame);
+    }
+
+    --mChunkTicksLeft;
+
+    frames = mPrevious;
+    return true;
+}
+
+//============================================================================//
+
+void sts::remove_old_replays(const String& directory, uint maxCount)
+{
+    std::error_code error;
+
+    std::vector<std::filesystem::path> paths;
+
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+        if (entry.is_regular_file(error) && entry.path().extension() == ".stsr")
+            paths.push_back(entry.path());
+
+    if (paths.size() <= maxCount) return;
+
+    // names are local times, so sorting them puts the oldest first
+    ranges::sort(paths);
+
+    for (size_t i = 0u; i < paths.size() - maxCount; ++i)
+        if (std::filesystem::remove(paths[i], error) == false)
+            sq::log_warning("could not remove old replay '{}'", paths[i].string());
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include "main/GameSetup.hpp"
+
+#include "game/Controller.hpp"
+
+#include <fstream>
+
+namespace sts {
+
+//============================================================================//
+
+/// Input for every player for one tick of a replay.
+using ReplayTick = StackVector<InputFrame, MAX_FIGHTERS>;
+
+//============================================================================//
+
+/// Writes a replay file incrementally while a match is being played.
+///
+/// The file starts with the game setup and rng seed, followed by chunks of
+/// bit packed input. Each frame is stored as a change from the previous frame
+/// for the same player, so held input costs one bit per player per tick.
+/// Chunks are flushed as they fill up, so a crash only loses the last second.
+class ReplayWriter final
+{
+public: //====================================================//
+
+    ReplayWriter(const String& path, const GameSetup& setup, uint32_t seed);
+
+    SQEE_COPY_DELETE(ReplayWriter)
+    SQEE_MOVE_DELETE(ReplayWriter)
+
+    ~ReplayWriter();
+
+    /// Append input for one tick, in player order.
+    void write_tick(const ReplayTick& frames);
+
+    /// Number of ticks written so far.
+    uint32_t get_tick_count() const { return mTickCount; }
+
+private: //===================================================//
+
+    void impl_flush_chunk();
+
+    std::ofstream mStream;
+
+    ReplayTick mPrevious;
+
+    std::vector<uint8_t> mChunkBytes;
+    uint mChunkBits = 0u;
+    uint mChunkTicks = 0u;
+
+    uint32_t mTickCount = 0u;
+};
+
+//============================================================================//
+
+/// Loads a replay file written by ReplayWriter.
+class ReplayReader final
+{
+public: //====================================================//
+
+    /// Load and validate the header, throws std::runtime_error on failure.
+    ReplayReader(const String& path);
+
+    SQEE_COPY_DELETE(ReplayReader)
+    SQEE_MOVE_DELETE(ReplayReader)
+
+    //--------------------------------------------------------//
+
+    const GameSetup& get_setup() const { return mSetup; }
+
+    uint32_t get_seed() const { return mSeed; }
+
+    /// Read input for the next tick, returns false at the end of the replay.
+    bool read_tick(ReplayTick& frames);
+
+private: //===================================================//
+
+    std::vector<uint8_t> mBytes;
+
+    GameSetup mSetup;
+    uint32_t mSeed = 0u;
+
+    ReplayTick mPrevious;
+
+    size_t mChunkStart = 0u;
+    size_t mChunkEnd = 0u;
+    size_t mBitOffset = 0u;
+    uint mChunkTicksLeft = 0u;
+};
+
+//============================================================================//
+
+/// Delete the oldest replay files in a directory, leaving at most maxCount.
+void remove_old_replays(const String& directory, uint maxCount);
+
+//============================================================================//
+
+} // namespace sts
@@ -1,5 +1,6 @@
 #include "main/Resources.hpp"
 
+#include "game/EntityDef.hpp"
 #include "game/VisualEffect.hpp"
 
 #include <sqee/misc/Json.hpp>
@@ -82,6 +83,8 @@ ResourceCaches::ResourceCaches(sq::AudioContext& audio)
         result.load_from_directory("assets/" + key, *this);
         return result;
     });
+
+    entityData = std::make_unique<EntityDataCache>();
 }
 
 ResourceCaches::~ResourceCaches()
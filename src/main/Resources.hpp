@@ -61,6 +61,9 @@ public: //================================================//
 
     sq::PassConfigMap passConfigMap;
 
+    /// Declared after the caches, since it holds handles to their resources.
+    std::unique_ptr<EntityDataCache> entityData;
+
     vk::DescriptorSetLayout bindlessTextureSetLayout;
     vk::DescriptorSet bindlessTextureSet;
 
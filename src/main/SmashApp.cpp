@@ -1,7 +1,9 @@
 #include "main/SmashApp.hpp"
 
+#include "main/AssetArchive.hpp"
 #include "main/Options.hpp"
 #include "main/Resources.hpp"
+#include "main/Tracing.hpp"
 
 #include "editor/EditorScene.hpp"
 #include "main/GameScene.hpp"
@@ -25,8 +27,12 @@ SmashApp::~SmashApp()
 
 //============================================================================//
 
-void SmashApp::initialise(std::vector<String> /*args*/)
+void SmashApp::initialise(std::vector<String> args)
 {
+    // record trace zones from startup, rather than waiting for ctrl+T
+    if (ranges::find(args, "--trace") != args.end())
+        TraceZone::set_enabled(true);
+
     mWindow = std::make_unique<sq::Window> (
         "SuperTuxSmash - Main Menu", Vec2U(1280u, 720u),
         "SuperTuxSmash", Vec3U(0u, 0u, 1u)
@@ -45,6 +51,13 @@ void SmashApp::initialise(std::vector<String> /*args*/)
     mGuiSystem->set_style_colours_supertux();
 
     mOptions = std::make_unique<Options>();
+
+    if (ranges::find(args, "--replays") != args.end())
+        mOptions->record_replays = true;
+
+    // meshes, textures, and sounds are never in the archive, so fail now rather than on first use
+    check_loose_assets();
+
     mResourceCaches = std::make_unique<ResourceCaches>(*mAudioContext);
 
     return_to_main_menu();
@@ -223,6 +236,21 @@ void SmashApp::handle_event(sq::Event event)
             mDebugOverlay->notify(sq::string_concat("debug render set to ", STRINGS[mOptions->render_skeletons]));
         }
 
+        if (data.keyboard.key == Key::T)
+        {
+            // first press starts recording, following presses write the recent history
+            if (TraceZone::is_enabled() == false)
+            {
+                TraceZone::set_enabled(true);
+                mDebugOverlay->notify("tracing started, press again to write trace.json");
+            }
+            else
+            {
+                TraceZone::write_chrome_trace("trace.json");
+                mDebugOverlay->notify("wrote trace.json");
+            }
+        }
+
         if (data.keyboard.key == Key::Num_1)
         {
             constexpr const auto STRINGS = std::array { "false", "true" };
@@ -0,0 +1,133 @@
+#include "main/Tracing.hpp"
+
+#include <sqee/misc/Files.hpp>
+
+#include <chrono>
+#include <mutex>
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+// enough for a few hundred frames of the zones we currently have
+constexpr const size_t RING_CAPACITY = 65536u;
+
+/// One event in a ring, guarded by a sequence lock.
+///
+/// The owning thread may overwrite a slot while write_chrome_trace is reading
+/// it, so every field is atomic, and the reader skips the slot if sequence
+/// changed while it was reading.
+struct TraceSlot
+{
+    /// Index of the event in the slot plus one, or zero while being written.
+    std::atomic<uint64_t> sequence = 0u;
+
+    std::atomic<const char*> name = nullptr;
+    std::atomic<int64_t> begin = 0;
+    std::atomic<int64_t> end = 0;
+};
+
+/// Written only by the owning thread, read by write_chrome_trace.
+struct TraceRing
+{
+    std::array<TraceSlot, RING_CAPACITY> slots;
+    std::atomic<uint64_t> written = 0u;
+    uint threadId = 0u;
+};
+
+// rings are never destroyed, so events from finished threads can still be written out
+std::mutex gRingsMutex;
+std::vector<std::unique_ptr<TraceRing>> gRings;
+
+const std::chrono::steady_clock::time_point gStartTime = std::chrono::steady_clock::now();
+
+TraceRing& get_thread_ring()
+{
+    thread_local TraceRing* ring = nullptr;
+
+    // only locks the first time each thread records a zone
+    if (ring == nullptr)
+    {
+        const auto lock = std::lock_guard(gRingsMutex);
+        ring = gRings.emplace_back(std::make_unique<TraceRing>()).get();
+        ring->threadId = uint(gRings.size());
+    }
+
+    return *ring;
+}
+
+} // anonymous namespace
+
+//============================================================================//
+
+int64_t TraceZone::impl_now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - gStartTime).count();
+}
+
+void TraceZone::impl_record(const char* name, int64_t begin)
+{
+    TraceRing& ring = get_thread_ring();
+
+    const uint64_t index = ring.written.load(std::memory_order_relaxed);
+    const int64_t end = impl_now();
+
+    TraceSlot& slot = ring.slots[index % RING_CAPACITY];
+
+    // readers that see any of the new fields will also see that sequence changed
+    slot.sequence.store(0u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.begin.store(begin, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+
+    slot.sequence.store(index + 1u, std::memory_order_release);
+    ring.written.store(index + 1u, std::memory_order_release);
+}
+
+//============================================================================//
+
+void TraceZone::write_chrome_trace(const String& path)
+{
+    String result = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+    size_t eventCount = 0u;
+
+    const auto lock = std::lock_guard(gRingsMutex);
+
+    for (const auto& ring : gRings)
+    {
+        const uint64_t end = ring->written.load(std::memory_order_acquire);
+        const uint64_t begin = end > RING_CAPACITY ? end - RING_CAPACITY : 0u;
+
+        for (uint64_t index = begin; index < end; ++index)
+        {
+            const TraceSlot& slot = ring->slots[index % RING_CAPACITY];
+
+            // skip events that have been, or are being, overwritten by newer ones
+            if (slot.sequence.load(std::memory_order_acquire) != index + 1u) continue;
+
+            const char* const name = slot.name.load(std::memory_order_relaxed);
+            const int64_t eventBegin = slot.begin.load(std::memory_order_relaxed);
+            const int64_t eventEnd = slot.end.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != index + 1u) continue;
+
+            if (eventCount++ != 0u) result += ",\n";
+
+            // complete events, with times in microseconds
+            fmt::format_to(std::back_inserter(result), "{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                           name, ring->threadId, double(eventBegin) / 1000.0, double(eventEnd - eventBegin) / 1000.0);
+        }
+    }
+
+    result += "\n]}\n";
+
+    sq::write_text_to_file(path, result, true);
+
+    sq::log_info("wrote {} trace events to '{}'", eventCount, path);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include <atomic>
+
+namespace sts {
+
+//============================================================================//
+
+/// Scoped CPU timing zone, for chrome trace output.
+///
+/// Zones are written to a lock free ring buffer owned by the current thread,
+/// which keeps the most recent events. They cost a single relaxed load when
+/// tracing is disabled. Names must be string literals.
+class TraceZone final
+{
+public: //====================================================//
+
+    TraceZone(const char* name)
+        : mName(name), mBegin(sEnabled.load(std::memory_order_relaxed) ? impl_now() : -1) {}
+
+    ~TraceZone() { if (mBegin >= 0) impl_record(mName, mBegin); }
+
+    SQEE_COPY_DELETE(TraceZone)
+    SQEE_MOVE_DELETE(TraceZone)
+
+    //--------------------------------------------------------//
+
+    /// Start or stop recording zones, off by default.
+    static void set_enabled(bool enable) { sEnabled.store(enable, std::memory_order_relaxed); }
+
+    static bool is_enabled() { return sEnabled.load(std::memory_order_relaxed); }
+
+    /// Write events from all threads as chrome trace json, for chrome://tracing or Perfetto.
+    static void write_chrome_trace(const String& path);
+
+private: //===================================================//
+
+    static int64_t impl_now();
+
+    static void impl_record(const char* name, int64_t begin);
+
+    static inline std::atomic<bool> sEnabled = false;
+
+    const char* const mName;
+
+    const int64_t mBegin;
+};
+
+//============================================================================//
+
+} // namespace sts
+
+#define STS_TRACE_ZONE_CONCAT_INNER(A, B) A##B
+#define STS_TRACE_ZONE_CONCAT(A, B) STS_TRACE_ZONE_CONCAT_INNER(A, B)
+
+/// Time the rest of the current scope.
+#define STS_TRACE_ZONE(Name) const sts::TraceZone STS_TRACE_ZONE_CONCAT(traceZone, __LINE__) { Name }
@@ -0,0 +1,121 @@
+#include "main/WorkerPool.hpp"
+
+#include <utility> // exchange
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+// work that starts more work just does it on the same thread
+thread_local bool tIsWorker = false;
+
+} // anonymous namespace
+
+//============================================================================//
+
+WorkerPool::WorkerPool()
+{
+    const uint hardwareThreads = std::thread::hardware_concurrency();
+    const uint workerCount = hardwareThreads > 1u ? hardwareThreads - 1u : 0u;
+
+    for (uint i = 0u; i < workerCount; ++i)
+        mThreads.emplace_back([this]() { impl_worker_loop(); });
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        const auto lock = std::lock_guard(mMutex);
+        mStopping = true;
+    }
+
+    mWakeCondition.notify_all();
+
+    for (std::thread& thread : mThreads)
+        thread.join();
+}
+
+WorkerPool& WorkerPool::get()
+{
+    static WorkerPool pool;
+    return pool;
+}
+
+//============================================================================//
+
+void WorkerPool::parallel_for(size_t count, const std::function<void(size_t)>& func)
+{
+    if (tIsWorker == true || mThreads.empty() == true || count <= 1u)
+    {
+        for (size_t index = 0u; index < count; ++index)
+            func(index);
+        return;
+    }
+
+    const auto batchLock = std::lock_guard(mBatchMutex);
+
+    {
+        const auto lock = std::lock_guard(mMutex);
+        mFunc = &func;
+        mCount = count;
+        mNextIndex = 0u;
+        mBusyWorkers = uint(mThreads.size());
+        ++mGeneration;
+    }
+
+    mWakeCondition.notify_all();
+
+    // make the calling thread count as a worker while it helps, so nested calls don't deadlock
+    tIsWorker = true;
+    impl_run_tasks();
+    tIsWorker = false;
+
+    auto lock = std::unique_lock(mMutex);
+    mDoneCondition.wait(lock, [this]() { return mBusyWorkers == 0u; });
+
+    mFunc = nullptr;
+
+    if (mException != nullptr)
+        std::rethrow_exception(std::exchange(mException, nullptr));
+}
+
+//============================================================================//
+
+void WorkerPool::impl_worker_loop()
+{
+    tIsWorker = true;
+
+    uint64_t generation = 0u;
+
+    while (true)
+    {
+        {
+            auto lock = std::unique_lock(mMutex);
+            mWakeCondition.wait(lock, [&]() { return mStopping == true || mGeneration != generation; });
+            if (mStopping == true) return;
+            generation = mGeneration;
+        }
+
+        impl_run_tasks();
+
+        const auto lock = std::lock_guard(mMutex);
+        if (--mBusyWorkers == 0u)
+            mDoneCondition.notify_one();
+    }
+}
+
+void WorkerPool::impl_run_tasks()
+{
+    for (size_t index; (index = mNextIndex.fetch_add(1u)) < mCount;)
+    {
+        try {
+            (*mFunc)(index);
+        }
+        catch (...) {
+            const auto lock = std::lock_guard(mMutex);
+            if (mException == nullptr) mException = std::current_exception();
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace sts {
+
+//============================================================================//
+
+/// Fixed set of threads for running independent loading work in parallel.
+///
+/// Work must not touch the wren vm or resource caches, since neither are
+/// thread safe. Calls from inside work run on the calling thread.
+class WorkerPool final
+{
+public: //====================================================//
+
+    /// Create one worker for each hardware thread, apart from the caller's.
+    WorkerPool();
+
+    SQEE_COPY_DELETE(WorkerPool)
+    SQEE_MOVE_DELETE(WorkerPool)
+
+    ~WorkerPool();
+
+    /// Pool shared by everything that loads assets.
+    static WorkerPool& get();
+
+    //--------------------------------------------------------//
+
+    /// Call func for each index below count, returning once every call is done.
+    ///
+    /// The calling thread also does work. If any calls throw, the first
+    /// exception is rethrown after the rest have finished.
+    void parallel_for(size_t count, const std::function<void(size_t)>& func);
+
+    uint get_worker_count() const { return uint(mThreads.size()); }
+
+private: //===================================================//
+
+    void impl_worker_loop();
+
+    void impl_run_tasks();
+
+    //--------------------------------------------------------//
+
+    std::vector<std::thread> mThreads;
+
+    /// Held by parallel_for, so only one batch runs at a time.
+    std::mutex mBatchMutex;
+
+    std::mutex mMutex;
+    std::condition_variable mWakeCondition;
+    std::condition_variable mDoneCondition;
+
+    const std::function<void(size_t)>* mFunc = nullptr;
+    size_t mCount = 0u;
+    std::atomic<size_t> mNextIndex = 0u;
+
+    uint64_t mGeneration = 0u;
+    uint mBusyWorkers = 0u;
+    bool mStopping = false;
+
+    std::exception_ptr mException;
+};
+
+//============================================================================//
+
+} // namespace sts
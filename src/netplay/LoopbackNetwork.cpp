@@ -0,0 +1,76 @@
+#include "netplay/LoopbackNetwork.hpp"
+
+using namespace sts;
+
+//============================================================================//
+
+class LoopbackNetwork::Endpoint final : public Transport
+{
+public: //====================================================//
+
+    Endpoint(LoopbackNetwork& network, size_t index) : network(network), index(index) {}
+
+    void send(const InputPacket& packet) override { network.impl_send(index, packet); }
+
+    std::optional<InputPacket> receive() override { return network.impl_receive(index); }
+
+    LoopbackNetwork& network;
+
+    const size_t index;
+};
+
+//============================================================================//
+
+LoopbackNetwork::LoopbackNetwork(const Config& config, uint_fast32_t seed)
+    : mConfig(config), mRandNumGen(seed) {}
+
+LoopbackNetwork::~LoopbackNetwork() = default;
+
+//============================================================================//
+
+Transport& LoopbackNetwork::create_endpoint()
+{
+    return *mEndpoints.emplace_back(std::make_unique<Endpoint>(*this, mEndpoints.size()));
+}
+
+//============================================================================//
+
+void LoopbackNetwork::impl_send(size_t source, const InputPacket& packet)
+{
+    for (size_t destination = 0u; destination < mEndpoints.size(); ++destination)
+    {
+        if (destination == source) continue;
+
+        ++mSentCount;
+
+        if (std::uniform_real_distribution<float>(0.f, 1.f)(mRandNumGen) < mConfig.packetLoss)
+        {
+            ++mDroppedCount;
+            continue;
+        }
+
+        const uint jitter = std::uniform_int_distribution<uint>(0u, mConfig.jitter)(mRandNumGen);
+        mInFlight.push_back({mTime + mConfig.latency + jitter, destination, packet});
+    }
+}
+
+//============================================================================//
+
+std::optional<InputPacket> LoopbackNetwork::impl_receive(size_t destination)
+{
+    // find the earliest message that has arrived, so that only jitter can reorder packets
+    auto result = mInFlight.end();
+
+    for (auto iter = mInFlight.begin(); iter != mInFlight.end(); ++iter)
+        if (iter->destination == destination && iter->deliverTime <= mTime)
+            if (result == mInFlight.end() || iter->deliverTime < result->deliverTime)
+                result = iter;
+
+    if (result == mInFlight.end())
+        return std::nullopt;
+
+    const InputPacket packet = result->packet;
+    mInFlight.erase(result);
+
+    return packet;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include "netplay/Transport.hpp"
+
+#include <random> // mt19937
+
+namespace sts {
+
+//============================================================================//
+
+/// In process network for testing netplay on one machine.
+///
+/// Time is measured in ticks of the network, not real time, so that tests
+/// with artificial latency and packet loss are reproducible.
+class LoopbackNetwork final
+{
+public: //====================================================//
+
+    struct Config
+    {
+        uint latency = 3u;       ///< Ticks before a packet arrives.
+        uint jitter = 1u;        ///< Random extra ticks, may reorder packets.
+        float packetLoss = 0.f;  ///< Chance for each packet to be dropped.
+    };
+
+    LoopbackNetwork(const Config& config, uint_fast32_t seed);
+
+    SQEE_COPY_DELETE(LoopbackNetwork)
+    SQEE_MOVE_DELETE(LoopbackNetwork)
+
+    ~LoopbackNetwork();
+
+    //--------------------------------------------------------//
+
+    /// Add a peer to the network.
+    Transport& create_endpoint();
+
+    /// Advance the network clock by one tick.
+    void tick() { ++mTime; }
+
+    //--------------------------------------------------------//
+
+    uint get_sent_count() const { return mSentCount; }
+
+    uint get_dropped_count() const { return mDroppedCount; }
+
+private: //===================================================//
+
+    class Endpoint;
+
+    struct Message
+    {
+        uint64_t deliverTime;
+        size_t destination;
+        InputPacket packet;
+    };
+
+    void impl_send(size_t source, const InputPacket& packet);
+
+    std::optional<InputPacket> impl_receive(size_t destination);
+
+    //--------------------------------------------------------//
+
+    const Config mConfig;
+
+    std::vector<std::unique_ptr<Endpoint>> mEndpoints;
+
+    std::vector<Message> mInFlight;
+
+    uint64_t mTime = 0u;
+
+    uint mSentCount = 0u;
+    uint mDroppedCount = 0u;
+
+    std::mt19937 mRandNumGen;
+};
+
+//============================================================================//
+
+} // namespace sts
@@ -0,0 +1,223 @@
+#include "netplay/RollbackSession.hpp"
+
+#include "netplay/Transport.hpp"
+
+#include "game/Fighter.hpp"
+#include "game/World.hpp"
+
+using namespace sts;
+
+//============================================================================//
+
+RollbackSession::RollbackSession(World& world, uint8_t localPlayer, Transport& transport)
+    : mWorld(world), mLocalPlayer(localPlayer), mTransport(transport)
+{
+    SQASSERT(localPlayer < world.get_fighters().size(), "invalid local player");
+
+    mPlayers.resize(world.get_fighters().size());
+}
+
+//============================================================================//
+
+uint32_t RollbackSession::get_confirmed_tick() const
+{
+    uint32_t result = mCurrentTick;
+
+    for (const PlayerInput& player : mPlayers)
+        result = std::min(result, player.confirmedUntil);
+
+    return result;
+}
+
+std::optional<uint64_t> RollbackSession::get_confirmed_checksum(uint32_t tick) const
+{
+    if (tick >= get_confirmed_tick() || tick + RING_SIZE < mCurrentTick)
+        return std::nullopt;
+
+    // input for the tick arrived, but the rollback hasn't happened yet
+    if (mRollbackTick.has_value() == true && tick >= *mRollbackTick)
+        return std::nullopt;
+
+    return mChecksums[tick % RING_SIZE];
+}
+
+//============================================================================//
+
+bool RollbackSession::advance(const InputFrame& local)
+{
+    poll();
+
+    if (is_stalled() == true)
+    {
+        ++mStallCount;
+        return false;
+    }
+
+    PlayerInput& player = mPlayers[mLocalPlayer];
+    player.confirmed[mCurrentTick % RING_SIZE] = local;
+    player.confirmedUntil = mCurrentTick + 1u;
+
+    simulate_tick(mCurrentTick, true);
+    ++mCurrentTick;
+
+    // send right away, rather than waiting for the next poll
+    send_input();
+
+    // after sending, so that a pause doesn't delay our input
+    mWorld.collect_garbage();
+
+    return true;
+}
+
+//============================================================================//
+
+void RollbackSession::poll()
+{
+    while (auto packet = mTransport.receive())
+        handle_packet(*packet);
+
+    if (mRollbackTick.has_value() == true)
+    {
+        // the snapshot for the first tick is still valid, so don't save it again
+        mWorld.load_state(mSnapshots[*mRollbackTick % RING_SIZE]);
+
+        // the pose from the last tick gets interpolated from, so it needs every bone
+        for (uint32_t tick = *mRollbackTick; tick < mCurrentTick; ++tick)
+        {
+            mWorld.set_resimulating(tick + 1u < mCurrentTick);
+            simulate_tick(tick, tick != *mRollbackTick);
+        }
+        mWorld.set_resimulating(false);
+
+        ++mRollbackCount;
+        mResimulatedCount += mCurrentTick - *mRollbackTick;
+
+        mRollbackTick.reset();
+    }
+
+    send_input();
+}
+
+//============================================================================//
+
+void RollbackSession::handle_packet(const InputPacket& packet)
+{
+    if (packet.player == mLocalPlayer || packet.player >= mPlayers.size() || packet.count > MAX_ROLLBACK_FRAMES)
+    {
+        sq::log_warning("netplay: ignoring invalid packet from player {}", packet.player);
+        return;
+    }
+
+    PlayerInput& player = mPlayers[packet.player];
+
+    player.ackedUntil = std::max(player.ackedUntil, packet.acks[mLocalPlayer]);
+
+    for (uint8_t index = 0u; index < packet.count; ++index)
+    {
+        const uint32_t tick = packet.firstTick + index;
+
+        // already have this frame from an earlier packet
+        if (tick < player.confirmedUntil) continue;
+
+        // an earlier packet was lost or reordered, wait for it to be resent
+        if (tick > player.confirmedUntil) break;
+
+        const InputFrame& frame = packet.frames[index];
+
+        player.confirmed[tick % RING_SIZE] = frame;
+        player.confirmedUntil = tick + 1u;
+
+        if (tick < mCurrentTick && player.used[tick % RING_SIZE] != frame)
+            if (mRollbackTick.has_value() == false || tick < *mRollbackTick)
+                mRollbackTick = tick;
+    }
+}
+
+//============================================================================//
+
+void RollbackSession::send_input()
+{
+    const PlayerInput& local = mPlayers[mLocalPlayer];
+
+    // resend everything that any peer hasn't acknowledged yet
+    uint32_t firstTick = local.confirmedUntil;
+
+    for (uint8_t index = 0u; index < mPlayers.size(); ++index)
+        if (index != mLocalPlayer)
+            firstTick = std::min(firstTick, mPlayers[index].ackedUntil);
+
+    InputPacket packet;
+    packet.player = mLocalPlayer;
+    packet.firstTick = std::max(firstTick, local.confirmedUntil - std::min(local.confirmedUntil, MAX_ROLLBACK_FRAMES));
+    packet.count = uint8_t(local.confirmedUntil - packet.firstTick);
+
+    for (uint8_t index = 0u; index < mPlayers.size(); ++index)
+        packet.acks[index] = mPlayers[index].confirmedUntil;
+
+    for (uint8_t index = 0u; index < packet.count; ++index)
+        packet.frames[index] = local.confirmed[(packet.firstTick + index) % RING_SIZE];
+
+    // sent even if there are no frames, so that peers get our acks
+    mTransport.send(packet);
+}
+
+//============================================================================//
+
+InputFrame RollbackSession::get_input(uint8_t player, uint32_t tick) const
+{
+    const PlayerInput& input = mPlayers[player];
+
+    if (tick < input.confirmedUntil)
+        return input.confirmed[tick % RING_SIZE];
+
+    if (input.confirmedUntil == 0u)
+        return InputFrame();
+
+    // predict that held buttons and axes stay the same, but not single frame events
+    InputFrame frame = input.confirmed[(input.confirmedUntil - 1u) % RING_SIZE];
+
+    frame.pressAttack = frame.pressSpecial = frame.pressJump = false;
+    frame.pressShield = frame.pressGrab = false;
+    frame.mashX = frame.mashY = frame.relMashX = 0;
+
+    return frame;
+}
+
+//============================================================================//
+
+void RollbackSession::simulate_tick(uint32_t tick, bool saveSnapshot)
+{
+    if (saveSnapshot == true)
+        mWorld.save_state(mSnapshots[tick % RING_SIZE]);
+
+    for (const auto& fighter : mWorld.get_fighters())
+    {
+        const InputFrame frame = get_input(fighter->index, tick);
+        mPlayers[fighter->index].used[tick % RING_SIZE] = frame;
+        fighter->controller->push_frame(frame);
+    }
+
+    mWorld.tick();
+
+    mChecksums[tick % RING_SIZE] = mWorld.get_checksum();
+}
+
+//============================================================================//
+
+bool RollbackSession::is_stalled() const
+{
+    for (uint8_t index = 0u; index < mPlayers.size(); ++index)
+    {
+        if (index == mLocalPlayer) continue;
+
+        // can't predict any further, or can't roll back far enough when input arrives
+        if (mCurrentTick >= mPlayers[index].confirmedUntil + MAX_ROLLBACK_FRAMES)
+            return true;
+
+        // peer hasn't received our input, so would have to stall soon anyway
+        if (mCurrentTick >= mPlayers[index].ackedUntil + MAX_ROLLBACK_FRAMES)
+            return true;
+    }
+
+    return false;
+}
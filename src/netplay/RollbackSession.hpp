@@ -0,0 +1,119 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include "game/Controller.hpp"
+#include "game/StateBuffer.hpp"
+
+namespace sts {
+
+//============================================================================//
+
+/// Runs a World in lockstep with remote peers, predicting their input.
+///
+/// Remote input is predicted by repeating their last known frame. When real
+/// input arrives that differs from what was used, the world is restored to
+/// the snapshot before that tick and the following ticks are simulated again.
+///
+/// Each peer controls exactly one fighter, the one with index localPlayer.
+class RollbackSession final
+{
+public: //====================================================//
+
+    RollbackSession(World& world, uint8_t localPlayer, Transport& transport);
+
+    SQEE_COPY_DELETE(RollbackSession)
+    SQEE_MOVE_DELETE(RollbackSession)
+
+    //--------------------------------------------------------//
+
+    /// Handle received input, then simulate the next tick with local input.
+    ///
+    /// Returns false if remote peers are too far behind, in which case nothing
+    /// was simulated and the same input should be given again next time.
+    bool advance(const InputFrame& local);
+
+    /// Handle received input and resend unacknowledged input, without ticking.
+    void poll();
+
+    //--------------------------------------------------------//
+
+    /// Number of ticks that have been simulated, including predicted ones.
+    uint32_t get_current_tick() const { return mCurrentTick; }
+
+    /// Number of ticks for which input from every player is known.
+    uint32_t get_confirmed_tick() const;
+
+    /// World checksum after simulating a confirmed tick with known input.
+    ///
+    /// Only recent ticks are kept, returns null if the tick isn't confirmed
+    /// yet or is too old.
+    std::optional<uint64_t> get_confirmed_checksum(uint32_t tick) const;
+
+    uint get_rollback_count() const { return mRollbackCount; }
+
+    uint get_resimulated_count() const { return mResimulatedCount; }
+
+    uint get_stall_count() const { return mStallCount; }
+
+private: //===================================================//
+
+    /// Enough to cover every tick between the oldest unconfirmed and newest received.
+    static constexpr uint32_t RING_SIZE = MAX_ROLLBACK_FRAMES * 2u;
+
+    struct PlayerInput
+    {
+        /// Known input, valid for ticks before confirmedUntil.
+        std::array<InputFrame, RING_SIZE> confirmed {};
+
+        /// Input that was actually given to the world, known or predicted.
+        std::array<InputFrame, RING_SIZE> used {};
+
+        /// First tick for which input is not known.
+        uint32_t confirmedUntil = 0u;
+
+        /// First tick of our local input that this player has not received.
+        uint32_t ackedUntil = 0u;
+    };
+
+    //--------------------------------------------------------//
+
+    void handle_packet(const InputPacket& packet);
+
+    void send_input();
+
+    InputFrame get_input(uint8_t player, uint32_t tick) const;
+
+    void simulate_tick(uint32_t tick, bool saveSnapshot);
+
+    bool is_stalled() const;
+
+    //--------------------------------------------------------//
+
+    World& mWorld;
+
+    const uint8_t mLocalPlayer;
+
+    Transport& mTransport;
+
+    StackVector<PlayerInput, MAX_FIGHTERS> mPlayers;
+
+    /// Snapshot of the world before each tick.
+    std::array<StateBuffer, RING_SIZE> mSnapshots;
+
+    /// Checksum of the world after each tick.
+    std::array<uint64_t, RING_SIZE> mChecksums {};
+
+    uint32_t mCurrentTick = 0u;
+
+    /// Earliest tick that needs to be simulated again, if any.
+    std::optional<uint32_t> mRollbackTick;
+
+    uint mRollbackCount = 0u;
+    uint mResimulatedCount = 0u;
+    uint mStallCount = 0u;
+};
+
+//============================================================================//
+
+} // namespace sts
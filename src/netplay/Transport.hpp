@@ -0,0 +1,51 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include "game/Controller.hpp"
+
+namespace sts {
+
+//============================================================================//
+
+/// Input for a range of ticks from one player, sent to every other peer.
+///
+/// Frames are resent until acknowledged, so packets can be lost or reordered.
+struct InputPacket final
+{
+    /// Player that sent the packet.
+    uint8_t player = 0u;
+
+    /// Number of valid entries in frames.
+    uint8_t count = 0u;
+
+    /// Tick of the first entry in frames.
+    uint32_t firstTick = 0u;
+
+    /// First tick of input that the sender has not received, for each player.
+    std::array<uint32_t, MAX_FIGHTERS> acks {};
+
+    std::array<InputFrame, MAX_ROLLBACK_FRAMES> frames {};
+};
+
+static_assert(std::is_trivially_copyable_v<InputPacket>);
+
+//============================================================================//
+
+/// Interface for sending packets between netplay peers.
+class Transport
+{
+public: //====================================================//
+
+    virtual ~Transport() = default;
+
+    /// Send a packet to every other peer.
+    virtual void send(const InputPacket& packet) = 0;
+
+    /// Get the next packet that has arrived, if any.
+    virtual std::optional<InputPacket> receive() = 0;
+};
+
+//============================================================================//
+
+} // namespace sts
@@ -3,6 +3,10 @@
 #include "render/Camera.hpp"
 #include "render/Renderer.hpp"
 
+#include "main/Tracing.hpp"
+
+#include <cstring> // memcpy, memcmp
+
 // notes on bone vs. matrix indices
 //  - bone index:
 //     - first bone is index 0, -1 means none
@@ -16,6 +20,112 @@ using namespace sts;
 
 //============================================================================//
 
+namespace {
+
+template <class Type>
+bool is_valid_track(const std::vector<std::byte>& track, uint frameCount)
+{
+    return track.size() == sizeof(Type) || track.size() == sizeof(Type) * frameCount;
+}
+
+template <class Type>
+void read_track(const std::vector<std::byte>& track, uint frame, Type& out)
+{
+    // constant tracks only store a single key
+    const size_t offset = track.size() == sizeof(Type) ? 0u : sizeof(Type) * frame;
+    std::memcpy(&out, track.data() + offset, sizeof(Type));
+}
+
+} // anonymous namespace
+
+//============================================================================//
+
+bool sts::compute_partial_sample (
+    const sq::Armature& armature, const sq::Animation& animation, float time,
+    const std::vector<uint8_t>& bones, sq::AnimSample& out
+)
+{
+    SQASSERT(out.size() == armature.get_rest_sample().size(), "sample size mismatch");
+
+    // blending between frames is left to the full sample, so that results always match it
+    const uint frame = uint(time);
+    if (float(frame) != time) return false;
+
+    sq::Armature::Bone* outBones = reinterpret_cast<sq::Armature::Bone*>(out.data());
+
+    for (const uint8_t bone : bones)
+    {
+        read_track(animation.tracks[bone * 3u + 0u], frame, outBones[bone].offset);
+        read_track(animation.tracks[bone * 3u + 1u], frame, outBones[bone].rotation);
+        read_track(animation.tracks[bone * 3u + 2u], frame, outBones[bone].scale);
+    }
+
+    return true;
+}
+
+bool sts::validate_partial_sample (
+    const sq::Armature& armature, const sq::Animation& animation, const std::vector<uint8_t>& bones
+)
+{
+    if (animation.tracks.size() < armature.get_bone_count() * 3u) return false;
+
+    for (const uint8_t bone : bones)
+    {
+        if (is_valid_track<Vec3F>(animation.tracks[bone * 3u + 0u], animation.frameCount) == false) return false;
+        if (is_valid_track<QuatF>(animation.tracks[bone * 3u + 1u], animation.frameCount) == false) return false;
+        if (is_valid_track<Vec3F>(animation.tracks[bone * 3u + 2u], animation.frameCount) == false) return false;
+    }
+
+    sq::AnimSample full = armature.get_rest_sample();
+    sq::AnimSample partial = armature.get_rest_sample();
+
+    const auto fullBones = reinterpret_cast<const sq::Armature::Bone*>(full.data());
+    const auto partialBones = reinterpret_cast<const sq::Armature::Bone*>(partial.data());
+
+    for (uint frame = 0u; frame < animation.frameCount; ++frame)
+    {
+        armature.compute_sample(animation, float(frame), full);
+        compute_partial_sample(armature, animation, float(frame), bones, partial);
+
+        for (const uint8_t bone : bones)
+            if (std::memcmp(&fullBones[bone], &partialBones[bone], sizeof(sq::Armature::Bone)) != 0)
+                return false;
+    }
+
+    return true;
+}
+
+//============================================================================//
+
+void Animation::bake(const sq::Armature& armature)
+{
+    const size_t sampleSize = armature.get_rest_sample().size();
+
+    sq::AnimSample sample = armature.get_rest_sample();
+    baked.resize(sampleSize * anim.frameCount);
+
+    for (uint frame = 0u; frame < anim.frameCount; ++frame)
+    {
+        if (compressed.empty() == false) compressed.decompress_frame(frame, sample);
+        else armature.compute_sample(anim, float(frame), sample);
+        std::memcpy(baked.data() + sampleSize * frame, sample.data(), sampleSize);
+    }
+}
+
+bool Animation::sample_baked(float time, sq::AnimSample& out) const
+{
+    // fractional times still need to interpolate between keys
+    const uint frame = uint(time);
+    if (baked.empty() == true || float(frame) != time) return false;
+
+    SQASSERT(frame < anim.frameCount && baked.size() == out.size() * anim.frameCount, "invalid frame or sample");
+
+    std::memcpy(out.data(), baked.data() + out.size() * frame, out.size());
+    return true;
+}
+
+//============================================================================//
+
 AnimPlayer::AnimPlayer(const sq::Armature& armature) : armature(armature)
 {
     previousSample.resize(armature.get_rest_sample().size());
@@ -23,12 +133,32 @@ AnimPlayer::AnimPlayer(const sq::Armature& armature) : armature(armature)
     blendSample.resize(armature.get_rest_sample().size());
 
     debugEnableBlend.resize(armature.get_bone_count(), char(true));
+
+    boneMatrices.resize(armature.get_bone_count());
+    boneMatricesValid.resize(armature.get_bone_count(), char(false));
+}
+
+//============================================================================//
+
+const Mat4F& AnimPlayer::get_bone_matrix(uint8_t bone) const
+{
+    SQASSERT(bone < armature.get_bone_count(), "invalid bone");
+
+    if (bool(boneMatricesValid[bone]) == false)
+    {
+        boneMatrices[bone] = armature.compute_bone_matrix(currentSample, bone);
+        boneMatricesValid[bone] = char(true);
+    }
+
+    return boneMatrices[bone];
 }
 
 //============================================================================//
 
 void AnimPlayer::integrate(Renderer& renderer, const Mat4F& modelMatrix, float bbScaleX, float blend)
 {
+    STS_TRACE_ZONE("AnimPlayer::integrate");
+
     armature.blend_samples(previousSample, currentSample, blend, blendSample);
 
     for (size_t bone = 0u; bone < armature.get_bone_count(); ++bone)
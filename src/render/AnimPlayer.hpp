@@ -2,6 +2,8 @@
 
 #include "setup.hpp"
 
+#include "render/CompressedAnimation.hpp"
+
 #include <sqee/objects/Armature.hpp>
 
 namespace sts {
@@ -13,6 +15,9 @@ struct Animation final
 {
     sq::Animation anim;
 
+    /// Used instead of anim's tracks if not empty, anim still has the frame count.
+    CompressedAnimation compressed;
+
     bool manual{};   ///< Animation time will be updated manually by scripts.
     bool loop{};     ///< Repeat the animation when reaching the end.
     bool motion{};   ///< Extract offset from bone0 and use it to try to move.
@@ -20,14 +25,42 @@ struct Animation final
     bool attach{};   ///< Extract offset from bone0 and move relative to attachPoint.
     bool fallback{}; ///< The animation failed to load and will T-Pose instead.
 
+    /// Full samples for every whole frame in one block, empty if not baked.
+    ///
+    /// Compressed animations are never baked, so that only one copy is kept.
+    std::vector<std::byte> baked;
+
     const SmallString& get_key() const
     {
         return *std::prev(reinterpret_cast<const SmallString*>(this));
     }
+
+    /// Compute and store samples for every whole frame.
+    void bake(const sq::Armature& armature);
+
+    /// Copy a baked sample, returns false if not baked or time isn't a whole frame.
+    bool sample_baked(float time, sq::AnimSample& out) const;
 };
 
 //============================================================================//
 
+/// Sample only some bones of an animation, leaving the rest of out untouched.
+///
+/// Only whole frames are supported, returns false without doing anything for
+/// any other time. Bones must have three tracks each, holding either one key
+/// or one key per frame, check with validate_partial_sample first.
+bool compute_partial_sample (
+    const sq::Armature& armature, const sq::Animation& animation, float time,
+    const std::vector<uint8_t>& bones, sq::AnimSample& out
+);
+
+/// Check that compute_partial_sample gives exactly the same bones as a full sample.
+bool validate_partial_sample (
+    const sq::Armature& armature, const sq::Animation& animation, const std::vector<uint8_t>& bones
+);
+
+//============================================================================//
+
 /// Data required for basic entity animation playback.
 struct AnimPlayer final
 {
@@ -49,6 +82,16 @@ struct AnimPlayer final
     std::vector<char> debugEnableBlend; // chars because std::vector<bool> is cursed
 
     void integrate(Renderer& renderer, const Mat4F& modelMatrix, float bbScaleX, float blend);
+
+    /// Armature space matrix of a bone in currentSample, computed at most once per pose.
+    const Mat4F& get_bone_matrix(uint8_t bone) const;
+
+    /// Must be called whenever currentSample is modified.
+    void invalidate_bone_matrices() { std::fill(boneMatricesValid.begin(), boneMatricesValid.end(), char(false)); }
+
+    // cache for get_bone_matrix, one entry per bone
+    mutable std::vector<Mat4F> boneMatrices;
+    mutable std::vector<char> boneMatricesValid;
 };
 
 //============================================================================//
@@ -0,0 +1,544 @@
+#include "render/CompressedAnimation.hpp"
+
+#include "main/AssetArchive.hpp"
+
+#include <cstring> // memcpy
+#include <fstream>
+#include <numeric> // iota
+#include <sstream>
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+constexpr const std::array<char, 4u> COMPRESSED_MAGIC = { 'S', 'T', 'S', 'A' };
+
+// increment whenever the layout changes
+constexpr const uint16_t COMPRESSED_VERSION = 1u;
+
+// smallest-three components are within this range
+constexpr const float ROTATION_LIMIT = 0.70710678f;
+
+constexpr const uint ROTATION_BITS = 15u;
+constexpr const float ROTATION_MAX = float((1u << ROTATION_BITS) - 1u);
+
+constexpr const float VECTOR_MAX = 65535.f;
+
+// vector tracks start with the minimum and step of each component
+constexpr const size_t VECTOR_HEADER_SIZE = sizeof(float) * 6u;
+
+//----------------------------------------------------------------------------//
+
+uint64_t encode_rotation(const float* quat)
+{
+    uint largest = 0u;
+    for (uint i = 1u; i < 4u; ++i)
+        if (std::abs(quat[i]) > std::abs(quat[largest])) largest = i;
+
+    // the sign of the largest component is kept, so keys stay in the same hemisphere as the source
+    uint64_t bits = uint64_t(largest) | uint64_t(quat[largest] < 0.f) << 2u;
+
+    for (uint i = 0u, shift = 3u; i < 4u; ++i)
+    {
+        if (i == largest) continue;
+        const float normalised = (std::clamp(quat[i], -ROTATION_LIMIT, +ROTATION_LIMIT) / ROTATION_LIMIT + 1.f) * 0.5f;
+        bits |= uint64_t(std::lround(normalised * ROTATION_MAX)) << shift;
+        shift += ROTATION_BITS;
+    }
+
+    return bits;
+}
+
+void decode_rotation(uint64_t bits, float* out)
+{
+    const uint largest = uint(bits & 3u);
+
+    float sumSquares = 0.f;
+
+    for (uint i = 0u, shift = 3u; i < 4u; ++i)
+    {
+        if (i == largest) continue;
+        const float normalised = float(uint(bits >> shift) & ((1u << ROTATION_BITS) - 1u)) / ROTATION_MAX;
+        out[i] = (normalised * 2.f - 1.f) * ROTATION_LIMIT;
+        sumSquares += out[i] * out[i];
+        shift += ROTATION_BITS;
+    }
+
+    const float value = std::sqrt(std::max(1.f - sumSquares, 0.f));
+    out[largest] = (bits >> 2u & 1u) ? -value : value;
+}
+
+//----------------------------------------------------------------------------//
+
+/// Linear interpolation, normalised and along the shortest path for rotations.
+void interpolate_key(const float* a, const float* b, float factor, uint floatCount, bool rotation, float* out)
+{
+    float sign = 1.f;
+
+    if (rotation == true)
+    {
+        float dot = 0.f;
+        for (uint i = 0u; i < 4u; ++i) dot += a[i] * b[i];
+        if (dot < 0.f) sign = -1.f;
+    }
+
+    for (uint i = 0u; i < floatCount; ++i)
+        out[i] = a[i] + (b[i] * sign - a[i]) * factor;
+
+    if (rotation == true)
+    {
+        float length = 0.f;
+        for (uint i = 0u; i < 4u; ++i) length += out[i] * out[i];
+        length = std::sqrt(length);
+        for (uint i = 0u; i < 4u; ++i) out[i] /= length;
+    }
+}
+
+/// Largest difference between two keys, treating q and -q as equal for rotations.
+float key_error(const float* a, const float* b, uint floatCount, bool rotation)
+{
+    float error = 0.f, flippedError = 0.f;
+
+    for (uint i = 0u; i < floatCount; ++i)
+    {
+        error = std::max(error, std::abs(a[i] - b[i]));
+        flippedError = std::max(flippedError, std::abs(a[i] + b[i]));
+    }
+
+    return rotation ? std::min(error, flippedError) : error;
+}
+
+//----------------------------------------------------------------------------//
+
+template <class Type>
+void write_value(std::ofstream& stream, Type value)
+{
+    static_assert(std::is_trivially_copyable_v<Type>);
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(Type));
+}
+
+template <class Type>
+void write_vector(std::ofstream& stream, const std::vector<Type>& vec)
+{
+    static_assert(std::is_trivially_copyable_v<Type>);
+    write_value(stream, uint32_t(vec.size()));
+    stream.write(reinterpret_cast<const char*>(vec.data()), std::streamsize(vec.size() * sizeof(Type)));
+}
+
+} // anonymous namespace
+
+//============================================================================//
+
+CompressedAnimation::Source CompressedAnimation::parse_source(const String& path)
+{
+    std::ifstream stream(path);
+
+    if (stream.good() == false)
+        throw std::runtime_error(fmt::format("could not open animation '{}'", path));
+
+    Source result;
+
+    const auto parse_floats = [&](std::istringstream& line, std::vector<float>& values)
+    {
+        size_t count = 0u;
+        for (float value; line >> value; ++count)
+            values.push_back(value);
+        return count;
+    };
+
+    bool boneSection = false;
+
+    for (String line; std::getline(stream, line);)
+    {
+        if (line.empty() == true || line.front() == '#') continue;
+
+        std::istringstream words(line);
+        String keyword;
+        words >> keyword;
+
+        if (keyword == "FrameCount") words >> result.frameCount;
+
+        else if (keyword == "SECTION")
+        {
+            String section;
+            words >> section;
+            boneSection = section == "BoneTracks";
+        }
+
+        else if (keyword == "TRACK")
+        {
+            if (result.frameCount == 0u)
+                throw std::runtime_error(fmt::format("animation '{}' has a track before its frame count", path));
+
+            String name, property;
+            words >> name >> property;
+
+            SourceTrack& track = result.tracks.emplace_back();
+            track.rotation = boneSection && property == "rotation";
+            track.quantise = boneSection && (property == "offset" || property == "scale");
+
+            // constant tracks have their only key inline
+            if (size_t count = parse_floats(words, track.values); count != 0u)
+            {
+                track.floatCount = uint8_t(count);
+                continue;
+            }
+
+            for (uint frame = 0u; frame < result.frameCount; ++frame)
+            {
+                if (std::getline(stream, line).good() == false)
+                    throw std::runtime_error(fmt::format("animation '{}' ended during track '{} {}'", path, name, property));
+
+                std::istringstream values(line);
+                const size_t count = parse_floats(values, track.values);
+
+                if (frame == 0u) track.floatCount = uint8_t(count);
+                else if (count != track.floatCount)
+                    throw std::runtime_error(fmt::format("animation '{}' has inconsistent keys in track '{} {}'", path, name, property));
+            }
+        }
+    }
+
+    for (const SourceTrack& track : result.tracks)
+    {
+        if (track.rotation == true && track.floatCount != 4u)
+            throw std::runtime_error(fmt::format("animation '{}' has a rotation that isn't a quaternion", path));
+
+        if (track.quantise == true && track.floatCount != 3u)
+            throw std::runtime_error(fmt::format("animation '{}' has an offset or scale that isn't a vector", path));
+    }
+
+    return result;
+}
+
+//============================================================================//
+
+CompressedAnimation CompressedAnimation::compress(const Source& source, float tolerance)
+{
+    SQASSERT(source.frameCount != 0u && source.frameCount <= UINT16_MAX, "invalid frame count");
+
+    CompressedAnimation result;
+    result.mFrameCount = source.frameCount;
+
+    const auto append_data = [&](const void* data, size_t size)
+    {
+        const auto bytes = static_cast<const std::byte*>(data);
+        result.mData.insert(result.mData.end(), bytes, bytes + size);
+    };
+
+    for (const SourceTrack& sourceTrack : source.tracks)
+    {
+        const uint floatCount = sourceTrack.floatCount;
+        const float* const values = sourceTrack.values.data();
+
+        Track track;
+        track.floatCount = uint8_t(floatCount);
+        track.sampleOffset = uint32_t(result.mBaseSample.size());
+        track.dataOffset = uint32_t(result.mData.size());
+
+        // animated tracks overwrite this every frame
+        const auto firstKey = reinterpret_cast<const std::byte*>(values);
+        result.mBaseSample.insert(result.mBaseSample.end(), firstKey, firstKey + sizeof(float) * floatCount);
+
+        //-- constant tracks only need the base sample -------//
+
+        const uint frameCount = uint(sourceTrack.values.size() / floatCount);
+
+        const bool constant = [&]()
+        {
+            for (uint frame = 1u; frame < frameCount; ++frame)
+                if (key_error(values, values + frame * floatCount, floatCount, sourceTrack.rotation) > tolerance)
+                    return false;
+            return true;
+        }();
+
+        if (constant == true) continue;
+
+        //-- quantise every key ------------------------------//
+
+        std::vector<float> decoded(sourceTrack.values.size());
+        std::array<float, 3> rangeMin = {}, rangeStep = {};
+
+        if (sourceTrack.rotation == true)
+        {
+            track.encoding = Encoding::Rotation48;
+
+            for (uint frame = 0u; frame < frameCount; ++frame)
+                decode_rotation(encode_rotation(values + frame * 4u), decoded.data() + frame * 4u);
+        }
+        else if (sourceTrack.quantise == true)
+        {
+            track.encoding = Encoding::Vector48;
+
+            for (uint i = 0u; i < 3u; ++i)
+            {
+                float min = +INFINITY, max = -INFINITY;
+                for (uint frame = 0u; frame < frameCount; ++frame)
+                    min = std::min(min, values[frame * 3u + i]), max = std::max(max, values[frame * 3u + i]);
+
+                rangeMin[i] = min;
+                rangeStep[i] = (max - min) / VECTOR_MAX;
+            }
+
+            for (uint frame = 0u; frame < frameCount; ++frame)
+                for (uint i = 0u; i < 3u; ++i)
+                    decoded[frame * 3u + i] = rangeMin[i] + rangeStep[i] *
+                        (rangeStep[i] == 0.f ? 0.f : std::round((values[frame * 3u + i] - rangeMin[i]) / rangeStep[i]));
+
+            append_data(rangeMin.data(), sizeof(rangeMin));
+            append_data(rangeStep.data(), sizeof(rangeStep));
+        }
+        else decoded = sourceTrack.values;
+
+        //-- drop keys that interpolation can recreate -------//
+
+        std::vector<uint16_t> keyFrames = { 0u };
+
+        if (tolerance > 0.f)
+        {
+            std::array<float, 4> interpolated;
+
+            for (uint start = 0u, end = 2u; end < frameCount; ++end)
+            {
+                for (uint frame = start + 1u; frame < end; ++frame)
+                {
+                    const float factor = float(frame - start) / float(end - start);
+                    interpolate_key (
+                        decoded.data() + start * floatCount, decoded.data() + end * floatCount,
+                        factor, floatCount, sourceTrack.rotation, interpolated.data()
+                    );
+
+                    if (key_error(interpolated.data(), values + frame * floatCount, floatCount, sourceTrack.rotation) > tolerance)
+                    {
+                        start = end - 1u;
+                        keyFrames.push_back(uint16_t(start));
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (tolerance <= 0.f || keyFrames.size() + 1u >= frameCount)
+        {
+            // keeping every key, no need for a table
+            keyFrames.resize(frameCount);
+            std::iota(keyFrames.begin(), keyFrames.end(), uint16_t(0u));
+        }
+        else
+        {
+            keyFrames.push_back(uint16_t(frameCount - 1u));
+            track.keyFramesOffset = uint32_t(result.mKeyFrames.size());
+            result.mKeyFrames.insert(result.mKeyFrames.end(), keyFrames.begin(), keyFrames.end());
+        }
+
+        track.keyCount = uint16_t(keyFrames.size());
+
+        //-- write the remaining keys ------------------------//
+
+        for (const uint16_t frame : keyFrames)
+        {
+            const float* const key = values + frame * floatCount;
+
+            if (track.encoding == Encoding::Rotation48)
+            {
+                const uint64_t bits = encode_rotation(key);
+                const std::array<uint16_t, 3> words = { uint16_t(bits), uint16_t(bits >> 16u), uint16_t(bits >> 32u) };
+                append_data(words.data(), sizeof(words));
+            }
+            else if (track.encoding == Encoding::Vector48)
+            {
+                std::array<uint16_t, 3> words = {};
+                for (uint i = 0u; i < 3u; ++i)
+                    if (rangeStep[i] != 0.f)
+                        words[i] = uint16_t(std::lround((key[i] - rangeMin[i]) / rangeStep[i]));
+                append_data(words.data(), sizeof(words));
+            }
+            else append_data(key, sizeof(float) * floatCount);
+        }
+
+        result.mTracks.push_back(track);
+    }
+
+    return result;
+}
+
+//============================================================================//
+
+void CompressedAnimation::save_to_file(const String& path) const
+{
+    std::ofstream stream(path, std::ios::binary);
+
+    if (stream.good() == false)
+        throw std::runtime_error(fmt::format("could not open '{}' for writing", path));
+
+    stream.write(COMPRESSED_MAGIC.data(), COMPRESSED_MAGIC.size());
+    write_value(stream, COMPRESSED_VERSION);
+
+    write_value(stream, uint32_t(mFrameCount));
+
+    write_vector(stream, mBaseSample);
+    write_vector(stream, mTracks);
+    write_vector(stream, mKeyFrames);
+    write_vector(stream, mData);
+}
+
+CompressedAnimation CompressedAnimation::load_from_file(const String& path)
+{
+    const String bytes = read_asset(path);
+
+    size_t offset = 0u;
+
+    const auto read_bytes = [&](void* dest, size_t count)
+    {
+        if (offset + count > bytes.size())
+            throw std::runtime_error(fmt::format("'{}' is truncated", path));
+        std::memcpy(dest, bytes.data() + offset, count);
+        offset += count;
+    };
+
+    const auto read_value = [&]<class Type>(Type& value) { read_bytes(&value, sizeof(Type)); };
+
+    const auto read_vector = [&]<class Type>(std::vector<Type>& vec)
+    {
+        uint32_t size; read_value(size);
+        if (offset + size * sizeof(Type) > bytes.size())
+            throw std::runtime_error(fmt::format("'{}' is truncated", path));
+        vec.resize(size);
+        read_bytes(vec.data(), size * sizeof(Type));
+    };
+
+    std::array<char, 4u> magic; read_bytes(magic.data(), magic.size());
+    uint16_t version; read_value(version);
+
+    if (magic != COMPRESSED_MAGIC)
+        throw std::runtime_error(fmt::format("'{}' is not a compressed animation", path));
+
+    if (version != COMPRESSED_VERSION)
+        throw std::runtime_error(fmt::format("'{}' has version {}, expected {}", path, version, COMPRESSED_VERSION));
+
+    CompressedAnimation result;
+
+    uint32_t frameCount; read_value(frameCount);
+    result.mFrameCount = frameCount;
+
+    read_vector(result.mBaseSample);
+    read_vector(result.mTracks);
+    read_vector(result.mKeyFrames);
+    read_vector(result.mData);
+
+    // check everything that decompression will index, so that it never has to
+    for (const Track& track : result.mTracks)
+    {
+        const size_t keySize = track.encoding == Encoding::Raw ? sizeof(float) * track.floatCount : 6u;
+        const size_t headerSize = track.encoding == Encoding::Vector48 ? VECTOR_HEADER_SIZE : 0u;
+        const bool reduced = track.keyCount != frameCount;
+
+        if (track.encoding > Encoding::Vector48 || track.floatCount == 0u || track.floatCount > 4u ||
+            (track.encoding == Encoding::Rotation48 && track.floatCount != 4u) ||
+            (track.encoding == Encoding::Vector48 && track.floatCount != 3u) ||
+            track.sampleOffset + sizeof(float) * track.floatCount > result.mBaseSample.size() ||
+            track.keyCount < 2u || track.keyCount > frameCount ||
+            track.dataOffset + headerSize + keySize * track.keyCount > result.mData.size() ||
+            (reduced && track.keyFramesOffset + track.keyCount > result.mKeyFrames.size()))
+            throw std::runtime_error(fmt::format("'{}' has an invalid track", path));
+    }
+
+    return result;
+}
+
+//============================================================================//
+
+bool CompressedAnimation::is_constant_at(size_t sampleOffset) const
+{
+    return std::none_of(mTracks.begin(), mTracks.end(), [&](const Track& track) { return track.sampleOffset == sampleOffset; });
+}
+
+size_t CompressedAnimation::get_memory_usage() const
+{
+    return sizeof(CompressedAnimation) + mBaseSample.size() + mTracks.size() * sizeof(Track) +
+           mKeyFrames.size() * sizeof(uint16_t) + mData.size();
+}
+
+//============================================================================//
+
+void CompressedAnimation::impl_decode_key(const Track& track, uint key, float* out) const
+{
+    if (track.encoding == Encoding::Raw)
+    {
+        const size_t keySize = sizeof(float) * track.floatCount;
+        std::memcpy(out, mData.data() + track.dataOffset + keySize * key, keySize);
+        return;
+    }
+
+    std::array<uint16_t, 3> words;
+
+    if (track.encoding == Encoding::Rotation48)
+    {
+        std::memcpy(words.data(), mData.data() + track.dataOffset + sizeof(words) * key, sizeof(words));
+        decode_rotation(uint64_t(words[0]) | uint64_t(words[1]) << 16u | uint64_t(words[2]) << 32u, out);
+        return;
+    }
+
+    // Encoding::Vector48
+    std::array<float, 6> range;
+    std::memcpy(range.data(), mData.data() + track.dataOffset, VECTOR_HEADER_SIZE);
+    std::memcpy(words.data(), mData.data() + track.dataOffset + VECTOR_HEADER_SIZE + sizeof(words) * key, sizeof(words));
+
+    for (uint i = 0u; i < 3u; ++i)
+        out[i] = range[i] + range[i + 3u] * float(words[i]);
+}
+
+void CompressedAnimation::impl_decode_frame(const Track& track, uint frame, float* out) const
+{
+    if (track.keyCount == mFrameCount) return impl_decode_key(track, frame, out);
+
+    // find the pair of keys around the frame
+    const uint16_t* const keyFrames = mKeyFrames.data() + track.keyFramesOffset;
+    const uint key = uint(std::upper_bound(keyFrames, keyFrames + track.keyCount, uint16_t(frame)) - keyFrames) - 1u;
+
+    if (keyFrames[key] == frame) return impl_decode_key(track, key, out);
+
+    std::array<float, 4> keyA, keyB;
+    impl_decode_key(track, key, keyA.data());
+    impl_decode_key(track, key + 1u, keyB.data());
+
+    const float factor = float(frame - keyFrames[key]) / float(keyFrames[key + 1u] - keyFrames[key]);
+    interpolate_key(keyA.data(), keyB.data(), factor, track.floatCount, track.encoding == Encoding::Rotation48, out);
+}
+
+//============================================================================//
+
+void CompressedAnimation::decompress_frame(uint frame, sq::AnimSample& out) const
+{
+    SQASSERT(frame < mFrameCount, "frame out of range");
+    SQASSERT(out.size() == mBaseSample.size(), "sample size mismatch");
+
+    std::memcpy(out.data(), mBaseSample.data(), mBaseSample.size());
+
+    for (const Track& track : mTracks)
+    {
+        std::array<float, 4> key;
+        impl_decode_frame(track, frame, key.data());
+        std::memcpy(out.data() + track.sampleOffset, key.data(), sizeof(float) * track.floatCount);
+    }
+}
+
+void CompressedAnimation::decompress(const sq::Armature& armature, float time, sq::AnimSample& out) const
+{
+    const uint frameA = uint(time);
+    if (float(frameA) == time) return decompress_frame(frameA, out);
+
+    // looping animations blend from the last frame back to the first
+    const uint frameB = frameA + 1u == mFrameCount ? 0u : frameA + 1u;
+
+    thread_local sq::AnimSample sampleA, sampleB;
+    sampleA.resize(out.size());
+    sampleB.resize(out.size());
+
+    decompress_frame(frameA, sampleA);
+    decompress_frame(frameB, sampleB);
+
+    armature.blend_samples(sampleA, sampleB, time - float(frameA), out);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "setup.hpp"
+
+#include <sqee/objects/Armature.hpp>
+
+namespace sts {
+
+//============================================================================//
+
+/// Animation stored with quantised keys, decompressed straight into samples.
+///
+/// Constant tracks are stored once in a base sample that every frame starts
+/// from. Bone rotations use smallest-three quantisation in 48 bits, bone
+/// offsets and scales use 16 bits per component over the range of each track,
+/// and block tracks are kept as raw floats. Keys that can be recreated by
+/// interpolating their neighbours can optionally be dropped. Files are made
+/// from .sqa files by sts-compress-anims, and are loaded instead of them.
+class CompressedAnimation final
+{
+public: //====================================================//
+
+    /// One track of an animation before compression.
+    struct SourceTrack
+    {
+        uint8_t floatCount = 0u;   ///< Number of floats in each key.
+        bool rotation = false;     ///< Bone rotation, quantised as a quaternion.
+        bool quantise = false;     ///< Bone offset or scale, quantised over its range.
+        std::vector<float> values; ///< One key if constant, otherwise one per frame.
+    };
+
+    /// An animation before compression, in the same order as samples.
+    struct Source
+    {
+        uint frameCount = 0u;
+        std::vector<SourceTrack> tracks;
+    };
+
+    //--------------------------------------------------------//
+
+    /// Parse an animation in the text format written by the blender exporter.
+    static Source parse_source(const String& path);
+
+    /// Compress an animation, only dropping keys if tolerance is greater than zero.
+    static CompressedAnimation compress(const Source& source, float tolerance);
+
+    /// Load a file written by save_to_file, throws on failure.
+    static CompressedAnimation load_from_file(const String& path);
+
+    void save_to_file(const String& path) const;
+
+    //--------------------------------------------------------//
+
+    bool empty() const { return mBaseSample.empty(); }
+
+    uint get_frame_count() const { return mFrameCount; }
+
+    size_t get_sample_size() const { return mBaseSample.size(); }
+
+    /// Check if the track starting at a byte offset in samples never changes.
+    bool is_constant_at(size_t sampleOffset) const;
+
+    /// Approximate number of bytes used by keys and tables.
+    size_t get_memory_usage() const;
+
+    //--------------------------------------------------------//
+
+    /// Decompress a whole frame.
+    void decompress_frame(uint frame, sq::AnimSample& out) const;
+
+    /// Decompress any time, using the armature to blend between frames.
+    void decompress(const sq::Armature& armature, float time, sq::AnimSample& out) const;
+
+private: //===================================================//
+
+    enum class Encoding : uint8_t { Raw, Rotation48, Vector48 };
+
+    /// An animated track, Vector48 data starts with the minimum and step of each component.
+    struct Track
+    {
+        Encoding encoding = Encoding::Raw;
+        uint8_t floatCount = 0u;
+        uint16_t keyCount = 0u;         ///< Number of keys, equal to the frame count unless reduced.
+        uint32_t sampleOffset = 0u;     ///< Byte offset of the track in samples.
+        uint32_t dataOffset = 0u;       ///< Byte offset of the track in mData.
+        uint32_t keyFramesOffset = 0u;  ///< Offset into mKeyFrames, if reduced.
+    };
+
+    void impl_decode_key(const Track& track, uint key, float* out) const;
+
+    void impl_decode_frame(const Track& track, uint frame, float* out) const;
+
+    //--------------------------------------------------------//
+
+    uint mFrameCount = 0u;
+
+    std::vector<std::byte> mBaseSample;
+    std::vector<Track> mTracks;
+    std::vector<uint16_t> mKeyFrames;
+    std::vector<std::byte> mData;
+};
+
+//============================================================================//
+
+} // namespace sts
@@ -1,6 +1,7 @@
 #include "render/Renderer.hpp"
 
 #include "main/Options.hpp"
+#include "main/Tracing.hpp"
 
 #include "render/AnimPlayer.hpp"
 #include "render/Camera.hpp"
@@ -1291,6 +1292,8 @@ void Renderer::integrate_debug(float blend, const World& world)
 
 void Renderer::populate_command_buffer(vk::CommandBuffer cmdbuf)
 {
+    STS_TRACE_ZONE("Renderer::populate_command_buffer");
+
     // query the previous frame timing, reset timestamps, and write start time
     {
         mTimestampQueryPool.swap();
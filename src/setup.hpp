@@ -33,6 +33,7 @@ namespace views = sq::views;
 
 //============================================================================//
 
+struct ActionDefData;
 struct AnimPlayer;
 struct Animation;
 struct ArticleDef;
@@ -40,6 +41,7 @@ struct DebugGui;
 struct Diamond;
 struct Emitter;
 struct EntityDef;
+struct EntityDefData;
 struct Environment;
 struct FighterActionDef;
 struct FighterDef;
@@ -49,30 +51,45 @@ struct HitBlob;
 struct HitBlobDef;
 struct HurtBlob;
 struct HurtBlobDef;
+struct InputPacket;
 struct Ledge;
 struct MoveAttempt;
 struct MoveAttemptSphere;
 struct Options;
+struct ScriptProgress;
 struct SoundEffect;
 struct VisualEffect;
 struct VisualEffectDef;
 
 class Article;
 class Camera;
+class CollisionSystem;
 class Controller;
 class EditorCamera;
 class EditorScene;
 class EffectSystem;
 class Entity;
+class EntityDataCache;
 class Fighter;
 class FighterAction;
 class FighterState;
+class KeyTable;
+class NativeAction;
+class NativeActionRegistry;
 class ParticleSystem;
+class Preloader;
 class Renderer;
+class ReplayReader;
+class ReplayWriter;
 class ResourceCaches;
+class RollbackSession;
+class ScriptProfiler;
 class SmashApp;
 class Stage;
 class StandardCamera;
+class StateBuffer;
+class StateReader;
+class Transport;
 class World;
 
 enum class BlobRegion : int8_t;
@@ -129,6 +146,11 @@ constexpr const float SHIELD_PUSH_HIT_FACTOR = 0.004f;
 
 //============================================================================//
 
+/// Maximum number of ticks that netplay will predict remote input for.
+constexpr const uint32_t MAX_ROLLBACK_FRAMES = 8u;
+
+//============================================================================//
+
 /// Maximum number of particles that can be on screen at once.
 constexpr const size_t MAX_PARTICLES = 8192u;
 
@@ -0,0 +1,285 @@
+// Measure how long each part of a tick takes, with reproducible input.
+//
+// usage: sts-bench [--ticks N] [--warmup N] [--seed N] [--stage NAME] [--json PATH] [--scripts PATH] [--replay PATH] [FIGHTER...]
+//
+// --scripts writes a ScriptProfiler csv, which makes ticks slightly slower.
+
+#include "main/GameSetup.hpp"
+#include "main/AllocationCounter.hpp"
+#include "main/HeadlessGame.hpp"
+#include "main/Replay.hpp"
+
+#include "game/ScriptProfiler.hpp"
+#include "game/World.hpp"
+
+#include <sqee/misc/Files.hpp>
+#include <sqee/misc/Json.hpp>
+
+#include <chrono>
+#include <cstdlib> // malloc, free
+#include <new>
+
+using namespace sts;
+
+//============================================================================//
+
+// count every heap allocation, so that allocation free code stays that way
+
+void* operator new(size_t size)
+{
+    AllocationCounter::increment();
+    if (void* ptr = std::malloc(size == 0u ? 1u : size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+//============================================================================//
+
+namespace {
+
+struct PhaseStats
+{
+    StringView name;
+    std::vector<double> samples;
+
+    double min = 0.0, median = 0.0, p99 = 0.0, max = 0.0;
+
+    void compute()
+    {
+        if (samples.empty() == true) return;
+
+        std::vector<double> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+
+        const auto percentile = [&](double fraction)
+        {
+            const size_t index = size_t(std::ceil(fraction * double(sorted.size())));
+            return sorted[std::clamp<size_t>(index, 1u, sorted.size()) - 1u];
+        };
+
+        min = sorted.front();
+        median = percentile(0.5);
+        p99 = percentile(0.99);
+        max = sorted.back();
+    }
+};
+
+} // anonymous namespace
+
+//============================================================================//
+
+int main(int argc, char** argv)
+{
+    GameSetup setup = GameSetup::get_quickstart();
+
+    uint ticks = 48u * 60u;
+    uint warmup = 48u;
+    uint_fast32_t seed = 0u;
+    String jsonPath;
+    String scriptsPath;
+    String replayPath;
+
+    bool clearedPlayers = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const StringView arg = argv[i];
+
+        if (arg == "--ticks" && i + 1 < argc) ticks = uint(std::stoul(argv[++i]));
+        else if (arg == "--warmup" && i + 1 < argc) warmup = uint(std::stoul(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc) seed = uint_fast32_t(std::stoul(argv[++i]));
+        else if (arg == "--stage" && i + 1 < argc) setup.stage = argv[++i];
+        else if (arg == "--json" && i + 1 < argc) jsonPath = argv[++i];
+        else if (arg == "--scripts" && i + 1 < argc) scriptsPath = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc) replayPath = argv[++i];
+        else if (arg.starts_with("--") == false)
+        {
+            if (clearedPlayers == false)
+                setup.players.clear(), clearedPlayers = true;
+
+            if (setup.players.full() == true)
+            {
+                fmt::print(stderr, "too many fighters, maximum is {}\n", MAX_FIGHTERS);
+                return 1;
+            }
+
+            setup.players.push_back({TinyString(arg)});
+        }
+        else
+        {
+            fmt::print(stderr, "usage: sts-bench [--ticks N] [--warmup N] [--seed N] [--stage NAME] [--json PATH] [--scripts PATH] [--replay PATH] [FIGHTER...]\n");
+            return 1;
+        }
+    }
+
+    if (ticks == 0u)
+    {
+        fmt::print(stderr, "need at least one tick\n");
+        return 1;
+    }
+
+    //--------------------------------------------------------//
+
+    // recorded input replaces the setup, seed, and random input
+    std::unique_ptr<ReplayReader> replay;
+    if (replayPath.empty() == false)
+    {
+        try { replay = std::make_unique<ReplayReader>(replayPath); }
+        catch (const std::exception& ex)
+        {
+            fmt::print(stderr, "{}\n", ex.what());
+            return 1;
+        }
+
+        setup = replay->get_setup();
+        seed = replay->get_seed();
+    }
+
+    HeadlessGame game { setup, seed };
+
+    ReplayTick frames;
+
+    // returns false once the replay has run out
+    const auto tick_game = [&]()
+    {
+        if (replay == nullptr)
+        {
+            game.feed_random_input();
+            game.tick();
+            return true;
+        }
+
+        if (replay->read_tick(frames) == false)
+            return false;
+
+        game.tick(frames);
+        return true;
+    };
+
+    World& world = game.get_world();
+    world.set_measure_timings(true);
+
+    // let scripts and allocations settle before measuring
+    for (uint tick = 0u; tick < warmup; ++tick)
+        tick_game();
+
+    world.get_script_profiler().set_enabled(scriptsPath.empty() == false);
+
+    std::array<PhaseStats, 7u> phases;
+    phases[0].name = "total";
+    phases[1].name = "stage";
+    phases[2].name = "fighters";
+    phases[3].name = "articles";
+    phases[4].name = "collisions";
+    phases[5].name = "effects";
+    phases[6].name = "particles";
+
+    for (PhaseStats& phase : phases)
+        phase.samples.reserve(ticks);
+
+    size_t totalAllocations = 0u, collisionAllocations = 0u;
+    uint64_t wrenAllocations = 0u, wrenAllocatedBytes = 0u;
+
+    for (uint tick = 0u; tick < ticks; ++tick)
+    {
+        const size_t allocations = AllocationCounter::count;
+        const auto start = std::chrono::steady_clock::now();
+        const bool ticked = tick_game();
+        const auto end = std::chrono::steady_clock::now();
+        totalAllocations += AllocationCounter::count - allocations;
+
+        if (ticked == false)
+        {
+            ticks = tick;
+            break;
+        }
+
+        const World::TickTimings& timings = world.get_tick_timings();
+
+        phases[0].samples.push_back(std::chrono::duration<double>(end - start).count());
+        phases[1].samples.push_back(timings.stage);
+        phases[2].samples.push_back(timings.fighters);
+        phases[3].samples.push_back(timings.articles);
+        phases[4].samples.push_back(timings.collisions);
+        phases[5].samples.push_back(timings.effects);
+        phases[6].samples.push_back(timings.particles);
+
+        collisionAllocations += timings.collisionAllocations;
+        wrenAllocations += timings.wrenAllocations;
+        wrenAllocatedBytes += timings.wrenAllocatedBytes;
+    }
+
+    if (ticks == 0u)
+    {
+        fmt::print(stderr, "replay is shorter than warmup\n");
+        return 1;
+    }
+
+    for (PhaseStats& phase : phases)
+        phase.compute();
+
+    //--------------------------------------------------------//
+
+    const auto fighterNames = views::transform(setup.players, [](auto& player) { return player.fighter; });
+
+    fmt::print("{} on {}, {} ticks after {} warmup, seed {}\n", fmt::join(fighterNames, " vs. "), setup.stage, ticks, warmup, seed);
+    fmt::print("{:<12}{:>12}{:>12}{:>12}{:>12}\n", "phase (us)", "min", "median", "p99", "max");
+
+    for (const PhaseStats& phase : phases)
+        fmt::print("{:<12}{:>12.2f}{:>12.2f}{:>12.2f}{:>12.2f}\n", phase.name,
+                   phase.min * 1e6, phase.median * 1e6, phase.p99 * 1e6, phase.max * 1e6);
+
+    const double allocationsPerTick = double(totalAllocations) / double(ticks);
+    const double collisionAllocationsPerTick = double(collisionAllocations) / double(ticks);
+
+    fmt::print("allocations per tick: {:.2f} total, {:.2f} in collisions\n", allocationsPerTick, collisionAllocationsPerTick);
+
+    const double wrenAllocationsPerTick = double(wrenAllocations) / double(ticks);
+    const double wrenBytesPerTick = double(wrenAllocatedBytes) / double(ticks);
+
+    fmt::print("wren per tick: {:.2f} allocations, {:.0f} bytes, peak heap {} bytes\n", wrenAllocationsPerTick, wrenBytesPerTick, world.wrenPool.get_peak_bytes());
+
+    if (jsonPath.empty() == false)
+    {
+        auto document = JsonMutDocument();
+        auto json = document.assign(JsonMutObject(document));
+
+        json.append("stage", StringView(setup.stage));
+        json.append("ticks", ticks);
+        json.append("warmup", warmup);
+        json.append("seed", uint(seed));
+
+        auto jsonFighters = json.append("fighters", JsonMutArray(document));
+        for (const TinyString& name : fighterNames)
+            jsonFighters.append(StringView(name));
+
+        // all values are in seconds
+        auto jsonPhases = json.append("phases", JsonMutObject(document));
+        for (const PhaseStats& phase : phases)
+        {
+            auto jsonPhase = jsonPhases.append(phase.name, JsonMutObject(document));
+            jsonPhase.append("min", phase.min);
+            jsonPhase.append("median", phase.median);
+            jsonPhase.append("p99", phase.p99);
+            jsonPhase.append("max", phase.max);
+        }
+
+        auto jsonAllocations = json.append("allocationsPerTick", JsonMutObject(document));
+        jsonAllocations.append("total", allocationsPerTick);
+        jsonAllocations.append("collisions", collisionAllocationsPerTick);
+
+        auto jsonWren = json.append("wrenPerTick", JsonMutObject(document));
+        jsonWren.append("allocations", wrenAllocationsPerTick);
+        jsonWren.append("bytes", wrenBytesPerTick);
+
+        sq::write_text_to_file(jsonPath, json.dump(true), true);
+    }
+
+    if (scriptsPath.empty() == false)
+        sq::write_text_to_file(scriptsPath, world.get_script_profiler().to_csv(), true);
+
+    return 0;
+}
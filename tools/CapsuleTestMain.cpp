@@ -0,0 +1,150 @@
+// Test CapsuleArray::intersect against maths::intersect_capsule_capsule with
+// random capsules, and fail if they ever disagree.
+//
+// usage: sts-capsule-test [--count N] [--seed N]
+//
+// As well as fully random capsules, this makes the cases that the batched
+// kernel handles without branches: zero length segments, parallel and
+// collinear axes, and capsules that only just touch.
+
+#include "game/CapsuleArray.hpp"
+
+#include <sqee/maths/Culling.hpp>
+
+#include <array>
+#include <random>
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+// more than one vector of lanes, and not a multiple of any vector size
+constexpr const size_t ARRAY_SIZE = 13u;
+
+struct CapsuleMaker
+{
+    std::mt19937 gen;
+
+    float position() { return std::uniform_real_distribution(-20.f, 20.f)(gen); }
+    float radius() { return std::uniform_real_distribution(0.05f, 1.5f)(gen); }
+    float offset() { return std::uniform_real_distribution(-0.5f, 0.5f)(gen); }
+
+    maths::Capsule random()
+    {
+        maths::Capsule result;
+        result.originA = Vec3F(position(), position(), position());
+        result.originB = Vec3F(position(), position(), position());
+        result.radius = radius();
+        return result;
+    }
+
+    /// Make a capsule like other, to test against it.
+    maths::Capsule related(const maths::Capsule& other)
+    {
+        maths::Capsule result = random();
+        const Vec3F axis = other.originB - other.originA;
+
+        switch (std::uniform_int_distribution(0, 6)(gen))
+        {
+        case 0: // zero length
+            result.originB = result.originA;
+            break;
+
+        case 1: // parallel, nearby
+            result.originA = other.originA + Vec3F(offset(), offset(), offset());
+            result.originB = result.originA + axis * 1.3f;
+            break;
+
+        case 2: // anti parallel, nearby
+            result.originA = other.originA + Vec3F(offset(), offset(), offset());
+            result.originB = result.originA - axis * 0.7f;
+            break;
+
+        case 3: // collinear, overlapping or not
+            result.originA = other.originA + axis * std::uniform_real_distribution(-1.5f, 1.5f)(gen);
+            result.originB = result.originA + axis * 0.5f;
+            break;
+
+        case 4: // zero length at the same point
+            result.originA = result.originB = other.originA;
+            break;
+
+        case 5: // just touching, or very nearly
+        {
+            const Vec3F point = other.originA + axis * 0.5f;
+            const Vec3F normal = maths::normalize(Vec3F(offset(), offset(), offset() + 1.f));
+            const float distance = other.radius + result.radius + std::uniform_real_distribution(-1e-4f, 1e-4f)(gen);
+            result.originA = result.originB = point + normal * distance;
+            break;
+        }
+
+        default: break; // fully random
+        }
+
+        return result;
+    }
+};
+
+} // anonymous namespace
+
+//============================================================================//
+
+int main(int argc, char** argv)
+{
+    uint count = 200000u;
+    uint_fast32_t seed = 0u;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const StringView arg = argv[i];
+
+        if (arg == "--count" && i + 1 < argc) count = uint(std::stoul(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc) seed = uint_fast32_t(std::stoul(argv[++i]));
+        else
+        {
+            fmt::print(stderr, "usage: sts-capsule-test [--count N] [--seed N]\n");
+            return 1;
+        }
+    }
+
+    //--------------------------------------------------------//
+
+    CapsuleMaker maker { std::mt19937(seed) };
+
+    CapsuleArray capsules;
+    std::array<uint8_t, ARRAY_SIZE> results;
+
+    uint failures = 0u;
+
+    for (uint iteration = 0u; iteration < count; ++iteration)
+    {
+        maths::Capsule capsule = maker.random();
+        if (iteration % 4u == 0u) capsule.originB = capsule.originA;
+
+        capsules.clear();
+        for (size_t i = 0u; i < ARRAY_SIZE; ++i)
+            capsules.push_back(maker.related(capsule));
+
+        // test both argument orders, since the fallback for borderline contacts depends on it
+        for (const bool arrayFirst : { false, true })
+        {
+            capsules.intersect(capsule, 0u, ARRAY_SIZE, results.data(), arrayFirst);
+
+            for (size_t i = 0u; i < ARRAY_SIZE; ++i)
+            {
+                const maths::Capsule other = capsules.get(i);
+                const bool expected = arrayFirst ? maths::intersect_capsule_capsule(other, capsule) : maths::intersect_capsule_capsule(capsule, other);
+
+                if (bool(results[i]) != expected && ++failures <= 10u)
+                    fmt::print ( "iteration {}, lane {}, arrayFirst {}: expected {}, got {}\n",
+                                 iteration, i, arrayFirst, expected, results[i] );
+            }
+        }
+    }
+
+    fmt::print("{} of {} tests differ\n", failures, count * ARRAY_SIZE * 2u);
+
+    return failures == 0u ? 0 : 1;
+}
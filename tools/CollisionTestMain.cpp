@@ -0,0 +1,87 @@
+// Run a game with CollisionSystem checking every tick against the collision
+// pass from before it existed, and fail if they ever choose different blobs.
+//
+// usage: sts-collision-test [--ticks N] [--seed N] [--replay PATH]
+//
+// Without a replay, every fighter gets pseudo random input from the seed, so
+// the same ticks are repeated every run.
+
+#include "main/GameSetup.hpp"
+#include "main/HeadlessGame.hpp"
+#include "main/Replay.hpp"
+
+#include "game/CollisionSystem.hpp"
+#include "game/World.hpp"
+
+using namespace sts;
+
+//============================================================================//
+
+int main(int argc, char** argv)
+{
+    GameSetup setup = GameSetup::get_quickstart();
+
+    uint ticks = 7200u;
+    uint_fast32_t seed = 0u;
+    String replayPath;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const StringView arg = argv[i];
+
+        if (arg == "--ticks" && i + 1 < argc) ticks = uint(std::stoul(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc) seed = uint_fast32_t(std::stoul(argv[++i]));
+        else if (arg == "--replay" && i + 1 < argc) replayPath = argv[++i];
+        else
+        {
+            fmt::print(stderr, "usage: sts-collision-test [--ticks N] [--seed N] [--replay PATH]\n");
+            return 1;
+        }
+    }
+
+    //--------------------------------------------------------//
+
+    // recorded input replaces the setup, seed, and random input
+    std::unique_ptr<ReplayReader> replay;
+    if (replayPath.empty() == false)
+    {
+        try { replay = std::make_unique<ReplayReader>(replayPath); }
+        catch (const std::exception& ex)
+        {
+            fmt::print(stderr, "{}\n", ex.what());
+            return 1;
+        }
+
+        setup = replay->get_setup();
+        seed = replay->get_seed();
+    }
+
+    HeadlessGame game { setup, seed };
+
+    CollisionSystem& collisions = game.get_world().get_collision_system();
+    collisions.set_check_reference(true);
+
+    ReplayTick frames;
+    uint failures = 0u;
+
+    for (uint tick = 0u; tick < ticks; ++tick)
+    {
+        if (replay == nullptr)
+        {
+            game.feed_random_input();
+            game.tick();
+        }
+        else if (replay->read_tick(frames) == true)
+            game.tick(frames);
+
+        else break;
+
+        // only report the first few, since one difference usually leads to more
+        if (collisions.get_reference_mismatches() != failures && ++failures <= 10u)
+            fmt::print("tick {}: collisions differ from the reference\n", tick);
+    }
+
+    fmt::print("{} ticks with different collisions\n", failures);
+
+    return failures == 0u ? 0 : 1;
+}
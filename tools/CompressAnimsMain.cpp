@@ -0,0 +1,149 @@
+// Compress every .sqa animation in some directories, writing a .stsa next to each one.
+//
+// usage: sts-compress-anims [--tolerance X] DIRECTORY...
+//
+// Each directory should be the anims directory of a fighter or article, with
+// Armature.json in its parent. Tolerance is the largest error allowed when
+// dropping keys, zero keeps every key. Every compressed animation is checked
+// against the original before it's written.
+
+#include "render/CompressedAnimation.hpp"
+
+#include <sqee/objects/Armature.hpp>
+
+#include <filesystem>
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+/// Largest difference between samples, treating q and -q as equal for rotations.
+float compare_samples(const CompressedAnimation::Source& source, const sq::AnimSample& a, const sq::AnimSample& b)
+{
+    const float* floatsA = reinterpret_cast<const float*>(a.data());
+    const float* floatsB = reinterpret_cast<const float*>(b.data());
+
+    float result = 0.f;
+
+    for (const auto& track : source.tracks)
+    {
+        float error = 0.f, flippedError = 0.f;
+        for (uint i = 0u; i < track.floatCount; ++i)
+        {
+            error = std::max(error, std::abs(floatsA[i] - floatsB[i]));
+            flippedError = std::max(flippedError, std::abs(floatsA[i] + floatsB[i]));
+        }
+
+        result = std::max(result, track.rotation ? std::min(error, flippedError) : error);
+        floatsA += track.floatCount;
+        floatsB += track.floatCount;
+    }
+
+    return result;
+}
+
+} // anonymous namespace
+
+//============================================================================//
+
+int main(int argc, char** argv)
+{
+    float tolerance = 0.f;
+    std::vector<String> directories;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const StringView arg = argv[i];
+
+        if (arg == "--tolerance" && i + 1 < argc) tolerance = std::stof(argv[++i]);
+        else directories.emplace_back(arg);
+    }
+
+    if (directories.empty() == true)
+    {
+        fmt::print(stderr, "usage: sts-compress-anims [--tolerance X] DIRECTORY...\n");
+        return 1;
+    }
+
+    // quantisation alone can give errors this large
+    const float maxError = tolerance + 0.001f;
+
+    size_t totalSourceBytes = 0u, totalFileBytes = 0u, totalMemoryBytes = 0u;
+
+    try
+    {
+        for (const std::filesystem::path directory : directories)
+        {
+            const auto armature = sq::Armature((directory.parent_path() / "Armature.json").string());
+
+            std::vector<std::filesystem::path> paths;
+            for (const auto& entry : std::filesystem::directory_iterator(directory))
+                if (entry.path().extension() == ".sqa") paths.push_back(entry.path());
+
+            std::sort(paths.begin(), paths.end());
+
+            for (const std::filesystem::path& path : paths)
+            {
+                const auto pathNoExt = (directory / path.stem()).string();
+
+                const auto source = CompressedAnimation::parse_source(path.string());
+                const auto compressed = CompressedAnimation::compress(source, tolerance);
+
+                if (compressed.get_sample_size() != armature.get_rest_sample().size())
+                    throw std::runtime_error(fmt::format("'{}' doesn't match armature", path.string()));
+
+                //-- check every frame against the original ----------//
+
+                const auto original = armature.load_animation_from_file(pathNoExt);
+
+                sq::AnimSample expected = armature.get_rest_sample();
+                sq::AnimSample actual = armature.get_rest_sample();
+
+                float worstError = 0.f;
+
+                for (uint frame = 0u; frame < source.frameCount; ++frame)
+                {
+                    armature.compute_sample(original, float(frame), expected);
+                    compressed.decompress_frame(frame, actual);
+                    worstError = std::max(worstError, compare_samples(source, expected, actual));
+                }
+
+                if (worstError > maxError)
+                    throw std::runtime_error(fmt::format("'{}' has error {}, more than {}", path.string(), worstError, maxError));
+
+                //-- write and report sizes --------------------------//
+
+                compressed.save_to_file(pathNoExt + ".stsa");
+
+                size_t sourceBytes = 0u;
+                for (const auto& track : source.tracks)
+                    sourceBytes += track.values.size() * sizeof(float);
+
+                const size_t fileBytes = std::filesystem::file_size(pathNoExt + ".stsa");
+
+                fmt::print (
+                    "{}: {} -> {} bytes, error {:.6f}\n",
+                    pathNoExt, sourceBytes, compressed.get_memory_usage(), worstError
+                );
+
+                totalSourceBytes += sourceBytes;
+                totalFileBytes += fileBytes;
+                totalMemoryBytes += compressed.get_memory_usage();
+            }
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        fmt::print(stderr, "{}\n", ex.what());
+        return 1;
+    }
+
+    fmt::print (
+        "total: {} KiB of float tracks, {} KiB compressed in memory, {} KiB of files\n",
+        totalSourceBytes / 1024u, totalMemoryBytes / 1024u, totalFileBytes / 1024u
+    );
+
+    return 0;
+}
@@ -0,0 +1,250 @@
+// Find the first tick where two runs of the same replay diverge, and show what changed.
+//
+// usage: sts-desync REPLAY                   compare two runs in this process
+//        sts-desync REPLAY --other PROGRAM   compare with sts-desync from another build
+//        sts-desync REPLAY --checksum-at N   print the checksum after N ticks
+//        sts-desync REPLAY --dump-at N       print checksum fields after N ticks
+
+#include "main/HeadlessGame.hpp"
+#include "main/Replay.hpp"
+
+#include "game/World.hpp"
+
+#include <cstdio> // popen
+#include <functional>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+/// One run of a replay from the start.
+class ReplayRun final
+{
+public: //====================================================//
+
+    ReplayRun(const String& path) : mReplay(path), mGame(mReplay.get_setup(), mReplay.get_seed()) {}
+
+    /// Tick once, returns false at the end of the replay.
+    bool tick()
+    {
+        if (mReplay.read_tick(mFrames) == false) return false;
+        mGame.tick(mFrames);
+        ++mTickCount;
+        return true;
+    }
+
+    /// Tick until count ticks have been done in total, returns false if the replay is too short.
+    bool run_to(uint count)
+    {
+        while (mTickCount < count)
+            if (tick() == false) return false;
+        return true;
+    }
+
+    const World& get_world() { return mGame.get_world(); }
+
+private: //===================================================//
+
+    ReplayReader mReplay;
+    HeadlessGame mGame;
+    ReplayTick mFrames;
+    uint mTickCount = 0u;
+};
+
+//----------------------------------------------------------------------------//
+
+/// Run a command and return everything it printed.
+std::optional<String> run_command(const String& command)
+{
+    FILE* pipe = popen(command.c_str(), "r");
+    if (pipe == nullptr) return std::nullopt;
+
+    String result;
+    std::array<char, 4096u> buffer;
+    while (size_t count = std::fread(buffer.data(), 1u, buffer.size(), pipe))
+        result.append(buffer.data(), count);
+
+    if (pclose(pipe) != 0) return std::nullopt;
+    return result;
+}
+
+//----------------------------------------------------------------------------//
+
+/// Print lines that differ between two field dumps.
+void print_field_diff(StringView dumpA, StringView dumpB)
+{
+    const auto split_lines = [](StringView str)
+    {
+        std::vector<StringView> result;
+        for (size_t start = 0u, end; start < str.size(); start = end + 1u)
+        {
+            end = str.find('\n', start);
+            if (end == StringView::npos) end = str.size();
+            result.push_back(str.substr(start, end - start));
+        }
+        return result;
+    };
+
+    const auto linesA = split_lines(dumpA), linesB = split_lines(dumpB);
+
+    // fields are always visited in the same order, only the set of blobs and articles can change
+    for (size_t index = 0u; index < std::max(linesA.size(), linesB.size()); ++index)
+    {
+        const StringView lineA = index < linesA.size() ? linesA[index] : "<missing>";
+        const StringView lineB = index < linesB.size() ? linesB[index] : "<missing>";
+
+        if (lineA != lineB)
+            fmt::print("  A: {}\n  B: {}\n", lineA, lineB);
+    }
+}
+
+} // anonymous namespace
+
+//============================================================================//
+
+int main(int argc, char** argv)
+{
+    if (argc != 2 && argc != 4)
+    {
+        fmt::print(stderr, "usage: sts-desync REPLAY [--other PROGRAM | --checksum-at N | --dump-at N]\n");
+        return 1;
+    }
+
+    const String replayPath = argv[1];
+    const StringView mode = argc == 4 ? StringView(argv[2]) : StringView();
+    const String modeArg = argc == 4 ? String(argv[3]) : String();
+
+    try
+    {
+        //-- queries used when comparing builds --------------//
+
+        if (mode == "--checksum-at" || mode == "--dump-at")
+        {
+            ReplayRun run { replayPath };
+
+            if (run.run_to(uint(std::stoul(modeArg))) == false)
+            {
+                fmt::print(stderr, "replay is shorter than {} ticks\n", modeArg);
+                return 1;
+            }
+
+            if (mode == "--checksum-at") fmt::print("{:016x}\n", run.get_world().get_checksum());
+            else fmt::print("{}", run.get_world().dump_checksum_fields());
+
+            return 0;
+        }
+
+        //-- record checksums of every tick for this build ---//
+
+        std::vector<uint64_t> checksums;
+        {
+            ReplayRun run { replayPath };
+            while (run.tick() == true)
+                checksums.push_back(run.get_world().get_checksum());
+        }
+
+        const uint tickCount = uint(checksums.size());
+        fmt::print("replay has {} ticks\n", tickCount);
+
+        //-- get checksums for the other run -----------------//
+
+        std::function<std::optional<uint64_t>(uint)> get_other_checksum;
+        std::function<std::optional<String>(uint)> get_other_dump;
+
+        std::vector<uint64_t> otherChecksums;
+
+        if (mode == "--other")
+        {
+            const String base = fmt::format("\"{}\" \"{}\"", modeArg, replayPath);
+
+            // each query replays from the start, so only log2(ticks) of them are done
+            get_other_checksum = [&](uint tick) -> std::optional<uint64_t>
+            {
+                const auto output = run_command(fmt::format("{} --checksum-at {}", base, tick + 1u));
+                if (output.has_value() == false) return std::nullopt;
+                return std::stoull(*output, nullptr, 16);
+            };
+
+            get_other_dump = [&](uint tick)
+            {
+                return run_command(fmt::format("{} --dump-at {}", base, tick + 1u));
+            };
+        }
+        else if (mode.empty() == true)
+        {
+            ReplayRun run { replayPath };
+            while (run.tick() == true)
+                otherChecksums.push_back(run.get_world().get_checksum());
+
+            get_other_checksum = [&](uint tick) -> std::optional<uint64_t>
+            {
+                if (tick >= otherChecksums.size()) return std::nullopt;
+                return otherChecksums[tick];
+            };
+
+            get_other_dump = [&](uint tick) -> std::optional<String>
+            {
+                ReplayRun other { replayPath };
+                other.run_to(tick + 1u);
+                return other.get_world().dump_checksum_fields();
+            };
+        }
+        else
+        {
+            fmt::print(stderr, "unknown option '{}'\n", mode);
+            return 1;
+        }
+
+        //-- binary search for the first divergent tick ------//
+
+        const auto diverged = [&](uint tick)
+        {
+            const auto other = get_other_checksum(tick);
+            if (other.has_value() == false)
+                throw std::runtime_error(fmt::format("could not get checksum for tick {} from other run", tick));
+            return *other != checksums[tick];
+        };
+
+        if (tickCount == 0u || diverged(tickCount - 1u) == false)
+        {
+            fmt::print("no desync, final checksum {:016x}\n", tickCount ? checksums.back() : uint64_t(0u));
+            return 0;
+        }
+
+        // checksums are rolling, so once diverged they stay diverged
+        uint low = 0u, high = tickCount - 1u;
+        while (low < high)
+        {
+            const uint middle = low + (high - low) / 2u;
+            if (diverged(middle) == true) high = middle;
+            else low = middle + 1u;
+        }
+
+        fmt::print("first desync after tick {}\n", low + 1u);
+
+        //-- show which fields differ ------------------------//
+
+        ReplayRun run { replayPath };
+        run.run_to(low + 1u);
+
+        const auto otherDump = get_other_dump(low);
+        if (otherDump.has_value() == false)
+            throw std::runtime_error("could not get fields from other run");
+
+        print_field_diff(run.get_world().dump_checksum_fields(), *otherDump);
+
+        return 2;
+    }
+    catch (const std::exception& ex)
+    {
+        fmt::print(stderr, "{}\n", ex.what());
+        return 1;
+    }
+}
@@ -0,0 +1,162 @@
+// Run two rollback peers over a simulated network, and check that their world
+// checksums agree for every confirmed tick.
+//
+// usage: sts-netplay-test [--ticks N] [--seed N] [--latency N] [--jitter N] [--loss F]
+
+#include "main/GameSetup.hpp"
+#include "main/HeadlessGame.hpp"
+
+#include "netplay/LoopbackNetwork.hpp"
+#include "netplay/RollbackSession.hpp"
+
+#include "game/Controller.hpp"
+#include "game/World.hpp"
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+struct Peer
+{
+    Peer(const GameSetup& setup, uint_fast32_t seed, uint8_t player, Transport& transport)
+        : game(setup, seed), input(seed + 100u + player), session(game.get_world(), player, transport) {}
+
+    HeadlessGame game;
+
+    // stands in for the local player's gamepad
+    Controller controller;
+    RandomInput input;
+
+    RollbackSession session;
+
+    // input that was built but not used yet because the session stalled
+    std::optional<InputFrame> pending;
+
+    // checksum after each confirmed tick, collected before the session forgets it
+    std::vector<uint64_t> checksums;
+
+    void collect_checksums()
+    {
+        while (auto checksum = session.get_confirmed_checksum(uint32_t(checksums.size())))
+            checksums.push_back(*checksum);
+    }
+};
+
+} // anonymous namespace
+
+//============================================================================//
+
+int main(int argc, char** argv)
+{
+    GameSetup setup = GameSetup::get_quickstart();
+
+    // one fighter for each peer
+    while (setup.players.size() > 2u)
+        setup.players.pop_back();
+
+    uint ticks = 48u * 60u;
+    uint_fast32_t seed = 0u;
+
+    LoopbackNetwork::Config config;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const StringView arg = argv[i];
+
+        if (arg == "--ticks" && i + 1 < argc) ticks = uint(std::stoul(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc) seed = uint_fast32_t(std::stoul(argv[++i]));
+        else if (arg == "--latency" && i + 1 < argc) config.latency = uint(std::stoul(argv[++i]));
+        else if (arg == "--jitter" && i + 1 < argc) config.jitter = uint(std::stoul(argv[++i]));
+        else if (arg == "--loss" && i + 1 < argc) config.packetLoss = std::stof(argv[++i]);
+        else
+        {
+            fmt::print(stderr, "usage: sts-netplay-test [--ticks N] [--seed N] [--latency N] [--jitter N] [--loss F]\n");
+            return 1;
+        }
+    }
+
+    //--------------------------------------------------------//
+
+    LoopbackNetwork network { config, seed };
+
+    std::array<std::unique_ptr<Peer>, 2u> peers;
+    for (uint8_t player = 0u; player < 2u; ++player)
+        peers[player] = std::make_unique<Peer>(setup, seed, player, network.create_endpoint());
+
+    const auto is_finished = [&](const Peer& peer)
+    {
+        return peer.session.get_confirmed_tick() >= ticks;
+    };
+
+    std::optional<uint32_t> desyncTick;
+    uint32_t comparedTicks = 0u;
+
+    // keep going after reaching the last tick, until all input has arrived
+    while (desyncTick.has_value() == false && (is_finished(*peers[0]) == false || is_finished(*peers[1]) == false))
+    {
+        for (auto& peer : peers)
+        {
+            if (peer->session.get_current_tick() >= ticks)
+            {
+                peer->session.poll();
+                continue;
+            }
+
+            if (peer->pending.has_value() == false)
+            {
+                peer->input.feed(peer->controller);
+                peer->controller.tick();
+                peer->pending = peer->controller.history.frames.front();
+            }
+
+            if (peer->session.advance(*peer->pending) == true)
+                peer->pending.reset();
+        }
+
+        network.tick();
+
+        for (auto& peer : peers)
+            peer->collect_checksums();
+
+        // the first tick that differs is the interesting one, later ones always differ too
+        const size_t common = std::min(peers[0]->checksums.size(), peers[1]->checksums.size());
+
+        for (; comparedTicks < common; ++comparedTicks)
+        {
+            const uint64_t checksumA = peers[0]->checksums[comparedTicks];
+            const uint64_t checksumB = peers[1]->checksums[comparedTicks];
+
+            if (checksumA != checksumB)
+            {
+                fmt::print("tick {}: checksum {:016x} vs {:016x}\n", comparedTicks, checksumA, checksumB);
+                desyncTick = comparedTicks;
+                break;
+            }
+        }
+    }
+
+    //--------------------------------------------------------//
+
+    // only possible if a confirmed checksum was forgotten before being collected
+    if (desyncTick.has_value() == false && comparedTicks != ticks)
+        fmt::print("only compared {} of {} ticks\n", comparedTicks, ticks);
+
+    const bool inSync = desyncTick.has_value() == false && comparedTicks == ticks;
+
+    for (size_t index = 0u; index < peers.size(); ++index)
+    {
+        const RollbackSession& session = peers[index]->session;
+        fmt::print("peer {}: {} rollbacks, {} ticks resimulated, {} stalls\n", index,
+                   session.get_rollback_count(), session.get_resimulated_count(), session.get_stall_count());
+    }
+
+    fmt::print("network: {} packets sent, {} dropped\n", network.get_sent_count(), network.get_dropped_count());
+    if (desyncTick.has_value() == true)
+        fmt::print("DESYNC at tick {}\n", *desyncTick);
+    else
+        fmt::print("{} after {} ticks\n", inSync ? "in sync" : "FAILED", comparedTicks);
+
+    return inSync ? 0 : 1;
+}
@@ -0,0 +1,202 @@
+// Pack the files that the game reads itself into one memory mapped archive.
+//
+// usage: sts-pack-assets [--output PATH] DIRECTORY...
+//
+// Run from the game directory, usually with 'assets wren'. Entries keep their
+// paths relative to it, so they replace loose files exactly. The default output
+// is the archive that the game looks for on startup. Loose files still win when
+// present, so assets can be edited without repacking.
+//
+// Only definitions, scripts, and compressed animations are packed. Meshes,
+// textures, sounds, armatures, and Render.json files are opened by sqee, which
+// can't read from the archive, so those still need to be shipped as loose files.
+// The archive lists them, and the game checks that they all exist on startup.
+
+#include "main/AssetArchive.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+// meshes, textures, and sounds are loaded by sqee, so packing them wouldn't help
+constexpr const std::array<StringView, 3u> PACKED_EXTENSIONS = { ".json", ".wren", ".stsa" };
+
+// json files that sqee reads itself
+constexpr const std::array<StringView, 2u> SKIPPED_FILE_NAMES = { "Armature.json", "Render.json" };
+
+bool is_packed_extension(const std::filesystem::path& path)
+{
+    const auto extension = path.extension().string();
+    return std::find(PACKED_EXTENSIONS.begin(), PACKED_EXTENSIONS.end(), extension) != PACKED_EXTENSIONS.end();
+}
+
+/// Check if the game reads a file through the archive, rather than sqee reading it directly.
+bool should_pack(const std::filesystem::path& path)
+{
+    if (is_packed_extension(path) == false) return false;
+
+    const auto fileName = path.filename().string();
+    if (std::find(SKIPPED_FILE_NAMES.begin(), SKIPPED_FILE_NAMES.end(), fileName) != SKIPPED_FILE_NAMES.end())
+        return false;
+
+    // texture metadata sits next to the image file or directory with the same name
+    if (path.extension() == ".json")
+    {
+        for (const auto& sibling : std::filesystem::directory_iterator(path.parent_path()))
+        {
+            if (sibling.path() == path || sibling.path().stem() != path.stem()) continue;
+            if (sibling.is_directory() == true || is_packed_extension(sibling.path()) == false) return false;
+        }
+    }
+
+    return true;
+}
+
+size_t align_offset(size_t offset)
+{
+    return (offset + AssetArchive::ALIGNMENT - 1u) / AssetArchive::ALIGNMENT * AssetArchive::ALIGNMENT;
+}
+
+} // anonymous namespace
+
+//============================================================================//
+
+int main(int argc, char** argv)
+{
+    String outputPath = AssetArchive::DEFAULT_PATH;
+    std::vector<String> directories;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const StringView arg = argv[i];
+
+        if (arg == "--output" && i + 1 < argc) outputPath = argv[++i];
+        else directories.emplace_back(arg);
+    }
+
+    if (directories.empty() == true)
+    {
+        fmt::print(stderr, "usage: sts-pack-assets [--output PATH] DIRECTORY...\n");
+        return 1;
+    }
+
+    try
+    {
+        //-- find files, sorted for binary search -----------//
+
+        std::vector<String> paths, loosePaths;
+
+        for (const String& directory : directories)
+        {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+            {
+                if (entry.is_regular_file() == false) continue;
+
+                String path = entry.path().lexically_normal().generic_string();
+
+                if (should_pack(entry.path()) == true) paths.push_back(std::move(path));
+                else loosePaths.push_back(std::move(path));
+            }
+        }
+
+        std::sort(loosePaths.begin(), loosePaths.end());
+        loosePaths.erase(std::unique(loosePaths.begin(), loosePaths.end()), loosePaths.end());
+
+        // not a real file, written from memory below
+        String looseFiles;
+        for (const String& path : loosePaths)
+            looseFiles.append(path).push_back('\n');
+
+        paths.emplace_back(AssetArchive::LOOSE_FILES_PATH);
+
+        std::sort(paths.begin(), paths.end());
+        paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+        //-- lay out the header, entries, paths, then data ---//
+
+        std::vector<AssetArchive::Entry> entries(paths.size());
+
+        size_t offset = sizeof(AssetArchive::Header) + sizeof(AssetArchive::Entry) * entries.size();
+
+        for (size_t index = 0u; index < paths.size(); ++index)
+        {
+            entries[index].pathOffset = uint32_t(offset);
+            entries[index].pathSize = uint32_t(paths[index].size());
+            offset += paths[index].size();
+        }
+
+        for (size_t index = 0u; index < paths.size(); ++index)
+        {
+            offset = align_offset(offset);
+            entries[index].dataOffset = offset;
+            entries[index].dataSize = paths[index] == AssetArchive::LOOSE_FILES_PATH ?
+                looseFiles.size() : std::filesystem::file_size(paths[index]);
+            offset += entries[index].dataSize;
+        }
+
+        //-- write everything --------------------------------//
+
+        std::ofstream stream(outputPath, std::ios::binary);
+
+        if (stream.good() == false)
+            throw std::runtime_error(fmt::format("could not open '{}' for writing", outputPath));
+
+        AssetArchive::Header header = {};
+        header.magic = AssetArchive::MAGIC;
+        header.version = AssetArchive::VERSION;
+        header.entryCount = uint32_t(entries.size());
+
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(entries.data()), std::streamsize(sizeof(AssetArchive::Entry) * entries.size()));
+
+        for (const String& path : paths)
+            stream.write(path.data(), std::streamsize(path.size()));
+
+        for (size_t index = 0u; index < paths.size(); ++index)
+        {
+            const auto padding = std::streamoff(entries[index].dataOffset) - stream.tellp();
+            for (std::streamoff i = 0; i < padding; ++i) stream.put('\0');
+
+            if (paths[index] == AssetArchive::LOOSE_FILES_PATH)
+                stream.write(looseFiles.data(), std::streamsize(looseFiles.size()));
+
+            // streaming an empty buffer counts as a failure
+            else if (entries[index].dataSize != 0u)
+            {
+                std::ifstream file(paths[index], std::ios::binary);
+                stream << file.rdbuf();
+            }
+
+            if (std::streamoff(entries[index].dataOffset + entries[index].dataSize) != stream.tellp())
+                throw std::runtime_error(fmt::format("'{}' changed while packing", paths[index]));
+        }
+
+        if (stream.good() == false)
+            throw std::runtime_error(fmt::format("could not write '{}'", outputPath));
+
+        stream.close();
+
+        //-- check that the archive opens --------------------//
+
+        const AssetArchive archive { outputPath };
+
+        for (const String& path : paths)
+            if (archive.find(path).has_value() == false)
+                throw std::runtime_error(fmt::format("'{}' missing from archive", path));
+
+        fmt::print("packed {} files into '{}', {} KiB\n", paths.size() - 1u, outputPath, offset / 1024u);
+        fmt::print("{} files still need to be shipped alongside it\n", loosePaths.size());
+    }
+    catch (const std::exception& ex)
+    {
+        fmt::print(stderr, "{}\n", ex.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+// Play back a replay file without a window, as fast as possible.
+//
+// usage: sts-replay PATH
+
+#include "main/HeadlessGame.hpp"
+#include "main/Replay.hpp"
+
+#include "game/Fighter.hpp"
+#include "game/World.hpp"
+
+#include <chrono>
+
+using namespace sts;
+
+//============================================================================//
+
+int main(int argc, char** argv)
+{
+    if (argc != 2 || StringView(argv[1]).starts_with("--"))
+    {
+        fmt::print(stderr, "usage: sts-replay PATH\n");
+        return 1;
+    }
+
+    const auto loadStart = std::chrono::steady_clock::now();
+
+    std::unique_ptr<ReplayReader> replay;
+
+    try { replay = std::make_unique<ReplayReader>(argv[1]); }
+    catch (const std::exception& ex)
+    {
+        fmt::print(stderr, "{}\n", ex.what());
+        return 1;
+    }
+
+    const GameSetup& setup = replay->get_setup();
+
+    HeadlessGame game { setup, replay->get_seed() };
+
+    const auto simStart = std::chrono::steady_clock::now();
+
+    ReplayTick frames;
+    uint ticks = 0u;
+
+    while (replay->read_tick(frames) == true)
+    {
+        game.tick(frames);
+        ++ticks;
+    }
+
+    const auto simEnd = std::chrono::steady_clock::now();
+
+    //--------------------------------------------------------//
+
+    const double loadSeconds = std::chrono::duration<double>(simStart - loadStart).count();
+    const double simSeconds = std::chrono::duration<double>(simEnd - simStart).count();
+
+    fmt::print("loaded {} on {} in {:.3f}s\n", fmt::join(views::transform(setup.players, [](auto& player) { return player.fighter; }), " vs. "), setup.stage, loadSeconds);
+    fmt::print("replayed {} ticks in {:.3f}s, {:.1f} ticks per second ({:.1f}x realtime)\n",
+               ticks, simSeconds, double(ticks) / simSeconds, double(ticks) / simSeconds / 48.0);
+
+    for (const auto& fighter : game.get_world().get_fighters())
+        fmt::print("fighter {}: position ({:.3f}, {:.3f}), damage {:.1f}\n", fighter->index,
+                   fighter->variables.position.x, fighter->variables.position.y, fighter->variables.damage);
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+// Check that sampling only simulation bones gives exactly the same bone
+// matrices for those bones as sampling every bone.
+//
+// usage: sts-sampling-test
+//
+// Headless worlds and rollback resimulation only sample the bones in
+// EntityDef::simulationBones, so any difference here would be a desync
+// between worlds that render and worlds that don't.
+
+#include "main/GameSetup.hpp"
+#include "main/HeadlessGame.hpp"
+
+#include "game/Fighter.hpp"
+#include "game/World.hpp"
+
+#include "render/AnimPlayer.hpp"
+
+#include <cstring> // memcmp
+
+using namespace sts;
+
+//============================================================================//
+
+int main(int argc, char**)
+{
+    if (argc != 1)
+    {
+        fmt::print(stderr, "usage: sts-sampling-test\n");
+        return 1;
+    }
+
+    HeadlessGame game { GameSetup::get_quickstart(), 0u };
+
+    std::vector<const EntityDef*> defs;
+    for (const auto& fighter : game.get_world().get_fighters())
+        if (ranges::find(defs, &fighter->get_def()) == defs.end())
+            defs.push_back(&fighter->get_def());
+
+    uint tested = 0u, failures = 0u;
+
+    for (const EntityDef* def : defs)
+    {
+        if (def->simulationBones.empty() == true)
+        {
+            fmt::print("'{}': samples every bone, nothing to test\n", def->directory);
+            continue;
+        }
+
+        AnimPlayer full { def->armature };
+        AnimPlayer partial { def->armature };
+
+        for (const auto& [key, animation] : def->animations)
+        {
+            // compressed animations never get sampled partially
+            if (animation.compressed.empty() == false) continue;
+
+            for (uint frame = 0u; frame < animation.anim.frameCount; ++frame)
+            {
+                def->armature.compute_sample(animation.anim, float(frame), full.currentSample);
+
+                // start from a different pose, so that bones left untouched would show up
+                def->armature.compute_sample(animation.anim, float(animation.anim.frameCount - 1u - frame), partial.currentSample);
+
+                if (compute_partial_sample(def->armature, animation.anim, float(frame), def->simulationBones, partial.currentSample) == false)
+                {
+                    if (++failures <= 10u)
+                        fmt::print("'{}/{}' frame {}: partial sample failed\n", def->directory, key, frame);
+                    continue;
+                }
+
+                full.invalidate_bone_matrices();
+                partial.invalidate_bone_matrices();
+
+                for (const uint8_t bone : def->simulationBones)
+                {
+                    const Mat4F& expected = full.get_bone_matrix(bone);
+                    const Mat4F& actual = partial.get_bone_matrix(bone);
+
+                    if (std::memcmp(&expected, &actual, sizeof(Mat4F)) != 0 && ++failures <= 10u)
+                        fmt::print("'{}/{}' frame {}: bone {} differs\n", def->directory, key, frame, bone);
+                }
+
+                ++tested;
+            }
+        }
+    }
+
+    fmt::print("{} frames tested, {} differences\n", tested, failures);
+
+    return failures == 0u ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+// Run matches without a window, audio, or renderer, as fast as possible.
+//
+// usage: sts-sim [--ticks N] [--seed N] [--stage NAME] [--trace PATH] [--record PATH] [FIGHTER...]
+
+#include "main/GameSetup.hpp"
+#include "main/HeadlessGame.hpp"
+#include "main/Replay.hpp"
+#include "main/Tracing.hpp"
+
+#include "game/Fighter.hpp"
+#include "game/World.hpp"
+
+#include <chrono>
+
+using namespace sts;
+
+//============================================================================//
+
+int main(int argc, char** argv)
+{
+    GameSetup setup = GameSetup::get_quickstart();
+
+    uint ticks = 48u * 60u;
+    uint_fast32_t seed = 0u;
+    String tracePath;
+    String recordPath;
+
+    bool clearedPlayers = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const StringView arg = argv[i];
+
+        if (arg == "--ticks" && i + 1 < argc) ticks = uint(std::stoul(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc) seed = uint_fast32_t(std::stoul(argv[++i]));
+        else if (arg == "--stage" && i + 1 < argc) setup.stage = argv[++i];
+        else if (arg == "--trace" && i + 1 < argc) tracePath = argv[++i];
+        else if (arg == "--record" && i + 1 < argc) recordPath = argv[++i];
+        else if (arg.starts_with("--") == false)
+        {
+            if (clearedPlayers == false)
+                setup.players.clear(), clearedPlayers = true;
+
+            if (setup.players.full() == true)
+            {
+                fmt::print(stderr, "too many fighters, maximum is {}\n", MAX_FIGHTERS);
+                return 1;
+            }
+
+            setup.players.push_back({TinyString(arg)});
+        }
+        else
+        {
+            fmt::print(stderr, "usage: sts-sim [--ticks N] [--seed N] [--stage NAME] [--trace PATH] [--record PATH] [FIGHTER...]\n");
+            return 1;
+        }
+    }
+
+    //--------------------------------------------------------//
+
+    if (tracePath.empty() == false)
+        TraceZone::set_enabled(true);
+
+    const auto loadStart = std::chrono::steady_clock::now();
+
+    HeadlessGame game { setup, seed };
+
+    std::unique_ptr<ReplayWriter> replayWriter;
+    if (recordPath.empty() == false)
+    {
+        replayWriter = std::make_unique<ReplayWriter>(recordPath, setup, uint32_t(seed));
+        game.set_replay_writer(replayWriter.get());
+    }
+
+    const auto simStart = std::chrono::steady_clock::now();
+
+    for (uint tick = 0u; tick < ticks; ++tick)
+    {
+        game.feed_random_input();
+        game.tick();
+    }
+
+    const auto simEnd = std::chrono::steady_clock::now();
+
+    //--------------------------------------------------------//
+
+    const double loadSeconds = std::chrono::duration<double>(simStart - loadStart).count();
+    const double simSeconds = std::chrono::duration<double>(simEnd - simStart).count();
+
+    fmt::print("loaded {} on {} in {:.3f}s\n", fmt::join(views::transform(setup.players, [](auto& player) { return player.fighter; }), " vs. "), setup.stage, loadSeconds);
+    fmt::print("simulated {} ticks in {:.3f}s, {:.1f} ticks per second ({:.1f}x realtime)\n",
+               ticks, simSeconds, double(ticks) / simSeconds, double(ticks) / simSeconds / 48.0);
+
+    // same format as sts-replay, so that results can be compared
+    for (const auto& fighter : game.get_world().get_fighters())
+        fmt::print("fighter {}: position ({:.3f}, {:.3f}), damage {:.1f}\n", fighter->index,
+                   fighter->variables.position.x, fighter->variables.position.y, fighter->variables.damage);
+
+    if (tracePath.empty() == false)
+        TraceZone::write_chrome_trace(tracePath);
+
+    return 0;
+}
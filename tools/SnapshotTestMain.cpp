@@ -0,0 +1,163 @@
+// Save a snapshot, run on with different input, restore it, and check that
+// the world checksums match a run that never diverged.
+//
+// usage: sts-snapshot-test [--seed N]
+//
+// The cases cover script fields that only live in wren, like JumpSquat's
+// _jumpHeld and the jab combo's _allowNext, which restoring has to put back,
+// and scripts that branch on fighter variables while being fast forwarded.
+
+#include "main/GameSetup.hpp"
+#include "main/HeadlessGame.hpp"
+
+#include "game/Controller.hpp"
+#include "game/StateBuffer.hpp"
+#include "game/World.hpp"
+
+using namespace sts;
+
+//============================================================================//
+
+namespace {
+
+constexpr uint TOTAL_TICKS = 320u;
+
+/// Input for the first player, everyone else stands still.
+InputFrame get_input(uint tick)
+{
+    InputFrame frame;
+
+    // jump on tick 60, held for long enough to be a full jump
+    frame.pressJump = tick == 60u;
+    frame.holdJump = tick >= 60u && tick < 80u;
+
+    // jab on tick 120, held so that it keeps repeating
+    frame.pressAttack = tick == 120u;
+    frame.holdAttack = tick >= 120u && tick < 160u;
+
+    // fireball on tick 200, SpecialNeutral picks its animation from onGround
+    frame.pressSpecial = tick == 200u;
+    frame.holdSpecial = tick == 200u;
+
+    return frame;
+}
+
+struct TestCase
+{
+    const char* name;
+
+    /// Number of ticks to run before saving.
+    uint saveTick;
+
+    /// Number of ticks to run with diverged input before restoring.
+    uint divergeTicks;
+
+    void (*diverge)(InputFrame& frame, uint tick);
+};
+
+const std::array<TestCase, 4u> TEST_CASES =
+{
+    TestCase { "jump released in JumpSquat", 62u, 2u, [](InputFrame& frame, uint) { frame.holdJump = false; } },
+    TestCase { "attack released in jab", 127u, 4u, [](InputFrame& frame, uint) { frame.holdAttack = false; } },
+    TestCase { "second jab pressed", 127u, 6u, [](InputFrame& frame, uint tick) { frame.pressAttack = tick == 127u; } },
+    // the fireball ends on the ground, then a jump leaves onGround false when the snapshot is loaded
+    TestCase { "onGround changed during fireball", 205u, 55u, [](InputFrame& frame, uint tick) {
+        frame.pressJump = tick == 250u; frame.holdJump = tick >= 250u; } },
+};
+
+void tick_game(HeadlessGame& game, uint tick, const TestCase* diverged)
+{
+    ReplayTick frames;
+    frames.push_back(get_input(tick));
+
+    if (diverged != nullptr)
+        diverged->diverge(frames.front(), tick);
+
+    while (frames.size() < game.get_player_count())
+        frames.emplace_back();
+
+    game.tick(frames);
+}
+
+} // anonymous namespace
+
+//============================================================================//
+
+int main(int argc, char** argv)
+{
+    const GameSetup setup = GameSetup::get_quickstart();
+
+    uint_fast32_t seed = 0u;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const StringView arg = argv[i];
+
+        if (arg == "--seed" && i + 1 < argc) seed = uint_fast32_t(std::stoul(argv[++i]));
+        else
+        {
+            fmt::print(stderr, "usage: sts-snapshot-test [--seed N]\n");
+            return 1;
+        }
+    }
+
+    //--------------------------------------------------------//
+
+    // checksum after each tick of a run without any restoring
+    std::vector<uint64_t> expected;
+    {
+        HeadlessGame game { setup, seed };
+
+        for (uint tick = 0u; tick < TOTAL_TICKS; ++tick)
+        {
+            tick_game(game, tick, nullptr);
+            expected.push_back(game.get_world().get_checksum());
+        }
+    }
+
+    //--------------------------------------------------------//
+
+    uint failures = 0u;
+
+    for (const TestCase& test : TEST_CASES)
+    {
+        HeadlessGame game { setup, seed };
+        World& world = game.get_world();
+
+        for (uint tick = 0u; tick < test.saveTick; ++tick)
+            tick_game(game, tick, nullptr);
+
+        StateBuffer buffer;
+        world.save_state(buffer);
+
+        for (uint tick = test.saveTick; tick < test.saveTick + test.divergeTicks; ++tick)
+            tick_game(game, tick, &test);
+
+        world.load_state(buffer);
+
+        // the first tick that differs is the interesting one, later ones always differ too
+        std::optional<uint> failedTick;
+
+        if (world.get_checksum() != expected[test.saveTick - 1u])
+            failedTick = test.saveTick - 1u;
+
+        for (uint tick = test.saveTick; tick < TOTAL_TICKS && failedTick.has_value() == false; ++tick)
+        {
+            tick_game(game, tick, nullptr);
+
+            if (world.get_checksum() != expected[tick])
+                failedTick = tick;
+        }
+
+        if (failedTick.has_value() == true)
+        {
+            fmt::print("{}: FAILED at tick {}\n", test.name, *failedTick);
+            ++failures;
+        }
+        else fmt::print("{}: ok\n", test.name);
+    }
+
+    fmt::print("{} of {} cases passed\n", TEST_CASES.size() - failures, TEST_CASES.size());
+
+    return failures == 0u ? 0 : 1;
+}